@@ -85,6 +85,13 @@ unsigned char Test23[] = { 0x43, 0x58, 0x44, 0x32, 0x39 ,0x34, 0x30, 0x51 };
 // so (PSXCLK / 75) / BIAS = cdr read time (linuzappz)
 #define cdReadTime ((PSXCLK / 75) / BIAS)
 
+// fast-disc mode: seek and sector read latencies are divided by
+// Config.CdFast (0/1 - real drive timing). the factor is stored in
+// the movie header, so it is part of the emulated machine like PsxType.
+// cdda playback keeps 1x pacing, the spu consumes it in real time.
+#define cdFastTime(eCycle) (Config.CdFast > 1 ? (eCycle) / Config.CdFast : (eCycle))
+#define cdSectorTime() cdFastTime((cdr.Mode & 0x80) ? (cdReadTime / 2) : cdReadTime)
+
 #define btoi(b)		((b)/16*10 + (b)%16)		/* BCD to u_char */
 #define itob(i)		((i)/10*16 + (i)%10)		/* u_char to BCD */
 
@@ -110,16 +117,18 @@ unsigned long CDR_fakeStatus();
 	AddIrqQueue(READ_ACK, 0x800); \
 }	
 
+// cdda goes on pulling sectors on the read interrupt
 #define StopReading() { \
 	if (cdr.Reading) { \
 		cdr.Reading = 0; \
-		psxRegs.interrupt&=~0x40000; \
+		if (!cdr.Play || !MOV_CdAudio()) psxRegs.interrupt&=~0x40000; \
 	} \
 }
 
 #define StopCdda() { \
 	if (cdr.Play) { \
-		if (!Config.Cdda) CDRstop(); \
+		CDRstop(); \
+		if (!cdr.Reading && MOV_CdAudio()) psxRegs.interrupt&=~0x40000; \
 		cdr.StatP&=~0x80; \
 		cdr.Play = 0; \
 	} \
@@ -519,7 +528,7 @@ void cdrInterrupt() {
 			ReadTrack();
 
 //			CDREAD_INT((cdr.Mode & 0x80) ? (cdReadTime / 2) : cdReadTime);
-			CDREAD_INT(0x40000);
+			CDREAD_INT(cdFastTime(0x40000));
 			break;
 
 		case REPPLAY_ACK:
@@ -561,10 +570,40 @@ void cdrInterrupt() {
 #endif
 }
 
+// one sector of cdda per 1x sector time, whether or not it's heard, so
+// what the game sees doesn't depend on the sound settings
+static void cdrPlayInterrupt() {
+	u8 *buf;
+
+	buf = CDRgetBufferCdda();
+	if (buf == NULL) { // end of disc
+		StopCdda();
+		return;
+	}
+
+	if ((cdr.Muted == 1) && (!Config.Cdda))
+		SPUplayCDDAchannel((short *)buf, 2352);
+
+	cdr.Prev[2] = itob(btoi(cdr.Prev[2]) + 1);
+	if (cdr.Prev[2] == itob(75)) {
+		cdr.Prev[2] = 0;
+		cdr.Prev[1] = itob(btoi(cdr.Prev[1]) + 1);
+		if (cdr.Prev[1] == itob(60)) {
+			cdr.Prev[1] = 0;
+			cdr.Prev[0] = itob(btoi(cdr.Prev[0]) + 1);
+		}
+	}
+
+	CDREAD_INT(cdReadTime);
+}
+
 void cdrReadInterrupt() {
 	u8 *buf;
 
-	if (!cdr.Reading) return;
+	if (!cdr.Reading) {
+		if (cdr.Play && MOV_CdAudio()) cdrPlayInterrupt();
+		return;
+	}
 
 	if (cdr.Stat) {
 		CDREAD_INT(0x800);
@@ -593,7 +632,7 @@ void cdrReadInterrupt() {
 		cdr.Stat = DiskError;
 		cdr.Result[0]|= 0x01;
 		ReadTrack();
-		CDREAD_INT((cdr.Mode & 0x80) ? (cdReadTime / 2) : cdReadTime);
+		CDREAD_INT(cdSectorTime());
 		return;
 	}
 
@@ -609,7 +648,8 @@ void cdrReadInterrupt() {
 		if ((cdr.Transfer[4+2] & 0x4) &&
 			((cdr.Mode&0x8) ? (cdr.Transfer[4+1] == cdr.Channel) : 1) &&
 			(cdr.Transfer[4+0] == cdr.File)) {
-			int ret = xa_decode_sector(&cdr.Xa, cdr.Transfer+4, cdr.FirstSector);
+			int ret = xa_decode_sector_cached(&cdr.Xa, cdr.Transfer+4, cdr.FirstSector,
+				MSF2SECT(btoi(cdr.Transfer[0]), btoi(cdr.Transfer[1]), btoi(cdr.Transfer[2])));
 
 			if (!ret) {
 				SPUplayADPCMchannel(&cdr.Xa);
@@ -640,7 +680,7 @@ void cdrReadInterrupt() {
 	}
 	else {
 		ReadTrack();
-		CDREAD_INT((cdr.Mode & 0x80) ? (cdReadTime / 2) : cdReadTime);
+		CDREAD_INT(cdSectorTime());
 	}
 	psxHu32ref(0x1070)|= SWAP32((u32)0x4);
 }
@@ -757,11 +797,20 @@ void cdrWrite1(unsigned char rt) {
 		               	int tmp = cdr.ResultTD[2];
                         cdr.ResultTD[2] = cdr.ResultTD[0];
 						cdr.ResultTD[0] = tmp;
-	                    if (!Config.Cdda) CDRplay(cdr.ResultTD);
+	                    CDRplay(cdr.ResultTD);
+						if (MOV_CdAudio())
+							for (i=0; i<3; i++) cdr.Prev[i] = itob(cdr.ResultTD[i]);
 					}
                 }
 			}
-    		else if (!Config.Cdda) CDRplay(cdr.SetSector);
+    		else {
+				CDRplay(cdr.SetSector);
+				if (MOV_CdAudio())
+					for (i=0; i<3; i++) cdr.Prev[i] = itob(cdr.SetSector[i]);
+			}
+			// the audio is pulled on the read interrupt, which reading owns
+			// while it's going
+			if (!cdr.Reading && MOV_CdAudio()) CDREAD_INT(cdReadTime);
     		cdr.Play = 1;
 			cdr.Ctrl|= 0x80;
     		cdr.Stat = NoIntr; 
@@ -811,7 +860,7 @@ void cdrWrite1(unsigned char rt) {
 			StopReading();
 			cdr.Ctrl|= 0x80;
     		cdr.Stat = NoIntr;
-    		AddIrqQueue(cdr.Cmd, 0x40000);
+    		AddIrqQueue(cdr.Cmd, cdFastTime(0x40000));
         	break;
 
 		case CdlReset:
@@ -6,9 +6,11 @@
 //============================================
 
 #include <stdio.h>
+#include <string.h>
 
 #include "CdRom.h"
 #include "Decode_XA.h"
+#include "emusimd.h"
 
 #define FIXED
 
@@ -81,38 +83,64 @@ void ADPCM_InitDecode(ADPCM_Decode_t *decp) {
 #define IK1(fid)	(-K1[fid])
 #endif
 
+// unpacks the 28 nibbles of a block to ((short)(nibble << 12) >> range).
+// The filter after it is a recurrence and has to stay scalar.
+static __inline void ADPCM_Unpack( U8 range, const U16 *blockp, short *x ) {
+#ifdef ENABLE_SSE2
+	__m128i v, a0, a1, a2, a3, lo, hi;
+	__m128i mask = _mm_set1_epi16((short)0xf000);
+	__m128i cnt = _mm_cvtsi32_si128(range);
+	U16 w[8];
+
+	memcpy(w, blockp, 7 * 2); w[7] = 0;
+	v = _mm_loadu_si128((const __m128i *)w);
+	a0 = _mm_sra_epi16(_mm_slli_epi16(v, 12), cnt);
+	a1 = _mm_sra_epi16(_mm_and_si128(_mm_slli_epi16(v, 8), mask), cnt);
+	a2 = _mm_sra_epi16(_mm_and_si128(_mm_slli_epi16(v, 4), mask), cnt);
+	a3 = _mm_sra_epi16(_mm_and_si128(v, mask), cnt);
+
+	// back to sample order, four per word
+	lo = _mm_unpacklo_epi16(a0, a1);
+	hi = _mm_unpacklo_epi16(a2, a3);
+	_mm_storeu_si128((__m128i *)(x +  0), _mm_unpacklo_epi32(lo, hi));
+	_mm_storeu_si128((__m128i *)(x +  8), _mm_unpackhi_epi32(lo, hi));
+	lo = _mm_unpackhi_epi16(a0, a1);
+	hi = _mm_unpackhi_epi16(a2, a3);
+	_mm_storeu_si128((__m128i *)(x + 16), _mm_unpacklo_epi32(lo, hi));
+	_mm_storeu_si128((__m128i *)(x + 24), _mm_unpackhi_epi32(lo, hi));
+#else
+	int i;
+
+	for (i = 0; i < BLKSIZ/4; i++, x += 4) {
+		long y = blockp[i];
+		x[0] = (short)((y << 12) & 0xf000) >> range;
+		x[1] = (short)((y <<  8) & 0xf000) >> range;
+		x[2] = (short)((y <<  4) & 0xf000) >> range;
+		x[3] = (short)( y        & 0xf000) >> range;
+	}
+#endif
+}
+
 static __inline void ADPCM_DecodeBlock16( ADPCM_Decode_t *decp, U8 filter_range, const void *vblockp, short *destp, int inc ) {
 	int i;
 	int range, filterid;
 	long fy0, fy1;
-	const U16 *blockp;
+	short x[32]; // BLKSIZ, rounded up for the simd stores
 
-	blockp = (const unsigned short *)vblockp;
 	filterid = (filter_range >>  4) & 0x0f;
 	range    = (filter_range >>  0) & 0x0f;
 
+	ADPCM_Unpack( range, (const U16 *)vblockp, x );
+
 	fy0 = decp->y0;
 	fy1 = decp->y1;
 
-	for (i = BLKSIZ/4; i; --i) {
-		long y;
-		long x0, x1, x2, x3;
-
-		y = *blockp++;
-		x3 = (short)( y        & 0xf000) >> range; x3 <<= SH;
-		x2 = (short)((y <<  4) & 0xf000) >> range; x2 <<= SH;
-		x1 = (short)((y <<  8) & 0xf000) >> range; x1 <<= SH;
-		x0 = (short)((y << 12) & 0xf000) >> range; x0 <<= SH;
-
-		x0 -= (IK0(filterid) * fy0 + (IK1(filterid) * fy1)) >> SHC; fy1 = fy0; fy0 = x0;
-		x1 -= (IK0(filterid) * fy0 + (IK1(filterid) * fy1)) >> SHC; fy1 = fy0; fy0 = x1;
-		x2 -= (IK0(filterid) * fy0 + (IK1(filterid) * fy1)) >> SHC; fy1 = fy0; fy0 = x2;
-		x3 -= (IK0(filterid) * fy0 + (IK1(filterid) * fy1)) >> SHC; fy1 = fy0; fy0 = x3;
-
-		CLAMP( x0, -32768<<SH, 32767<<SH ); *destp = x0 >> SH; destp += inc;
-		CLAMP( x1, -32768<<SH, 32767<<SH ); *destp = x1 >> SH; destp += inc;
-		CLAMP( x2, -32768<<SH, 32767<<SH ); *destp = x2 >> SH; destp += inc;
-		CLAMP( x3, -32768<<SH, 32767<<SH ); *destp = x3 >> SH; destp += inc;
+	for (i = 0; i < BLKSIZ; i++) {
+		long y = (long)x[i] << SH;
+
+		y -= (IK0(filterid) * fy0 + (IK1(filterid) * fy1)) >> SHC; fy1 = fy0; fy0 = y;
+
+		CLAMP( y, -32768<<SH, 32767<<SH ); *destp = y >> SH; destp += inc;
 	}
 	decp->y0 = fy0;
 	decp->y1 = fy1;
@@ -261,6 +289,70 @@ static void xa_decode_data( xa_decode_t *xdp, unsigned char *srcp ) {
 	}
 }
 
+//============================================
+//===  DECODED SECTOR CACHE
+//============================================
+// looped streams and replayed clips decode the same sectors from the same
+// filter state again. A hit copies the pcm and the end state instead; the
+// whole input is compared, so it's always what decoding would have given.
+
+#define XA_CACHE_SIZE	256		// direct mapped on the lba
+#define XA_DATA_SIZE	(18 * 128)
+#define XA_PCM_SIZE		(18 * 4 * 28 * 2)
+
+typedef struct {
+	int				used;
+	int				lba;
+	s32				freq, nbits, stereo;
+	ADPCM_Decode_t	left, right;		// state going in
+	ADPCM_Decode_t	endLeft, endRight;	// and coming out
+	U8				data[XA_DATA_SIZE];
+	short			pcm[XA_PCM_SIZE];
+} xa_cache_t;
+
+static xa_cache_t xa_cache[XA_CACHE_SIZE];
+
+// pcm values xa_decode_data() writes
+static int xa_pcm_count( xa_decode_t *xdp ) {
+	return 18 * (xdp->nbits == 4 ? 4 : 2) * 28 * 2;
+}
+
+static void xa_decode_data_cached( xa_decode_t *xdp, unsigned char *srcp, int lba ) {
+	xa_cache_t *c;
+
+	if (lba < 0) {
+		xa_decode_data( xdp, srcp );
+		return;
+	}
+
+	c = &xa_cache[lba & (XA_CACHE_SIZE - 1)];
+	if (c->used && c->lba == lba &&
+		c->freq == xdp->freq && c->nbits == xdp->nbits && c->stereo == xdp->stereo &&
+		c->left.y0 == xdp->left.y0 && c->left.y1 == xdp->left.y1 &&
+		c->right.y0 == xdp->right.y0 && c->right.y1 == xdp->right.y1 &&
+		memcmp(c->data, srcp, XA_DATA_SIZE) == 0) {
+		memcpy(xdp->pcm, c->pcm, xa_pcm_count(xdp) * sizeof(short));
+		xdp->left = c->endLeft;
+		xdp->right = c->endRight;
+		return;
+	}
+
+	c->used = 1;
+	c->lba = lba;
+	c->freq = xdp->freq;
+	c->nbits = xdp->nbits;
+	c->stereo = xdp->stereo;
+	c->left = xdp->left;
+	c->right = xdp->right;
+	memcpy(c->data, srcp, XA_DATA_SIZE);
+
+	xa_decode_data( xdp, srcp );
+
+	memcpy(c->pcm, xdp->pcm, xa_pcm_count(xdp) * sizeof(short));
+	c->endLeft = xdp->left;
+	c->endRight = xdp->right;
+}
+
 //============================================
 //===  XA SPECIFIC ROUTINES
 //============================================
@@ -298,7 +390,7 @@ U8  coding2;
 static int parse_xa_audio_sector( xa_decode_t *xdp, 
 								  xa_subheader_t *subheadp,
 								  unsigned char *sectorp,
-								  int is_first_sector ) {
+								  int is_first_sector, int lba ) {
     if ( is_first_sector ) {
 		switch ( AUDIO_CODING_GET_FREQ(subheadp->coding) ) {
 			case 0: xdp->freq = kBaseFrequency;   break;
@@ -325,7 +417,7 @@ static int parse_xa_audio_sector( xa_decode_t *xdp,
 		xdp->nsamples = 18 * 28 * 8;
 		if (xdp->stereo == 1) xdp->nsamples /= 2;
     }
-	xa_decode_data( xdp, sectorp );
+	xa_decode_data_cached( xdp, sectorp, lba );
 
 	return 0;
 }
@@ -341,7 +433,16 @@ static int parse_xa_audio_sector( xa_decode_t *xdp,
 //================================================================
 long xa_decode_sector( xa_decode_t *xdp,
 					   unsigned char *sectorp, int is_first_sector ) {
-	if (parse_xa_audio_sector(xdp, (xa_subheader_t *)sectorp, sectorp + sizeof(xa_subheader_t), is_first_sector))
+	if (parse_xa_audio_sector(xdp, (xa_subheader_t *)sectorp, sectorp + sizeof(xa_subheader_t), is_first_sector, -1))
+		return -1;
+
+	return 0;
+}
+
+//=== same, lba is the sector's own and lets repeats come from the cache
+long xa_decode_sector_cached( xa_decode_t *xdp,
+							  unsigned char *sectorp, int is_first_sector, int lba ) {
+	if (parse_xa_audio_sector(xdp, (xa_subheader_t *)sectorp, sectorp + sizeof(xa_subheader_t), is_first_sector, lba))
 		return -1;
 
 	return 0;
@@ -34,5 +34,8 @@ struct xa_decode_t
 
 long xa_decode_sector( xa_decode_t *xdp,
                        unsigned char *sectorp,
-                       int is_first_sector );
+                       int is_first_sector );
+long xa_decode_sector_cached( xa_decode_t *xdp,
+                              unsigned char *sectorp,
+                              int is_first_sector, int lba );
 #endif
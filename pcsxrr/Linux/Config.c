@@ -95,6 +95,7 @@ int LoadConfig(PcsxConfig *Conf) {
 	GetValuel("SpuIrq",  Config.SpuIrq);
 	GetValuel("RCntFix", Config.RCntFix);
 	GetValuel("VSyncWA", Config.VSyncWA);
+	GetValuel("CdFast",  Config.CdFast);
 	Config.Lang[0] = 0;
 	GetValue("Lang", Config.Lang);
 
@@ -142,6 +143,7 @@ void SaveConfig() {
 	SetValuel("SpuIrq",  Config.SpuIrq);
 	SetValuel("RCntFix", Config.RCntFix);
 	SetValuel("VSyncWA", Config.VSyncWA);
+	SetValuel("CdFast",  Config.CdFast);
 	SetValue("Lang",    Config.Lang);
 
 	fclose(f);
@@ -23,6 +23,7 @@
 
 #include "PsxCommon.h"
 #include "Mdec.h"
+#include "emuthread.h"
 
 #define FIXED
 
@@ -178,7 +179,92 @@ struct TMdec {
 
 int iq_y[DCTSIZE2],iq_uv[DCTSIZE2];
 
+// Async decode: psxDma1() hands the macroblocks to a worker thread and
+// mdecSync() waits for it before anything can observe the output (or the
+// run-length input) - mdec1Interrupt, ram accesses in the guarded ranges,
+// other dmas, vsync and savestates. The decoded data is the same whenever
+// the join happens, so emulation stays deterministic.
+// Only used with the interpreter and the real bios: the recompiler and the
+// hle bios touch psxM directly, so they get the old synchronous decode.
+
+struct TMdecJob {
+	unsigned short *rl;
+	unsigned short *image;
+	int count;
+	int rgb24;
+	u32 inStart, inEnd;		// psxM offsets read by the job
+	u32 outStart, outEnd;	// psxM offsets written by the job
+};
+
+static TMdecJob mdecJob;
+static u32 mdecRlEnd = 0x200000;
+static int mdecThreadState = 0; // 0 - not started / 1 - running / -1 - unavailable
+static emuThread mdecThread;
+static emuEvent mdecStartEvent, mdecDoneEvent;
+int mdecPending = 0;
+
+static void mdecDecodeJob(TMdecJob *job) {
+	int blk[DCTSIZE2*6];
+	unsigned short *image = job->image;
+	int size;
+
+	if (job->rgb24) {
+		for (size = job->count; size>0; size--, image+=(24*16)) {
+			job->rl = rl2blk(blk, job->rl);
+			yuv2rgb24(blk, (u8 *)image);
+		}
+	} else {
+		for (size = job->count; size>0; size--, image+=(16*16)) {
+			job->rl = rl2blk(blk, job->rl);
+			yuv2rgb15(blk, image);
+		}
+	}
+}
+
+static void mdecThreadMain(void *arg) {
+	for (;;) {
+		emuEventWait(&mdecStartEvent);
+		mdecDecodeJob(&mdecJob);
+		emuEventSet(&mdecDoneEvent);
+	}
+}
+
+static int mdecAsyncAvailable() {
+	if (psxCpu != &psxInt || Config.HLE) return 0;
+
+	if (mdecThreadState == 0) {
+		mdecThreadState = -1;
+		if (emuCpuCount() > 1) {
+			emuEventInit(&mdecStartEvent);
+			emuEventInit(&mdecDoneEvent);
+			if (emuThreadCreate(&mdecThread, mdecThreadMain, NULL) == 0)
+				mdecThreadState = 1;
+		}
+	}
+
+	return mdecThreadState == 1;
+}
+
+void mdecSync() {
+	if (!mdecPending) return;
+
+	emuEventWait(&mdecDoneEvent);
+	mdecPending = 0;
+	mdec.rl = mdecJob.rl;
+}
+
+void mdecSyncAddr(u32 mem) {
+	u32 a;
+
+	if ((mem & 0x1fffffff) >= 0x800000) return; // not ram
+	a = mem & 0x1fffff;
+	if ((a >= mdecJob.outStart && a < mdecJob.outEnd) ||
+		(a >= mdecJob.inStart && a < mdecJob.inEnd))
+		mdecSync();
+}
+
 void mdecInit(void) {
+	mdecSync();
 	mdec.rl = 0;
 	mdec.command = 0;
 	mdec.status = 0;
@@ -203,6 +289,7 @@ void mdecWrite0(u32 data) {
 #ifdef CDR_LOG
 	CDR_LOG("mdec0 write %lx\n", data);
 #endif
+	mdecSync();
 	mdec.command = data;
 	if ((data&0xf5ff0000)==0x30000000) {
 		mdec.rlsize = data&0xffff;
@@ -213,6 +300,7 @@ void mdecWrite1(u32 data) {
 #ifdef CDR_LOG
 	CDR_LOG("mdec1 write %lx\n", data);
 #endif
+	mdecSync();
 	if (data&0x80000000) { // mdec reset
 		mdec.command = 0;
 		mdec.status = 0;
@@ -241,12 +329,14 @@ u32 mdecRead1(void) {
 }
 
 void psxDma0(u32 adr, u32 bcr, u32 chcr) {
-	int cmd = mdec.command;
+	int cmd;
 	int size;
 
 #ifdef CDR_LOG
 	CDR_LOG("DMA0 %lx %lx %lx\n", adr, bcr, chcr);
 #endif
+	mdecSync();
+	cmd = mdec.command;
 
 	if (chcr!=0x01000201) return;
 
@@ -261,6 +351,7 @@ void psxDma0(u32 adr, u32 bcr, u32 chcr) {
 	} else
 	if ((cmd&0xf5ff0000)==0x30000000) {
 		mdec.rl = (u16*)PSXM(adr);
+		mdecRlEnd = (adr & 0x1fffff) + size * 4;
 	}
 	else {
 	}
@@ -270,8 +361,6 @@ void psxDma0(u32 adr, u32 bcr, u32 chcr) {
 }
 
 void psxDma1(u32 adr, u32 bcr, u32 chcr) {
-	int blk[DCTSIZE2*6];
-	unsigned short *image;
 	int size;
 
 #ifdef CDR_LOG
@@ -280,33 +369,42 @@ void psxDma1(u32 adr, u32 bcr, u32 chcr) {
 
 	if (chcr!=0x01000200) return;
 
+	mdecSync();
+
 	size = (bcr>>16)*(bcr&0xffff);
 
-    image = (u16*)PSXM(adr);
-	if (mdec.command&0x08000000) {
-//		MDECOUTDMA_INT(((size * (1000000 / 9000)) / 4) /** 4*/ / BIAS);
-		MDECOUTDMA_INT((size / 4) / BIAS);
-		size = size / ((16*16)/2);
-		for (;size>0;size--,image+=(16*16)) {
-			mdec.rl = rl2blk(blk,mdec.rl);
-			yuv2rgb15(blk,image);
-		}
-	} else {
-//		MDECOUTDMA_INT(((size * (1000000 / 9000)) / 4) /** 4*/ / BIAS);
-		MDECOUTDMA_INT((size / 4) / BIAS);
-		size = size / ((24*16)/2);
-		for (;size>0;size--,image+=(24*16)) {
-			mdec.rl = rl2blk(blk,mdec.rl);
-			yuv2rgb24(blk,(u8 *)image);
-		}
-	}
+//	MDECOUTDMA_INT(((size * (1000000 / 9000)) / 4) /** 4*/ / BIAS);
+	MDECOUTDMA_INT((size / 4) / BIAS);
+
+	mdecJob.rl = mdec.rl;
+	mdecJob.image = (u16*)PSXM(adr);
+	mdecJob.rgb24 = !(mdec.command&0x08000000);
+	mdecJob.count = size / (mdecJob.rgb24 ? ((24*16)/2) : ((16*16)/2));
 	mdec.status|= MDEC_BUSY;
+
+	if (mdecJob.count <= 0 || !mdecAsyncAvailable()) {
+		mdecDecodeJob(&mdecJob);
+		mdec.rl = mdecJob.rl;
+		return;
+	}
+
+	mdecJob.outStart = adr & 0x1fffff;
+	mdecJob.outEnd = mdecJob.outStart + size * 4;
+	mdecJob.inStart = (u32)((s8*)mdec.rl - psxM);
+	mdecJob.inEnd = mdecRlEnd;
+	if (mdecJob.inStart >= 0x200000) { // rl isn't in ram, nothing to guard
+		mdecJob.inStart = mdecJob.inEnd = 0;
+	}
+
+	mdecPending = 1;
+	emuEventSet(&mdecStartEvent);
 }
 
 void mdec1Interrupt() {
 #ifdef CDR_LOG
 	CDR_LOG("mdec1Interrupt\n");
 #endif
+	mdecSync();
 	if (HW_DMA1_CHCR & 0x01000000) {
 		// Set a fixed value totaly arbitrarie
 		// another sound value is PSXCLK / 60 or
@@ -526,6 +624,7 @@ void yuv2rgb24(int *blk,unsigned char *image) {
 }
 
 int mdecFreeze(gzFile f, int Mode) {
+	mdecSync();
 	mdec.unfix();
 	gzfreeze(&mdec, sizeof(mdec));
 	mdec.fix();
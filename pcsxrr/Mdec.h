@@ -29,4 +29,8 @@ void psxDma1(u32 madr, u32 bcr, u32 chcr);
 void mdec1Interrupt();
 int  mdecFreeze(gzFile f, int Mode);
 
+extern int mdecPending;
+void mdecSync();
+void mdecSyncAddr(u32 mem);
+
 #endif /* __MDEC_H__ */
@@ -447,12 +447,57 @@ int Load(char *ExePath) {
 
 const char PcsxHeader[32] = "STv3 PCSX v" PCSX_VERSION;
 
+// gpu freeze buffers, reused by all states: no 1 MB allocs per save/load
+
+static GPUFreeze_t *gpuFreeze = NULL;
+static void *gpuFreezeExtra = NULL;
+static int gpuFreezeExtraSize = 0;
+
+static GPUFreeze_t *GPUFreezeBuffer(int extraSize) {
+	if (gpuFreeze == NULL)
+		gpuFreeze = (GPUFreeze_t *) malloc(sizeof(GPUFreeze_t));
+	if (extraSize > gpuFreezeExtraSize) {
+		free(gpuFreezeExtra);
+		gpuFreezeExtra = malloc(extraSize);
+		gpuFreezeExtraSize = extraSize;
+	}
+	gpuFreeze->extraData = gpuFreezeExtra;
+	gpuFreeze->extraDataSize = gpuFreezeExtraSize;
+	return gpuFreeze;
+}
+
+static void GPUFreezeSave(FILE *f) {
+	GPUFreeze_t *gpufP = GPUFreezeBuffer(0);
+
+	gpufP->ulFreezeVersion = 1;
+	if (!GPU_freezeEx(1, gpufP) && gpufP->extraDataSize > gpuFreezeExtraSize) {
+		gpufP = GPUFreezeBuffer(gpufP->extraDataSize); // first save: grow and retry
+		GPU_freezeEx(1, gpufP);
+	}
+	gpufP->extraData = 0;
+	gzwrite(f, gpufP, sizeof(GPUFreeze_t));
+	gzwrite(f, gpuFreezeExtra, gpufP->extraDataSize);
+}
+
+static void GPUFreezeLoad(FILE *f) {
+	GPUFreeze_t *gpufP = GPUFreezeBuffer(0);
+	int size;
+
+	gzread(f, gpufP, sizeof(GPUFreeze_t));
+	size = gpufP->extraDataSize;
+	GPUFreezeBuffer(size);
+	gpufP->extraDataSize = size;
+	gzread(f, gpufP->extraData, size);
+	GPU_freezeEx(0, gpufP);
+}
+
 int SaveState(char *file) {
 	FILE* f;
-	GPUFreeze_t *gpufP;
 	int Size;
 	unsigned char *pMem;
 
+	mdecSync();
+
 	f = fopen(file, "wb");
 	if (f == NULL) return -1;
 
@@ -483,15 +528,7 @@ int SaveState(char *file) {
 	pos = ftell(f);
 
 	// gpu
-	gpufP = (GPUFreeze_t *) malloc(sizeof(GPUFreeze_t));
-	gpufP->ulFreezeVersion = 1;
-	GPU_freeze(1, gpufP);
-	void* temp = gpufP->extraData;
-	gpufP->extraData = 0;
-	gzwrite(f, gpufP, sizeof(GPUFreeze_t));
-	gzwrite(f, temp, gpufP->extraDataSize);
-	GPU_freeze(3, gpufP);
-	free(gpufP);
+	GPUFreezeSave(f);
 
 	pos = ftell(f);
 	sioFreeze(f, 1);
@@ -524,10 +561,11 @@ int SaveState(char *file) {
 
 int LoadState(char *file) {
 	FILE* f;
-	GPUFreeze_t *gpufP;
 	int Size;
 	char header[32];
 
+	mdecSync();
+
 	printf("loadstate---\n");
 
 	//Get the directory out of filename
@@ -555,13 +593,7 @@ int LoadState(char *file) {
 		psxBiosFreeze(0);
 
 	// gpu
-	gpufP = (GPUFreeze_t *) malloc (sizeof(GPUFreeze_t));
-	gzread(f, gpufP, sizeof(GPUFreeze_t));
-	gpufP->extraData = malloc(gpufP->extraDataSize);
-	gzread(f, gpufP->extraData, gpufP->extraDataSize);
-	GPU_freeze(0, gpufP);
-	free(gpufP->extraData);
-	free(gpufP);
+	GPUFreezeLoad(f);
 
 	sioFreeze(f, 0);
 	cdrFreeze(f, 0);
@@ -604,10 +636,11 @@ int CheckState(char *file) {
 
 int SaveStateEmbed(char *file) {
 	FILE* f;
-	GPUFreeze_t *gpufP;
 	int Size;
 	unsigned char *pMem;
 
+	mdecSync();
+
 	f = fopen(file, "ab");
 	if (f == NULL) return -1;
 
@@ -630,15 +663,7 @@ int SaveStateEmbed(char *file) {
 		psxBiosFreeze(1);
 
 	// gpu
-	gpufP = (GPUFreeze_t *) malloc(sizeof(GPUFreeze_t));
-	gpufP->ulFreezeVersion = 1;
-	GPU_freeze(1, gpufP);
-	void* temp = gpufP->extraData;
-	gpufP->extraData = 0;
-	gzwrite(f, gpufP, sizeof(GPUFreeze_t));
-	gzwrite(f, temp, gpufP->extraDataSize);
-	GPU_freeze(3, gpufP);
-	free(gpufP);
+	GPUFreezeSave(f);
 
 	sioFreeze(f, 1);
 	cdrFreeze(f, 1);
@@ -662,7 +687,6 @@ int SaveStateEmbed(char *file) {
 
 int LoadStateEmbed(char *file) {
 	FILE* f;
-	GPUFreeze_t *gpufP;
 	int Size;
 	char header[32];
 	FILE* fp;
@@ -670,6 +694,8 @@ int LoadStateEmbed(char *file) {
 	uint8 * embSaveTmp;
 	size_t blockSize = Movie.memoryCard1Offset-Movie.saveStateOffset;
 
+	mdecSync();
+
 	embSaveTmp = (uint8*)malloc(blockSize);
 	fp = fopen(file,"rb");
 	fp2 = fopen("embsave.tmp","wb");
@@ -700,13 +726,7 @@ int LoadStateEmbed(char *file) {
 		psxBiosFreeze(0);
 
 	// gpu
-	gpufP = (GPUFreeze_t *) malloc (sizeof(GPUFreeze_t));
-	gzread(f, gpufP, sizeof(GPUFreeze_t));
-	gpufP->extraData = malloc(gpufP->extraDataSize);
-	gzread(f, gpufP->extraData, gpufP->extraDataSize);
-	GPU_freeze(0, gpufP);
-	free(gpufP->extraData);
-	free(gpufP);
+	GPUFreezeLoad(f);
 
 	sioFreeze(f, 0);
 	cdrFreeze(f, 0);
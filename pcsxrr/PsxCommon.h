@@ -138,6 +138,7 @@ typedef struct {
 	long UseNet;
 	long VSyncWA;
 	long PauseAfterPlayback;
+	long CdFast; // cd seek/read latency divisor, 0/1 - real drive speed
 } PcsxConfig;
 
 extern PcsxConfig Config;
@@ -192,6 +193,8 @@ struct MovieType {
 	char movieFilename[256];             //full path file name (ex:"c:/pcsx/movies/movie.pxm")
 	char bytesPerFrame;                  //size of each frame in bytes
 	char palTiming;                      //PAL mode (50 FPS instead of 60)
+	unsigned char cdFast;                //fast-disc factor (0/1: real drive timing)
+	unsigned char cdAudio;               //streamed cdda and real plain image TOC (0: older movie)
 	char currentCdrom;                   //in which CD number are we at now?
 	char CdromCount;                     //how many different cds are used in the movie
 	char CdromIds[MOVIE_MAX_CDROM_IDS];  //every CD ID used in the movie
@@ -200,6 +203,8 @@ struct MovieType {
 	char wavFilename[256];               //filename used in WAV capture
 	char startAvi;                       //start AVI capture at first emulated frame?
 	char startWav;                       //start WAV capture at first emulated frame?
+	char rawDump;                        //AVI capture as one raw AVI with the sound in it?
+	unsigned long startCapture;          //start AVI/WAV capture at what emulated frame?
 	unsigned long stopCapture;           //stop AVI/WAV capture at what emulated frame?
 	uint8* inputBuffer;                  //full movie input buffer
 	uint32 inputBufferSize;              //movie input buffer size
@@ -222,6 +227,10 @@ struct MovieControlType {
 #define MOVIE_FLAG_MEMORY_CARDS   (1<<3)
 #define MOVIE_FLAG_CHEAT_LIST     (1<<4)
 #define MOVIE_FLAG_IRQ_HACKS      (1<<5)
+#define MOVIE_FLAG_FAST_CD        (1<<6)
+#define MOVIE_FLAG_CD_AUDIO       (1<<7)
+
+#define MOVIE_MAX_CDFAST 16
 
 #define MOVIE_CONTROL_RESET       (1<<1)
 #define MOVIE_CONTROL_CDCASE      (1<<2)
@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include "PsxCommon.h"
+#include "avdump.h"
 #ifdef WIN32
 #include "Win32/Win32.h"
 #include "Win32/ram_search.h"
@@ -128,6 +129,7 @@ void psxRcntUpdate() {
 	char modeFlags;
 
 	if ((psxRegs.cycle - psxCounters[3].sCycle) >= psxCounters[3].Cycle) {
+		mdecSync(); // lua, cheats and the tool windows read ram directly
 		if (psxCounters[3].mode & 0x10000) { // VSync End (22 hsyncs)
 				psxCounters[3].mode&=~0x10000;
 				psxUpdateVSyncRate();
@@ -142,23 +144,17 @@ void psxRcntUpdate() {
 // raise VSync flag
 iVSyncFlag = 1;
 
-// start capture?
-if ( (Movie.startAvi) || (Movie.startWav) ) {
-	if (Movie.startAvi)
-		GPU_startAvi(Movie.aviFilename);
-	if (Movie.startWav)
-		SPUstartWav(Movie.wavFilename);
-	Movie.startAvi = 0;
-	Movie.startWav = 0;
-	Movie.capture = 1;
-}
+// dump the frame that just ended
+if (Movie.capture)
+	AVDumpFrame();
+
+// start capture? (the next frame is the first one dumped)
+if ( ((Movie.startAvi) || (Movie.startWav)) && (Movie.currentFrame+1 >= Movie.startCapture) )
+	AVDumpStart();
 
 // stop capture?
-if ( (Movie.stopCapture != 0) && (Movie.stopCapture == Movie.currentFrame) ) {
-	GPU_stopAvi();
-	SPUstopWav();
-	Movie.capture = 0;
-}
+if ( (Movie.stopCapture != 0) && (Movie.stopCapture == Movie.currentFrame) )
+	AVDumpStop();
 
 Movie.currentFrame++;
 
@@ -479,6 +479,7 @@ void psxHwWrite16(u32 add, u16 value) {
 	HW_DMA##n##_CHCR = SWAPu32(value); \
  \
 	if (SWAPu32(HW_DMA##n##_CHCR) & 0x01000000 && SWAPu32(HW_DMA_PCR) & (8 << (n * 4))) { \
+		mdecSync(); \
 		psxDma##n(HW_DMA##n##_MADR, HW_DMA##n##_BCR, HW_DMA##n##_CHCR); \
 	} \
 }
@@ -108,6 +108,7 @@ u8 psxMemRead8(u32 mem) {
 	char *p;
 	u32 t;
 
+	if (mdecPending) mdecSyncAddr(mem);
 	t = mem >> 16;
 	if (t == 0x1f80) {
 		if (mem < 0x1f801000)
@@ -131,6 +132,7 @@ u16 psxMemRead16(u32 mem) {
 	char *p;
 	u32 t;
 
+	if (mdecPending) mdecSyncAddr(mem);
 	t = mem >> 16;
 	if (t == 0x1f80) {
 		if (mem < 0x1f801000)
@@ -154,6 +156,7 @@ u32 psxMemRead32(u32 mem) {
 	char *p;
 	u32 t;
 
+	if (mdecPending) mdecSyncAddr(mem);
 	t = mem >> 16;
 	if (t == 0x1f80) {
 		if (mem < 0x1f801000)
@@ -177,6 +180,7 @@ void psxMemWrite8(u32 mem, u8 value) {
 	char *p;
 	u32 t;
 
+	if (mdecPending) mdecSyncAddr(mem);
 	t = mem >> 16;
 	if (t == 0x1f80) {
 		if (mem < 0x1f801000)
@@ -203,6 +207,7 @@ void psxMemWrite16(u32 mem, u16 value) {
 	char *p;
 	u32 t;
 
+	if (mdecPending) mdecSyncAddr(mem);
 	t = mem >> 16;
 	if (t == 0x1f80) {
 		if (mem < 0x1f801000)
@@ -230,6 +235,7 @@ void psxMemWrite32(u32 mem, u32 value) {
 	u32 t;
 
 //	if ((mem&0x1fffff) == 0x71E18 || value == 0x48088800) SysPrintf("t2fix!!\n");
+	if (mdecPending) mdecSyncAddr(mem);
 	t = mem >> 16;
 	if (t == 0x1f80) {
 		if (mem < 0x1f801000)
@@ -41,6 +41,7 @@ int psxInit() {
 }
 
 void psxReset() {
+	mdecSync();
 	psxCpu->Reset();
 
 	psxMemReset();
@@ -64,6 +65,7 @@ void psxReset() {
 }
 
 void psxShutdown() {
+	mdecSync();
 	psxMemShutdown();
 	psxBiosShutdown();
 
@@ -66,6 +66,8 @@ void SaveConfig()
 	WritePrivateProfileString("Plugins", "RCntFix", Str_Tmp, Conf_File);
 	wsprintf(Str_Tmp, "%d", Config.VSyncWA);
 	WritePrivateProfileString("Plugins", "VSyncWA", Str_Tmp, Conf_File);
+	wsprintf(Str_Tmp, "%d", Config.CdFast);
+	WritePrivateProfileString("Plugins", "CdFast", Str_Tmp, Conf_File);
 
 	for (int i = 0; i <= EMUCMDMAX; i++) 
 	{
@@ -104,6 +106,8 @@ int LoadConfig()
 	Config.PsxOut = GetPrivateProfileInt("Plugins", "PsxOut", 0, Conf_File);
 	Config.RCntFix = GetPrivateProfileInt("Plugins", "RCntFix", 0, Conf_File);
 	Config.VSyncWA = GetPrivateProfileInt("Plugins", "VSyncWA", 0, Conf_File);
+	Config.CdFast = GetPrivateProfileInt("Plugins", "CdFast", 0, Conf_File);
+	if (Config.CdFast > MOVIE_MAX_CDFAST) Config.CdFast = MOVIE_MAX_CDFAST;
 
 	int temp;
 	for (int i = 0; i <= EMUCMDMAX-1; i++)
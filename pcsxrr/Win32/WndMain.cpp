@@ -39,6 +39,7 @@
 #include "Win32.h"
 #include "../cheat.h"
 #include "../movie.h"
+#include "../avdump.h"
 #include "moviewin.h"
 #include "ram_search.h"
 #include "ramwatch.h"
@@ -302,6 +303,11 @@ int main(int argc, char **argv) {
 			Movie.startAvi = 1;
 			sprintf(Movie.aviFilename,"%s",argv[++i]);
 		}
+		else if (!strcmp(argv[i], "-dumpraw")) {
+			Movie.startAvi = 1;
+			Movie.rawDump = 1;
+			sprintf(Movie.aviFilename,"%s",argv[++i]);
+		}
 		else if (!strcmp(argv[i], "-dumpwav")) {
 			Movie.startWav = 1;
 			sprintf(Movie.wavFilename,"%s",argv[++i]);
@@ -309,8 +315,14 @@ int main(int argc, char **argv) {
 		else if (!strcmp(argv[i], "-lua")) {
 			PCSX_LoadLuaCode(argv[++i]);
 		}
+		else if (!strcmp(argv[i], "-startcapture"))
+			sscanf (argv[++i],"%lu",&Movie.startCapture);
 		else if (!strcmp(argv[i], "-stopcapture"))
 			sscanf (argv[++i],"%lu",&Movie.stopCapture);
+		else if (!strcmp(argv[i], "-loadstate")) {
+			sscanf (argv[++i],"%d",&iLoadStateFrom);
+			if (iLoadStateFrom == 0) iLoadStateFrom = 10;
+		}
 		else if (!strcmp(argv[i], "-readonly"))
 			Movie.readOnly = 1;
 		else if (!strcmp(argv[i], "-memwatch")) {
@@ -2059,7 +2071,7 @@ void WIN32_StartAviRecord()
 	sprintf(Movie.wavFilename, "%s%s%s.wav",fszDrive,fszDirectory,fszFilename);
 	SetMenu(gApp.hWnd, NULL);
 	OpenPlugins(gApp.hWnd);
-	GPU_startAvi(Movie.aviFilename);
+	GPU_startAvi(Movie.aviFilename);                 // through the codec the user picks
 	SPUstartWav(Movie.wavFilename);
 	if (NeedReset) { SysReset(); NeedReset = 0; }
 	Running = 1;
@@ -2070,9 +2082,7 @@ void WIN32_StopAviRecord()
 {
 	if (!Movie.capture)
 		return;
-	GPU_stopAvi();
-	SPUstopWav();
-	Movie.capture = 0;
+	AVDumpStop();
 	EnableMenuItem(gApp.hMenu,ID_START_CAPTURE,MF_ENABLED);
 }
 
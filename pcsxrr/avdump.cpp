@@ -0,0 +1,99 @@
+/*  Pcsx - Pc Psx Emulator
+ *  Copyright (C) 1999-2003  Pcsx Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Movie dumping. With -dumpraw and a gpu plugin that has GPUstartAvDump,
+// the picture and the sound go into one raw avi: the spu core mix is
+// collected here and handed to the gpu on each vsync, tagged with
+// Movie.currentFrame and the cpu cycles the frame took, so the two can't
+// drift apart. Otherwise (and for the GUI capture) the gpu's own avi
+// writer with its codec and the separate SPUstartWav file are used.
+//
+// Long movies can be dumped in parallel segments: each instance plays the
+// movie read-only from a keyframe savestate (-loadstate) and dumps
+// -startcapture..-stopcapture. The segments join frame exact.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "PsxCommon.h"
+#include "avdump.h"
+#include "spu/record.h"
+
+static int avDumpCombined = 0;
+static short *avAudio = NULL;                 // stereo samples since the last vsync
+static long avAudioCount = 0;
+static long avAudioSize = 0;
+static u32 avFrameStart = 0;                  // psxRegs.cycle at the last vsync
+
+void AVDumpStart() {
+	avDumpCombined = 0;
+	avAudioCount = 0;
+
+	if (Movie.startAvi && Movie.rawDump) {
+		long fps = Config.PsxType ? 50 : 60;
+		if (Config.VSyncWA) fps *= 2;
+
+		if (GPU_startAvDump(Movie.aviFilename, fps) == 0) {
+			avDumpCombined = 1;
+			RecordStartAV();                  // the spu mix comes to AVDumpSamples
+		}
+		else GPU_startAvi(Movie.aviFilename);
+	}
+	else if (Movie.startAvi)
+		GPU_startAvi(Movie.aviFilename);
+	if (Movie.startWav && !avDumpCombined)
+		SPUstartWav(Movie.wavFilename);
+
+	Movie.startAvi = 0;
+	Movie.startWav = 0;
+	Movie.capture = 1;
+	avFrameStart = psxRegs.cycle;
+}
+
+// vsync: the frame that just ended, with its sound
+void AVDumpFrame() {
+	// the 32 bit counter wraps after a couple of minutes, the length of a
+	// frame doesn't... with the frame number that places it exactly
+	u32 cycles = psxRegs.cycle - avFrameStart;
+
+	avFrameStart = psxRegs.cycle;
+	if (!avDumpCombined) return;
+
+	GPU_avDumpFrame(Movie.currentFrame, cycles, avAudio, avAudioCount);
+	avAudioCount = 0;
+}
+
+void AVDumpStop() {
+	GPU_stopAvi();
+	SPUstopWav();
+	avDumpCombined = 0;
+	avAudioCount = 0;
+	Movie.capture = 0;
+}
+
+void AVDumpSamples(short *pSamples, long lSamples) {
+	if (avAudioCount + lSamples > avAudioSize) {
+		long size = (avAudioCount + lSamples) * 2;
+		short *p = (short *)realloc(avAudio, size * 4);
+		if (p == NULL) return;
+		avAudio = p;
+		avAudioSize = size;
+	}
+	memcpy(avAudio + avAudioCount * 2, pSamples, lSamples * 4);
+	avAudioCount += lSamples;
+}
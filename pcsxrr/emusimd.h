@@ -0,0 +1,36 @@
+/*  Pcsx - Pc Psx Emulator
+ *  Copyright (C) 1999-2003  Pcsx Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// ENABLE_SSE2 switches on the SSE2 code paths. The project files may
+// define it (the x86 msvc builds do, msvc only targets SSE2 there with
+// /arch:SSE2), otherwise it follows the compiler's target.
+// Header only and plain C, so the plugins can include it too.
+
+#ifndef __EMUSIMD_H__
+#define __EMUSIMD_H__
+
+#if !defined(ENABLE_SSE2) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ENABLE_SSE2
+#endif
+
+#ifdef ENABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+#endif /* __EMUSIMD_H__ */
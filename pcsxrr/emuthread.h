@@ -0,0 +1,158 @@
+/*  Pcsx - Pc Psx Emulator
+ *  Copyright (C) 1999-2003  Pcsx Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Minimal thread / mutex / event wrappers over Win32 and pthreads.
+// Header only and plain C, so the plugins can include it too.
+
+#ifndef __EMUTHREAD_H__
+#define __EMUTHREAD_H__
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+typedef void (*emuThreadFunc)(void *arg);
+
+typedef struct {
+	emuThreadFunc func;
+	void *arg;
+} emuThreadStart;
+
+#ifdef _WIN32
+
+typedef HANDLE emuThread;
+typedef CRITICAL_SECTION emuMutex;
+typedef HANDLE emuEvent; // auto reset
+
+static __inline DWORD WINAPI emuThreadEntry(LPVOID p) {
+	emuThreadStart start = *(emuThreadStart *)p;
+	free(p);
+	start.func(start.arg);
+	return 0;
+}
+
+static __inline int emuThreadCreate(emuThread *t, emuThreadFunc func, void *arg) {
+	emuThreadStart *start = (emuThreadStart *)malloc(sizeof(emuThreadStart));
+	if (start == NULL) return -1;
+	start->func = func;
+	start->arg = arg;
+	*t = CreateThread(NULL, 0, emuThreadEntry, start, 0, NULL);
+	if (*t == NULL) { free(start); return -1; }
+	return 0;
+}
+
+static __inline void emuThreadJoin(emuThread *t) {
+	WaitForSingleObject(*t, INFINITE);
+	CloseHandle(*t);
+}
+
+static __inline void emuMutexInit(emuMutex *m)    { InitializeCriticalSection(m); }
+static __inline void emuMutexDestroy(emuMutex *m) { DeleteCriticalSection(m); }
+static __inline void emuMutexLock(emuMutex *m)    { EnterCriticalSection(m); }
+static __inline void emuMutexUnlock(emuMutex *m)  { LeaveCriticalSection(m); }
+
+static __inline void emuEventInit(emuEvent *e)    { *e = CreateEvent(NULL, FALSE, FALSE, NULL); }
+static __inline void emuEventDestroy(emuEvent *e) { CloseHandle(*e); }
+static __inline void emuEventSet(emuEvent *e)     { SetEvent(*e); }
+static __inline void emuEventWait(emuEvent *e)    { WaitForSingleObject(*e, INFINITE); }
+
+#define emuMemoryBarrier() MemoryBarrier()
+
+static __inline void emuAtomicInc(volatile long *p) { InterlockedIncrement(p); }
+
+static __inline int emuCpuCount(void) {
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return (int)si.dwNumberOfProcessors;
+}
+
+#else
+
+typedef pthread_t emuThread;
+typedef pthread_mutex_t emuMutex;
+typedef struct {
+	pthread_mutex_t m;
+	pthread_cond_t c;
+	int set;
+} emuEvent; // auto reset
+
+static __inline void *emuThreadEntry(void *p) {
+	emuThreadStart start = *(emuThreadStart *)p;
+	free(p);
+	start.func(start.arg);
+	return NULL;
+}
+
+static __inline int emuThreadCreate(emuThread *t, emuThreadFunc func, void *arg) {
+	emuThreadStart *start = (emuThreadStart *)malloc(sizeof(emuThreadStart));
+	if (start == NULL) return -1;
+	start->func = func;
+	start->arg = arg;
+	if (pthread_create(t, NULL, emuThreadEntry, start) != 0) { free(start); return -1; }
+	return 0;
+}
+
+static __inline void emuThreadJoin(emuThread *t) { pthread_join(*t, NULL); }
+
+static __inline void emuMutexInit(emuMutex *m)    { pthread_mutex_init(m, NULL); }
+static __inline void emuMutexDestroy(emuMutex *m) { pthread_mutex_destroy(m); }
+static __inline void emuMutexLock(emuMutex *m)    { pthread_mutex_lock(m); }
+static __inline void emuMutexUnlock(emuMutex *m)  { pthread_mutex_unlock(m); }
+
+static __inline void emuEventInit(emuEvent *e) {
+	pthread_mutex_init(&e->m, NULL);
+	pthread_cond_init(&e->c, NULL);
+	e->set = 0;
+}
+
+static __inline void emuEventDestroy(emuEvent *e) {
+	pthread_cond_destroy(&e->c);
+	pthread_mutex_destroy(&e->m);
+}
+
+static __inline void emuEventSet(emuEvent *e) {
+	pthread_mutex_lock(&e->m);
+	e->set = 1;
+	pthread_cond_signal(&e->c);
+	pthread_mutex_unlock(&e->m);
+}
+
+static __inline void emuEventWait(emuEvent *e) {
+	pthread_mutex_lock(&e->m);
+	while (!e->set) pthread_cond_wait(&e->c, &e->m);
+	e->set = 0;
+	pthread_mutex_unlock(&e->m);
+}
+
+#define emuMemoryBarrier() __sync_synchronize()
+
+static __inline void emuAtomicInc(volatile long *p) { __sync_fetch_and_add(p, 1); }
+
+static __inline int emuCpuCount(void) {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (int)n : 1;
+}
+
+#endif
+
+#endif /* __EMUTHREAD_H__ */
@@ -7,8 +7,11 @@
 void SaveConf()
 {
 	char Conf_File[1024] = ".\\pcsx.ini";	//TODO: make a global for other files
+	char Str_Tmp[32];
 	
 	WritePrivateProfileString("ISO", "IsoFile", IsoFile, Conf_File);
+	wsprintf(Str_Tmp, "%d", HunkCache);
+	WritePrivateProfileString("ISO", "HunkCache", Str_Tmp, Conf_File);
 
 }
 
@@ -17,4 +20,5 @@ void LoadConf()
 	char Conf_File[1024] = ".\\pcsx.ini";	//TODO: make a global for other files
 
 	GetPrivateProfileString("ISO", "IsoFile", "", &IsoFile[0], 256, Conf_File);
+	HunkCache = GetPrivateProfileInt("ISO", "HunkCache", 64, Conf_File);
 }
\ No newline at end of file
@@ -69,8 +69,10 @@ void CfgOpenFile() {
 }
 
 void UpdZmode() {
-	if (ComboBox_GetCurSel(GetDlgItem(hDlg, IDC_METHOD)) == 1)
-		 Zmode = 1;
+	int sel = ComboBox_GetCurSel(GetDlgItem(hDlg, IDC_METHOD));
+
+	if (sel == 2) Zmode = 3;
+	else if (sel == 1) Zmode = 1;
 	else Zmode = 2;
 }
 
@@ -85,6 +87,158 @@ void SysUpdate();
 //	}
 //}
 
+unsigned char Hbuf[CD_FRAMESIZE_RAW * HZ_HUNK];
+
+// .hz: header, index, hunks. The index is only known at the end, so it's
+// written over the placeholder when we're done.
+void OnCompressHz() {
+	struct stat buf;
+	FILE *Z;
+	unsigned long c, h, s, hunks;
+	unsigned long header[4];
+	unsigned long *index;
+
+	cdHandle = fopen(IsoFile, "rb");
+	if (cdHandle == NULL) {
+		return;
+	}
+	stat(IsoFile, &buf);
+	s = buf.st_size / CD_FRAMESIZE_RAW;
+	hunks = (s + HZ_HUNK - 1) / HZ_HUNK;
+
+	strcat(IsoFile, ".hz");
+	Z = fopen(IsoFile, "wb");
+	index = (unsigned long*)calloc(hunks + 1, 4);
+	if (Z == NULL || index == NULL) {
+		if (Z) fclose(Z);
+		free(index);
+		fclose(cdHandle); cdHandle = NULL;
+		return;
+	}
+
+	header[0] = HZ_MAGIC;
+	header[1] = HZ_VERSION;
+	header[2] = s;
+	header[3] = HZ_HUNK;
+	fwrite(header, 4, 4, Z);
+	fwrite(index, 4, hunks + 1, Z);
+	c = HZ_HEADER + (hunks + 1) * 4;
+
+	Button_Enable(GetDlgItem(hDlg, IDC_COMPRESSISO), FALSE);
+	Button_Enable(GetDlgItem(hDlg, IDC_DECOMPRESSISO), FALSE);
+	stop=0;
+
+	for (h=0; h<hunks; h++) {
+		unsigned long size, raw;
+		long per;
+
+		raw = (h == hunks - 1 ? s - h * HZ_HUNK : HZ_HUNK) * CD_FRAMESIZE_RAW;
+		fread(Hbuf, 1, raw, cdHandle);
+
+		// incompressible hunks are stored as is, the reader tells by the size
+		size = sizeof(Zbuf);
+		if (compress2(Zbuf, &size, Hbuf, raw, Z_BEST_COMPRESSION) != Z_OK || size >= raw) {
+			fwrite(Hbuf, 1, raw, Z);
+			size = raw;
+		} else fwrite(Zbuf, 1, size, Z);
+
+		index[h] = c;
+		c+=size;
+
+		per = (((h + 1) * 100) / hunks);
+		SendMessage(hProgress, PBM_SETPOS, per, 0);
+		SysUpdate();
+		if (stop) break;
+	}
+	index[hunks] = c;
+	fseek(Z, HZ_HEADER, SEEK_SET);
+	fwrite(index, 4, hunks + 1, Z);
+
+	if (!stop) Edit_SetText(hIsoFile, IsoFile);
+
+	fclose(cdHandle); cdHandle = NULL;
+	fclose(Z);
+	free(index);
+
+	Button_Enable(GetDlgItem(hDlg, IDC_COMPRESSISO), TRUE);
+	Button_Enable(GetDlgItem(hDlg, IDC_DECOMPRESSISO), TRUE);
+
+	if (!stop) SysMessage("Iso Image Comompressed OK");
+}
+
+void OnDecompressHz() {
+	FILE *f;
+	unsigned long h, s, hunks;
+	unsigned long header[4];
+	unsigned long *index;
+
+	cdHandle = fopen(IsoFile, "rb");
+	if (cdHandle == NULL) {
+		return;
+	}
+	if (fread(header, 4, 4, cdHandle) != 4 || header[0] != HZ_MAGIC ||
+		header[1] != HZ_VERSION || header[3] == 0 ||
+		header[3] * CD_FRAMESIZE_RAW > sizeof(Hbuf)) {
+		SysMessage("%s is not a .hz image", IsoFile);
+		fclose(cdHandle); cdHandle = NULL;
+		return;
+	}
+	s = header[2];
+	hunks = (s + header[3] - 1) / header[3];
+	index = (unsigned long*)malloc((hunks + 1) * 4);
+	if (index == NULL || fread(index, 4, hunks + 1, cdHandle) != hunks + 1) {
+		free(index);
+		fclose(cdHandle); cdHandle = NULL;
+		return;
+	}
+
+	IsoFile[strlen(IsoFile) - 3] = 0;
+	f = fopen(IsoFile, "wb");
+	if (f == NULL) {
+		free(index);
+		fclose(cdHandle); cdHandle = NULL;
+		return;
+	}
+
+	Button_Enable(GetDlgItem(hDlg, IDC_COMPRESSISO), FALSE);
+	Button_Enable(GetDlgItem(hDlg, IDC_DECOMPRESSISO), FALSE);
+	stop=0;
+
+	for (h=0; h<hunks; h++) {
+		unsigned long size, raw, ssize;
+		long per;
+
+		raw = (h == hunks - 1 ? s - h * header[3] : header[3]) * CD_FRAMESIZE_RAW;
+		ssize = index[h + 1] - index[h];
+		if (ssize > raw) break;
+
+		fseek(cdHandle, index[h], SEEK_SET);
+		if (ssize == raw) {
+			fread(Hbuf, 1, raw, cdHandle);
+		} else {
+			fread(Zbuf, 1, ssize, cdHandle);
+			size = raw;
+			uncompress(Hbuf, &size, Zbuf, ssize);
+		}
+		fwrite(Hbuf, 1, raw, f);
+
+		per = (((h + 1) * 100) / hunks);
+		SendMessage(hProgress, PBM_SETPOS, per, 0);
+		SysUpdate();
+		if (stop) break;
+	}
+	if (!stop) Edit_SetText(hIsoFile, IsoFile);
+
+	fclose(f);
+	fclose(cdHandle); cdHandle = NULL;
+	free(index);
+
+	Button_Enable(GetDlgItem(hDlg, IDC_COMPRESSISO), TRUE);
+	Button_Enable(GetDlgItem(hDlg, IDC_DECOMPRESSISO), TRUE);
+
+	if (!stop) SysMessage("Iso Image Decompressed OK");
+}
+
 void OnCompress() {
 	struct stat buf;
 	FILE *f;
@@ -95,6 +249,12 @@ void OnCompress() {
 
 	Edit_GetText(hIsoFile, IsoFile, 256);
 
+	UpdZmode();
+	if (Zmode == 3) {
+		OnCompressHz();
+		return;
+	}
+
 	cdHandle = fopen(IsoFile, "rb");
 	if (cdHandle == NULL) {
 		return;
@@ -175,6 +335,10 @@ void OnDecompress() {
 	Edit_GetText(hIsoFile, IsoFile, 256);
 
 	UpdateZmode();
+	if (Zmode == 3) {
+		OnDecompressHz();
+		return;
+	}
 	if (Zmode == 0) Zmode = 2;
 
 	strcpy(table, IsoFile);
@@ -269,11 +433,13 @@ static BOOL CALLBACK IsoConfigureDlgProc(HWND hW, UINT uMsg, WPARAM wParam, LPAR
 			hIsoFile  = GetDlgItem(hW, IDC_ISOFILE);
 			hMethod   = GetDlgItem(hW, IDC_METHOD);
 
-			for (i=0; i<2; i++)
+			for (i=0; i<3; i++)
 				ComboBox_AddString(hMethod, methods[i]);
 
 			Edit_SetText(hIsoFile, IsoFile);
-			if (strstr(IsoFile, ".Z") != NULL)
+			if (strstr(IsoFile, ".hz") != NULL)
+				 ComboBox_SetCurSel(hMethod, 2);
+			else if (strstr(IsoFile, ".Z") != NULL)
 				 ComboBox_SetCurSel(hMethod, 1);
 			else ComboBox_SetCurSel(hMethod, 0);
 
@@ -17,10 +17,19 @@
 
 #include <string>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#define stricmp strcasecmp
+#endif
+
 #include "cdriso.h"
 #include "Config.h"
 
 #include "PsxCommon.h"
+#include "emuthread.h"
 
 std::string CDR_iso_fileToOpen;
 
@@ -30,20 +39,153 @@ char CdDev[256];
 unsigned char cdbuffer[CD_FRAMESIZE_RAW * 10];
 unsigned char *pbuffer;
 
-int Zmode; // 1 Z - 2 bz2
+int Zmode; // 1 Z - 2 bz2 - 3 hz
 int fmode;						// 0 - file / 1 - Zfile
 char *Ztable;
 
+// .hz hunk cache, least recently used goes first. Ztable holds the index.
+int HunkCache = 64;
+
+typedef struct {
+	int hunk;
+	unsigned long used;
+	unsigned char *data;
+} hzSlot;
+
+static hzSlot *hzCache = NULL;
+static int hzSlots = 0;
+static hzSlot *hzLast = NULL;
+static unsigned long hzClock = 0;
+static unsigned char *hzZbuf = NULL;
+static unsigned long hzSectors = 0;
+static unsigned long hzHunk = 0;	// sectors per hunk
+
 FILE *cdHandle = NULL;
+
+// raw images are mapped whole and CDRgetBuffer() points straight into the
+// map, so reading a sector is neither a syscall nor a copy. The compressed
+// modes (and a failed mapping) still go through cdbuffer.
+unsigned char *isoMap = NULL;
+unsigned long isoMapSize = 0;
+#ifdef _WIN32
+static HANDLE isoMapFile = INVALID_HANDLE_VALUE;
+static HANDLE isoMapping = NULL;
+#endif
+
+int isoLBA = -1; // sector pbuffer holds, the only thing savestates need
+
+// track list. A .cue sheet gives the real one (audio tracks, one or more
+// .bin files), anything else is a single data track.
+#define MAXTRACKS 99
+
+typedef struct {
+	int audio;
+	int start;		// lba of index 01, what the toc reports
+	int first;		// lba of the first sector stored in the file
+	int end;		// lba past the last sector stored in the file
+	int fileLBA;	// lba that file offset 0 maps to
+	FILE *handle;
+} isoTrack;
+
+static isoTrack tracks[MAXTRACKS + 1]; // 1 based
+static int numTracks = 0;
+static FILE *cueFiles[MAXTRACKS];
+static int numCueFiles = 0;
+static char isoDataFile[512]; // file of track 1, the one that's mapped
+
+// cdda. CDRplay() only moves the play position, the core pulls one sector
+// per 1x sector time with CDRgetBufferCdda() so audio follows emulated time.
+// Unmapped files are read ahead in big sequential chunks, not a seek per
+// sector.
+#define CDDA_CHUNK 32
+
+static unsigned char cddaBuffer[CDDA_CHUNK * CD_FRAMESIZE_RAW];
+static unsigned char cddaSilence[CD_FRAMESIZE_RAW];
+static int cddaBufLBA = 0;
+static int cddaBufCount = 0;
+int cddaLBA = -1; // next sector to play, -1 when stopped
+
+// read-ahead. Once reads go sequential a worker thread decodes the sectors
+// after the current one into a ring (compressed images), or faults in the
+// pages of the map (raw images), so CDRreadTrack() finds them ready. The
+// ring is single producer / single consumer and lock free; only a seek
+// waits for the worker to park and restarts it at the new position.
+#define PREFETCH_RING 32
+
+typedef struct {
+	int lba;
+	long ret;	// what LoadSector gave, -1: failed
+	int ok;		// data holds the sector
+	unsigned char data[DATA_SIZE];
+} isoPrefetchSlot;
+
+static isoPrefetchSlot pfRing[PREFETCH_RING];
+static volatile unsigned long pfHead = 0;	// advanced by the worker
+static volatile unsigned long pfTail = 0;	// advanced by the emu thread
+static volatile int pfNext;			// lba the worker decodes next
+static volatile int pfState = -1;	// -1 no worker, 0 parked, 1 running
+static volatile int pfBusy = 0;
+static int pfEnd;					// the worker stops here
+static int pfLast = -2;				// last lba read
+static unsigned char pfSector[DATA_SIZE]; // what pbuffer holds outside the ring
+static emuThread pfThread;
+static emuEvent pfWake, pfIdle;
+
+static void PrefetchStart();
+static void PrefetchShutdown();
+
 char *methods[] = {
 	".Z  - compress faster",
-	".bz - compress better"
+	".bz - compress better",
+	".hz - fast random access"
 };
 
 char *LibName = "TAS ISO Plugin";
 
 
 
+static void MapIso(const char *file) {
+#ifdef _WIN32
+	DWORD hi;
+
+	isoMapFile = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (isoMapFile == INVALID_HANDLE_VALUE) return;
+	isoMapSize = GetFileSize(isoMapFile, &hi);
+	if (hi == 0 && isoMapSize != 0) {
+		isoMapping = CreateFileMapping(isoMapFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (isoMapping != NULL)
+			isoMap = (unsigned char *)MapViewOfFile(isoMapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (isoMap == NULL) {
+		if (isoMapping != NULL) { CloseHandle(isoMapping); isoMapping = NULL; }
+		CloseHandle(isoMapFile); isoMapFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	struct stat buf;
+	void *p;
+
+	if (fstat(fileno(cdHandle), &buf) == -1 || buf.st_size == 0) return;
+	p = mmap(NULL, buf.st_size, PROT_READ, MAP_SHARED, fileno(cdHandle), 0);
+	if (p == MAP_FAILED) return;
+	isoMap = (unsigned char *)p;
+	isoMapSize = buf.st_size;
+#endif
+}
+
+static void UnmapIso() {
+	if (isoMap == NULL) return;
+#ifdef _WIN32
+	UnmapViewOfFile(isoMap);
+	CloseHandle(isoMapping); isoMapping = NULL;
+	CloseHandle(isoMapFile); isoMapFile = INVALID_HANDLE_VALUE;
+#else
+	munmap(isoMap, isoMapSize);
+#endif
+	isoMap = NULL;
+	isoMapSize = 0;
+	pbuffer = cdbuffer;
+}
+
 long CDRinit(void) {
 	return 0;
 }
@@ -64,13 +206,239 @@ void UpdateZmode() {
 		if (!strncmp(IsoFile+(len-3), ".bz", 2)) {
 			Zmode = 2; return;
 		}
+		if (!strncmp(IsoFile+(len-3), ".hz", 3)) {
+			Zmode = 3; return;
+		}
 	}
 
 	Zmode = 0;
 }
 
+static int IsCue(const char *file) {
+	int len = strlen(file);
+
+	return len >= 4 && !stricmp(file + len - 4, ".cue");
+}
+
+static long FileSectors(FILE *f) {
+	long size;
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	return size / CD_FRAMESIZE_RAW;
+}
+
+// mm:ss:ff, not bcd
+static int CueTime(const char *str) {
+	int m = 0, s = 0, f = 0;
+
+	sscanf(str, "%d:%d:%d", &m, &s, &f);
+	return (m * 60 + s) * 75 + f;
+}
+
+static void CloseCue() {
+	int i;
+
+	for (i = 0; i < numCueFiles; i++) fclose(cueFiles[i]);
+	numCueFiles = 0;
+	numTracks = 0;
+}
+
+// fills tracks[] from the sheet and opens the files it names (relative to
+// the sheet). Only FILE, TRACK, INDEX and PREGAP matter to us.
+static int ParseCue(const char *cue) {
+	FILE *f;
+	char line[512], path[512], type[32], time[32];
+	char *p, *q;
+	int dirlen, num, idx;
+	int fileBase = 0; // lba of the current file's first sector
+	int pregap = 0;   // PREGAP sectors before the current track, not in any file
+	int index0[MAXTRACKS + 1], index1[MAXTRACKS + 1];
+	int t;
+
+	f = fopen(cue, "r");
+	if (f == NULL) return -1;
+
+	p = strrchr((char *)cue, '\\');
+	q = strrchr((char *)cue, '/');
+	if (q > p) p = q;
+	dirlen = p ? p - cue + 1 : 0;
+
+	numTracks = 0;
+	numCueFiles = 0;
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		for (p = line; *p == ' ' || *p == '\t'; p++);
+
+		if (!strncmp(p, "FILE", 4)) {
+			if (numCueFiles == MAXTRACKS) break;
+			if (numCueFiles > 0) fileBase += pregap + FileSectors(cueFiles[numCueFiles - 1]);
+			pregap = 0;
+
+			p += 4;
+			while (*p == ' ' || *p == '\t') p++;
+			if (*p == '"') {
+				q = strchr(++p, '"');
+			} else {
+				for (q = p; *q && *q != ' ' && *q != '\t' && *q != '\r' && *q != '\n'; q++);
+			}
+			if (q == NULL) q = p + strlen(p);
+			*q = 0;
+
+			if (*p == '/' || *p == '\\' || (p[0] && p[1] == ':')) path[0] = 0;
+			else { memcpy(path, cue, dirlen); path[dirlen] = 0; }
+			strncat(path, p, sizeof(path) - strlen(path) - 1);
+
+			cueFiles[numCueFiles] = fopen(path, "rb");
+			if (cueFiles[numCueFiles] == NULL) {
+				SysMessage("Error loading %s\n", path);
+				fclose(f);
+				CloseCue();
+				return -1;
+			}
+			if (numCueFiles == 0) strcpy(isoDataFile, path);
+			numCueFiles++;
+		} else if (!strncmp(p, "TRACK", 5)) {
+			if (numTracks == MAXTRACKS || numCueFiles == 0) break;
+			type[0] = 0;
+			sscanf(p + 5, "%d %31s", &num, type);
+
+			t = ++numTracks;
+			tracks[t].audio = !strcmp(type, "AUDIO");
+			tracks[t].handle = cueFiles[numCueFiles - 1];
+			tracks[t].fileLBA = fileBase + pregap;
+			index0[t] = index1[t] = -1;
+		} else if (!strncmp(p, "PREGAP", 6) && numTracks) {
+			pregap += CueTime(p + 6);
+			tracks[numTracks].fileLBA = fileBase + pregap;
+		} else if (!strncmp(p, "INDEX", 5) && numTracks) {
+			time[0] = 0;
+			sscanf(p + 5, "%d %31s", &idx, time);
+			if (idx == 0) index0[numTracks] = CueTime(time);
+			else if (idx == 1) index1[numTracks] = CueTime(time);
+		}
+	}
+	fclose(f);
+
+	if (numTracks == 0) {
+		CloseCue();
+		return -1;
+	}
+
+	for (t = 1; t <= numTracks; t++) {
+		if (index1[t] < 0) index1[t] = index0[t] < 0 ? 0 : index0[t];
+		tracks[t].start = tracks[t].fileLBA + index1[t];
+		// a pregap stored in the file (index 00) belongs to the track it leads into
+		tracks[t].first = tracks[t].fileLBA + (index0[t] < 0 ? index1[t] : index0[t]);
+	}
+	tracks[1].first = 0;
+	for (t = 1; t <= numTracks; t++) {
+		if (t < numTracks && tracks[t + 1].handle == tracks[t].handle)
+			tracks[t].end = tracks[t].fileLBA + (tracks[t + 1].first - tracks[t + 1].fileLBA);
+		else
+			tracks[t].end = tracks[t].fileLBA + FileSectors(tracks[t].handle);
+	}
+
+	return 0;
+}
+
+// the track lba is in, NULL before the first one
+static isoTrack *FindTrack(int lba) {
+	int t;
+
+	for (t = numTracks; t >= 1; t--) {
+		if (lba >= tracks[t].first) return &tracks[t];
+	}
+	return NULL;
+}
+
+static void HzClose() {
+	int i;
+
+	for (i = 0; i < hzSlots; i++) free(hzCache[i].data);
+	free(hzCache); hzCache = NULL;
+	free(hzZbuf); hzZbuf = NULL;
+	hzSlots = 0;
+	hzLast = NULL;
+}
+
+// reads the .hz header and index, sets up the hunk cache
+static int HzOpen() {
+	uint32 header[4];
+	unsigned long hunks, bytes;
+	int i;
+
+	if (fread(header, 4, 4, cdHandle) != 4 || header[0] != HZ_MAGIC ||
+		header[1] != HZ_VERSION || header[3] == 0)
+		return -1;
+	hzSectors = header[2];
+	hzHunk = header[3];
+	hunks = (hzSectors + hzHunk - 1) / hzHunk;
+	bytes = hzHunk * CD_FRAMESIZE_RAW;
+
+	Ztable = (char*)malloc((hunks + 1) * 4);
+	if (Ztable == NULL) return -1;
+	if (fread(Ztable, 4, hunks + 1, cdHandle) != hunks + 1) return -1;
+
+	hzSlots = HunkCache < 1 ? 1 : HunkCache;
+	hzCache = (hzSlot *)calloc(hzSlots, sizeof(hzSlot));
+	hzZbuf = (unsigned char *)malloc(bytes);
+	if (hzCache == NULL || hzZbuf == NULL) { HzClose(); return -1; }
+	for (i = 0; i < hzSlots; i++) {
+		hzCache[i].hunk = -1;
+		hzCache[i].data = (unsigned char *)malloc(bytes);
+		if (hzCache[i].data == NULL) { HzClose(); return -1; }
+	}
+	hzClock = 0;
+
+	return 0;
+}
+
+// the decompressed hunk, from the cache if it's there
+static unsigned char *HzGetHunk(int hunk) {
+	uint32 *index = (uint32 *)Ztable;
+	unsigned long size, bytes;
+	hzSlot *slot;
+	int i;
+
+	if (hzLast != NULL && hzLast->hunk == hunk) return hzLast->data;
+
+	slot = &hzCache[0];
+	for (i = 0; i < hzSlots; i++) {
+		if (hzCache[i].hunk == hunk) {
+			slot = &hzCache[i];
+			break;
+		}
+		if (hzCache[i].used < slot->used) slot = &hzCache[i];
+	}
+
+	if (slot->hunk != hunk) {
+		bytes = hzHunk;
+		if ((unsigned long)hunk * hzHunk + bytes > hzSectors) bytes = hzSectors - hunk * hzHunk;
+		bytes *= CD_FRAMESIZE_RAW;
+		size = index[hunk + 1] - index[hunk];
+		if (size > bytes) return NULL;
+
+		slot->hunk = -1;
+		fseek(cdHandle, index[hunk], SEEK_SET);
+		if (size == bytes) {
+			if (fread(slot->data, 1, size, cdHandle) != size) return NULL;
+		} else {
+			if (fread(hzZbuf, 1, size, cdHandle) != size) return NULL;
+			if (uncompress(slot->data, &bytes, hzZbuf, size) != Z_OK) return NULL;
+		}
+		slot->hunk = hunk;
+	}
+
+	slot->used = ++hzClock;
+	hzLast = slot;
+	return slot->data;
+}
+
 long CDRopen(void) {
 	struct stat buf;
+	int i;
 
 	if (cdHandle != NULL)
 		return 0;				/* it's already open */
@@ -99,7 +467,7 @@ long CDRopen(void) {
 
 	UpdateZmode();
 
-	if (Zmode) {
+	if (Zmode == 1 || Zmode == 2) {
 		FILE *f;
 		char table[256];
 
@@ -120,25 +488,71 @@ long CDRopen(void) {
 		}
 		fread(Ztable, 1, buf.st_size, f);
 		fclose(f);
+	} else if (Zmode == 3) {
+		fmode = 3;
 	} else {
 		fmode = 0;
 		pbuffer = cdbuffer;
 	}
 
-	cdHandle = fopen(IsoFile, "rb");
-	if (cdHandle == NULL) {
-		SysMessage("Error loading %s\n", IsoFile);
-		return -1;
+	if (!fmode && IsCue(IsoFile)) {
+		if (ParseCue(IsoFile) == -1) {
+			SysMessage("Error loading %s\n", IsoFile);
+			return -1;
+		}
+		// the cue files stay ours, cdHandle just aliases the first one
+		cdHandle = tracks[1].handle;
+	} else {
+		cdHandle = fopen(IsoFile, "rb");
+		if (cdHandle == NULL) {
+			SysMessage("Error loading %s\n", IsoFile);
+			return -1;
+		}
+
+		if (fmode == 3 && HzOpen() == -1) {
+			SysMessage("Error loading %s\n", IsoFile);
+			if (Ztable) { free(Ztable); Ztable = NULL; }
+			fclose(cdHandle);
+			cdHandle = NULL;
+			return -1;
+		}
+
+		strcpy(isoDataFile, IsoFile);
+		numTracks = 1;
+		tracks[1].audio = 0;
+		tracks[1].start = tracks[1].first = tracks[1].fileLBA = 0;
+		tracks[1].handle = cdHandle;
+		if (fmode == 1) tracks[1].end = buf.st_size / 6;
+		else if (fmode == 2) tracks[1].end = (buf.st_size / 4 - 1) * 10;
+		else if (fmode == 3) tracks[1].end = hzSectors;
+		else tracks[1].end = FileSectors(cdHandle);
 	}
 
+	if (!fmode) MapIso(isoDataFile);
+	isoLBA = -1;
+	cddaLBA = -1;
+	cddaBufCount = 0;
+
+	// only the first file is mapped, the worker keeps off the others
+	pfEnd = tracks[1].end;
+	for (i = 2; i <= numTracks && tracks[i].handle == cdHandle; i++) pfEnd = tracks[i].end;
+	pfLast = -2;
+	PrefetchStart();
+
 	return 0;
 }
 
 long CDRclose(void) {
 	if (cdHandle == NULL)
 		return 0;
-	fclose(cdHandle);
+	PrefetchShutdown();
+	UnmapIso();
+	if (numCueFiles) CloseCue();
+	else fclose(cdHandle);
 	cdHandle = NULL;
+	numTracks = 0;
+	cddaLBA = -1;
+	HzClose();
 	if (Ztable) { free(Ztable); Ztable = NULL; }
 
 	return 0;
@@ -150,7 +564,7 @@ long CDRclose(void) {
 //  byte 1 - end track
 long CDRgetTN(unsigned char *buffer) {
 	buffer[0] = 1;
-	buffer[1] = 1;
+	buffer[1] = numTracks ? numTracks : 1;
 
 	return 0;
 }
@@ -161,31 +575,51 @@ long CDRgetTN(unsigned char *buffer) {
 //  byte 1 - second
 //  byte 2 - minute
 long CDRgetTD(unsigned char track, unsigned char *buffer) {
-	buffer[2] = 0;
-	buffer[1] = 2;
-	buffer[0] = 0;
+	int lba;
+
+	// old movies saw 00:02:00 for every track of a plain image
+	if (numTracks == 0 || (numCueFiles == 0 && !MOV_CdAudio())) lba = 0;
+	else if (track == 0) lba = tracks[numTracks].end; // lead-out
+	else if (track <= numTracks) lba = tracks[track].start;
+	else return -1;
+
+	lba += 150;
+	buffer[2] = lba / (60*75);
+	buffer[1] = (lba / 75) % 60;
+	buffer[0] = lba % 75;
 
 	return 0;
 }
 
-// read track
-// time : byte 0 - minute ; byte 1 - second ; byte 2 - frame
-// uses bcd format
-long CDRreadTrack(unsigned char *time) {
-
-	if (cdHandle == NULL) return -1;
+// decodes sector lba, *out is left NULL when there's nothing there (past the
+// end, or a gap that isn't in any file) and the caller keeps the previous
+// sector like fread used to. Only touches pbuffer/isoLBA through the caller.
+static long LoadSector(int lba, unsigned char **out) {
+	unsigned char time[3];
 
-//	printf ("CDRreadTrack %d:%d:%d\n", btoi(time[0]), btoi(time[1]), btoi(time[2]));
+	*out = NULL;
 
 	if (!fmode) {
-		fseek(cdHandle, MSF2SECT(btoi(time[0]), btoi(time[1]), btoi(time[2])) * CD_FRAMESIZE_RAW + 12, SEEK_SET);
-		fread(cdbuffer, 1, DATA_SIZE, cdHandle);
+		isoTrack *t = FindTrack(lba);
+		unsigned long pos;
+
+		if (t == NULL || lba < t->fileLBA || lba >= t->end) return 0;
+		pos = (unsigned long)(lba - t->fileLBA) * CD_FRAMESIZE_RAW + 12;
+
+		if (isoMap != NULL && t->handle == cdHandle) {
+			if (pos + DATA_SIZE > isoMapSize) return 0;
+			*out = isoMap + pos;
+		} else {
+			fseek(t->handle, pos, SEEK_SET);
+			fread(cdbuffer, 1, DATA_SIZE, t->handle);
+			*out = cdbuffer;
+		}
 	} else if (fmode == 1) { //.Z
 		unsigned long pos, p;
 		unsigned long size;
 		unsigned char Zbuf[CD_FRAMESIZE_RAW];
 
-		p = MSF2SECT(btoi(time[0]), btoi(time[1]), btoi(time[2]));
+		p = lba;
 
 		pos = *(unsigned long*)&Ztable[p * 6];
 		fseek(cdHandle, pos, SEEK_SET);
@@ -196,22 +630,34 @@ long CDRreadTrack(unsigned char *time) {
 		size = CD_FRAMESIZE_RAW;
 		uncompress(cdbuffer, &size, Zbuf, p);
 		
-		pbuffer = cdbuffer + 12;
+		*out = cdbuffer + 12;
+	} else if (fmode == 3) { // .hz
+		unsigned char *hunk;
+
+		if (lba < 0 || (unsigned long)lba >= hzSectors) return 0;
+		hunk = HzGetHunk(lba / hzHunk);
+		if (hunk == NULL) return -1;
+		*out = hunk + (lba % hzHunk) * CD_FRAMESIZE_RAW + 12;
 	} else { // .bz
 		unsigned long pos, p, rp;
 		unsigned long size;
 		unsigned char Zbuf[CD_FRAMESIZE_RAW * 10 * 2];
 		int i;
 
+		p = lba + 150;
+		time[0] = itob(p / (60*75));
+		time[1] = itob((p / 75) % 60);
+		time[2] = itob(p % 75);
+
 		for (i=0; i<10; i++) {
 			if (memcmp(time, &cdbuffer[i * CD_FRAMESIZE_RAW + 12], 3) == 0) {
-				pbuffer = &cdbuffer[i * CD_FRAMESIZE_RAW + 12];
+				*out = &cdbuffer[i * CD_FRAMESIZE_RAW + 12];
 
 				return 0;
 			}
 		}
 
-		p = MSF2SECT(btoi(time[0]), btoi(time[1]), btoi(time[2]));
+		p = lba;
 
 		rp = p % 10;
 		p/= 10;
@@ -225,12 +671,158 @@ long CDRreadTrack(unsigned char *time) {
 		size = CD_FRAMESIZE_RAW * 10;
 		BZ2_bzBuffToBuffDecompress((char*)cdbuffer, (unsigned int*)&size, (char*)Zbuf, p, 0, 0);
 
-		pbuffer = cdbuffer + rp * CD_FRAMESIZE_RAW + 12;
+		*out = cdbuffer + rp * CD_FRAMESIZE_RAW + 12;
+	}
+
+	return 0;
+}
+
+// worker side of the read-ahead, see PrefetchRead()
+static void PrefetchMain(void *arg) {
+	isoPrefetchSlot *slot;
+	unsigned char *p;
+	volatile unsigned char touch;
+	int lba, i;
+
+	for (;;) {
+		emuEventWait(&pfWake);
+		if (pfState < 0) break;
+
+		pfBusy = 1;
+		emuMemoryBarrier();
+		while (pfState == 1 && pfHead - pfTail < PREFETCH_RING && pfNext < pfEnd) {
+			slot = &pfRing[pfHead % PREFETCH_RING];
+			lba = pfNext;
+
+			slot->lba = lba;
+			slot->ret = LoadSector(lba, &p);
+			slot->ok = slot->ret == 0 && p != NULL;
+			if (slot->ok) {
+				// the map needs no copy, faulting its pages in is the point
+				if (!fmode) for (i = 0; i < DATA_SIZE; i += 1024) touch = p[i];
+				else memcpy(slot->data, p, DATA_SIZE);
+			}
+
+			pfNext = lba + 1;
+			emuMemoryBarrier();
+			pfHead++;
+		}
+		emuMemoryBarrier();
+		pfBusy = 0;
+		emuMemoryBarrier();
+		emuEventSet(&pfIdle);
+	}
+}
+
+// parks the worker, after this the emu thread may decode on its own
+static void PrefetchStop() {
+	if (pfState != 1) return;
+	pfState = 0;
+	emuMemoryBarrier();
+	while (pfBusy) emuEventWait(&pfIdle);
+	emuMemoryBarrier();
+}
+
+static void PrefetchStart() {
+	// raw images that couldn't be mapped share their FILEs with cdda
+	if (pfState >= 0 || (!fmode && isoMap == NULL) || emuCpuCount() < 2) return;
+
+	emuEventInit(&pfWake);
+	emuEventInit(&pfIdle);
+	pfState = 0;
+	pfBusy = 0;
+	if (emuThreadCreate(&pfThread, PrefetchMain, NULL) != 0) {
+		emuEventDestroy(&pfWake);
+		emuEventDestroy(&pfIdle);
+		pfState = -1;
+	}
+}
+
+static void PrefetchShutdown() {
+	if (pfState < 0) return;
+	PrefetchStop();
+	pfState = -1;
+	emuEventSet(&pfWake);
+	emuThreadJoin(&pfThread);
+	emuEventDestroy(&pfWake);
+	emuEventDestroy(&pfIdle);
+}
+
+// the sector from the ring when the worker already has it. Everything
+// before it is dropped, the slot itself stays held (pbuffer points in it)
+// until the next read. Returns 0 on a miss, else 1 with *ret what the
+// sync path would return (-1 when the sector couldn't be decoded).
+static int PrefetchRead(int lba, long *ret) {
+	isoPrefetchSlot *slot;
+	unsigned char *p;
+
+	while (pfTail != pfHead) {
+		emuMemoryBarrier();
+		slot = &pfRing[pfTail % PREFETCH_RING];
+		if (slot->lba == lba) {
+			if (slot->ok) {
+				if (!fmode) LoadSector(lba, &p);
+				else p = slot->data;
+				pbuffer = p;
+				isoLBA = lba;
+			}
+			*ret = slot->ret;
+			emuEventSet(&pfWake);
+			return 1;
+		}
+		pfTail++;
+	}
+	return 0;
+}
+
+// reads sector lba into pbuffer
+static long ReadSector(int lba) {
+	unsigned char *p;
+	long ret;
+	int sequential = lba == pfLast + 1;
+
+	if (cdHandle == NULL) return -1;
+	pfLast = lba;
+
+	if (pfState == 1 && PrefetchRead(lba, &ret)) return ret;
+
+	// a seek (or no worker): decode it here and restart the read-ahead after it
+	PrefetchStop();
+	if (LoadSector(lba, &p) == -1) return -1;
+	if (p != NULL) {
+		if (fmode && pfState == 0) {
+			// cdbuffer and the hunk cache belong to the worker once it runs
+			memcpy(pfSector, p, DATA_SIZE);
+			p = pfSector;
+		}
+		pbuffer = p;
+		isoLBA = lba;
+	}
+
+	if (pfState == 0 && sequential) {
+		if (pbuffer >= (unsigned char *)pfRing && pbuffer < (unsigned char *)(pfRing + PREFETCH_RING)) {
+			memcpy(pfSector, pbuffer, DATA_SIZE);
+			pbuffer = pfSector;
+		}
+		pfHead = pfTail = 0;
+		pfNext = lba + 1;
+		pfState = 1;
+		emuMemoryBarrier();
+		emuEventSet(&pfWake);
 	}
 
 	return 0;
 }
 
+// read track
+// time : byte 0 - minute ; byte 1 - second ; byte 2 - frame
+// uses bcd format
+long CDRreadTrack(unsigned char *time) {
+//	printf ("CDRreadTrack %d:%d:%d\n", btoi(time[0]), btoi(time[1]), btoi(time[2]));
+
+	return ReadSector(MSF2SECT(btoi(time[0]), btoi(time[1]), btoi(time[2])));
+}
+
 // return readed track
 unsigned char* CDRgetBuffer(void) {
 	return pbuffer;
@@ -240,14 +832,61 @@ unsigned char* CDRgetBuffer(void) {
 // sector : byte 0 - minute ; byte 1 - second ; byte 2 - frame
 // does NOT uses bcd format
 long CDRplay(unsigned char *sector) {
+	cddaLBA = MSF2SECT(sector[0], sector[1], sector[2]);
+	if (cddaLBA < 0) cddaLBA = 0;
+
 	return 0;
 }
 
 // stops cdda audio
 long CDRstop(void) {
+	cddaLBA = -1;
+
 	return 0;
 }
 
+// returns the next 2352 byte sector of cdda (44100hz stereo, 16 bit little
+// endian) and moves on, NULL when stopped or past the end of the disc.
+// Data tracks and gaps play as silence, and so does all of a compressed
+// image (.Z/.bz/.hz): those only ever hold the data track, no cue sheet.
+unsigned char* CDRgetBufferCdda(void) {
+	isoTrack *t;
+	unsigned char *p;
+	int n;
+
+	if (cddaLBA < 0 || cdHandle == NULL) return NULL;
+
+	t = FindTrack(cddaLBA);
+	if (t == NULL || (t == &tracks[numTracks] && cddaLBA >= t->end)) {
+		cddaLBA = -1;
+		return NULL;
+	}
+
+	if (fmode || !t->audio || cddaLBA < t->fileLBA || cddaLBA >= t->end) {
+		p = cddaSilence;
+	} else if (isoMap != NULL && t->handle == cdHandle &&
+		(unsigned long)(cddaLBA - t->fileLBA + 1) * CD_FRAMESIZE_RAW <= isoMapSize) {
+		p = isoMap + (unsigned long)(cddaLBA - t->fileLBA) * CD_FRAMESIZE_RAW;
+	} else {
+		if (cddaLBA < cddaBufLBA || cddaLBA >= cddaBufLBA + cddaBufCount) {
+			n = t->end - cddaLBA;
+			if (n > CDDA_CHUNK) n = CDDA_CHUNK;
+			fseek(t->handle, (unsigned long)(cddaLBA - t->fileLBA) * CD_FRAMESIZE_RAW, SEEK_SET);
+			n = fread(cddaBuffer, CD_FRAMESIZE_RAW, n, t->handle);
+			if (n <= 0) {
+				cddaLBA = -1;
+				return NULL;
+			}
+			cddaBufLBA = cddaLBA;
+			cddaBufCount = n;
+		}
+		p = cddaBuffer + (cddaLBA - cddaBufLBA) * CD_FRAMESIZE_RAW;
+	}
+
+	cddaLBA++;
+	return p;
+}
+
 long CDRtest(void) {
 	if (*IsoFile == 0)
 		return 0;
@@ -259,10 +898,47 @@ long CDRtest(void) {
 	return 0;
 }
 
+// only the current sector is saved, it's read back from the image on load.
+// old states stored the whole cdbuffer, the sector header pbuffer pointed at
+// gives us the lba back (they never start with the tag: it'd be a sync
+// pattern or a bcd time there).
+#define ISO_FREEZE_TAG 0x4c4f5349 // "ISOL"
+#define ISO_FREEZE_TAG_CDDA 0x414f5349 // "ISOA", adds the cdda position
+
 int CDRisoFreeze(gzFile f, int Mode) {
-	gzfreezelarr(cdbuffer);
-	pbuffer = (unsigned char*)((intptr_t)pbuffer-(intptr_t)cdbuffer);
-	gzfreezel(&pbuffer);
-	pbuffer = (unsigned char*)((intptr_t)pbuffer+(intptr_t)cdbuffer);
+	uint32 tag = ISO_FREEZE_TAG_CDDA;
+	int32 lba = isoLBA;
+	int32 play = cddaLBA;
+
+	if (Mode == 1) {
+		gzfreezel(&tag);
+		gzfreezel(&lba);
+		gzfreezel(&play);
+		return 0;
+	}
+
+	play = -1;
+	gzfreezel(&tag);
+	if (tag == ISO_FREEZE_TAG_CDDA) {
+		gzfreezel(&lba);
+		gzfreezel(&play);
+	} else if (tag == ISO_FREEZE_TAG) {
+		gzfreezel(&lba);
+	} else {
+		unsigned char *old = (unsigned char *)malloc(sizeof(cdbuffer));
+		uint32 offset;
+
+		memcpy(old, &tag, 4);
+		fread(old + 4, 1, sizeof(cdbuffer) - 4, (FILE*)f);
+		gzfreezel(&offset);
+		lba = -1;
+		if (offset + 3 <= sizeof(cdbuffer))
+			lba = MSF2SECT(btoi(old[offset]), btoi(old[offset+1]), btoi(old[offset+2]));
+		free(old);
+	}
+
+	isoLBA = -1;
+	if (lba >= 0) ReadSector(lba);
+	cddaLBA = play;
 	return 0;
 }
\ No newline at end of file
@@ -29,10 +29,22 @@ extern FILE *cdHandle;
 extern unsigned char cdbuffer[CD_FRAMESIZE_RAW * 10];
 extern unsigned char *pbuffer;
 
-extern int Zmode; // 1 Z - 2 bz2
+extern int Zmode; // 1 Z - 2 bz2 - 3 hz
 extern int fmode;						// 0 - file / 1 - Zfile
 extern char *Ztable;
 
+// .hz images: zlib compressed hunks of a fixed number of sectors behind an
+// index in the same file, so any sector is one seek and one inflate away.
+//  header: "PXHZ", u32 version, u32 sectors, u32 sectors per hunk
+//  index:  hunks+1 u32 file offsets, hunk n is [index[n], index[n+1]) and
+//          stored as is when that's its full size
+#define HZ_MAGIC		0x5a485850 // "PXHZ"
+#define HZ_VERSION		1
+#define HZ_HEADER		16
+#define HZ_HUNK			16	// sectors per hunk the converter writes
+
+extern int HunkCache; // hunks kept decompressed
+
 extern char *methods[];
 
 void UpdateZmode();
@@ -52,6 +64,7 @@ long CDRtest(void);
 void CDRabout(void);
 long CDRplay(unsigned char *);
 long CDRstop(void);
+unsigned char* CDRgetBufferCdda(void);
 struct CdrStat {
 	unsigned long Type;
 	unsigned long Status;
@@ -0,0 +1,597 @@
+/*
+ * isoconv - compresses raw cd images into the formats cdriso reads
+ *
+ *  .Z   + .table  zlib, one sector per block
+ *  .bz  + .index  bzip2, ten sectors per block
+ *  .hz            zlib hunks behind an index in the same file
+ *
+ * Blocks are independent, so each batch is packed by all the worker
+ * threads and written back in order. Afterwards the image is read back
+ * through its table and compared with the source sector by sector.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <bzlib.h>
+
+#include "cdriso.h"
+#include "emuthread.h"
+
+#define MAXTHREADS		64
+#define BATCH_BYTES		(4 * 1024 * 1024)	// raw bytes per thread per batch
+
+typedef unsigned int u32;
+
+typedef struct {
+	int Zmode;					// 1 Z - 2 bz2 - 3 hz, like cdriso
+	const char *ext;
+	const char *table;			// sidecar, NULL when the index is in the image
+	unsigned long sectors;		// per block
+} isoFormat;
+
+static isoFormat formats[] = {
+	{ 1, ".Z",  ".table", 1 },
+	{ 2, ".bz", ".index", 10 },
+	{ 3, ".hz", NULL,     HZ_HUNK },
+};
+
+// one batch of consecutive blocks
+typedef struct {
+	isoFormat *fmt;
+	int verify;
+	unsigned long count;		// blocks in the batch
+	unsigned long blockBytes;	// raw size of a full block
+	unsigned long packSlot;		// compress: room per block in packed
+	unsigned char *raw;			// source, blockBytes per block
+	unsigned long *rawSize;
+	unsigned char *packed;		// compress: a slot per block / verify: file bytes
+	unsigned long *packOff;		// verify: block offset in packed
+	unsigned long *packSize;
+	volatile long bad;			// first block that failed, -1 if none
+} isoBatch;
+
+typedef struct {
+	int id;
+	emuThread thread;
+	emuEvent wake;
+	emuEvent done;
+	unsigned char *scratch;		// verify: decompressed block
+} isoWorker;
+
+static isoWorker workers[MAXTHREADS];
+static int threads;
+static isoBatch *job;
+static emuMutex failLock;
+static volatile int quit;
+
+static void Fail(isoBatch *b, unsigned long i) {
+	// only ever lowered, and read once every worker is done
+	emuMutexLock(&failLock);
+	if (b->bad < 0 || (long)i < b->bad) b->bad = i;
+	emuMutexUnlock(&failLock);
+}
+
+static int PackBlock(isoBatch *b, unsigned long i) {
+	unsigned char *in = b->raw + i * b->blockBytes;
+	unsigned char *out = b->packed + i * b->packSlot;
+	unsigned long raw = b->rawSize[i];
+	unsigned long size = b->packSlot;
+	unsigned int bzsize = b->packSlot;
+
+	switch (b->fmt->Zmode) {
+		case 1:
+			// the reader inflates .Z sectors into a one sector buffer
+			if (compress2(out, &size, in, raw, Z_BEST_COMPRESSION) != Z_OK ||
+				size > CD_FRAMESIZE_RAW) return -1;
+			break;
+
+		case 2:
+			if (BZ2_bzBuffToBuffCompress((char*)out, &bzsize, (char*)in, raw, 1, 0, 30) != BZ_OK)
+				return -1;
+			size = bzsize;
+			break;
+
+		case 3:
+			// incompressible hunks are stored as is, the reader tells by the size
+			if (compress2(out, &size, in, raw, Z_BEST_COMPRESSION) != Z_OK || size >= raw) {
+				memcpy(out, in, raw);
+				size = raw;
+			}
+			break;
+	}
+
+	b->packSize[i] = size;
+	return 0;
+}
+
+static int CheckBlock(isoBatch *b, unsigned long i, unsigned char *scratch) {
+	unsigned char *in = b->packed + b->packOff[i];
+	unsigned long ssize = b->packSize[i];
+	unsigned long raw = b->rawSize[i];
+	unsigned long size = b->blockBytes;
+	unsigned int bzsize = b->blockBytes;
+
+	switch (b->fmt->Zmode) {
+		case 1:
+			if (ssize > CD_FRAMESIZE_RAW ||
+				uncompress(scratch, &size, in, ssize) != Z_OK) return -1;
+			break;
+
+		case 2:
+			if (BZ2_bzBuffToBuffDecompress((char*)scratch, &bzsize, (char*)in, ssize, 0, 0) != BZ_OK)
+				return -1;
+			size = bzsize;
+			break;
+
+		case 3:
+			if (ssize > raw) return -1;
+			if (ssize == raw) {
+				memcpy(scratch, in, raw);
+				size = raw;
+			} else if (uncompress(scratch, &size, in, ssize) != Z_OK) return -1;
+			break;
+	}
+
+	if (size != raw || memcmp(scratch, b->raw + i * b->blockBytes, raw)) return -1;
+	return 0;
+}
+
+// blocks are dealt round robin so a run of silence doesn't land on one thread
+static void RunBatch(isoWorker *w) {
+	isoBatch *b = job;
+	unsigned long i;
+
+	for (i = w->id; i < b->count; i += threads) {
+		// anything past a failure is thrown away anyway
+		if (b->bad >= 0 && (long)i > b->bad) break;
+		if ((b->verify ? CheckBlock(b, i, w->scratch) : PackBlock(b, i)) != 0)
+			Fail(b, i);
+	}
+}
+
+static void WorkerMain(void *arg) {
+	isoWorker *w = (isoWorker *)arg;
+
+	for (;;) {
+		emuEventWait(&w->wake);
+		if (quit) break;
+		RunBatch(w);
+		emuEventSet(&w->done);
+	}
+}
+
+// the calling thread is worker 0
+static void ProcessBatch(isoBatch *b) {
+	int i;
+
+	b->bad = -1;
+	job = b;
+	for (i = 1; i < threads; i++) emuEventSet(&workers[i].wake);
+	RunBatch(&workers[0]);
+	for (i = 1; i < threads; i++) emuEventWait(&workers[i].done);
+}
+
+static int StartWorkers(int n, unsigned long blockBytes) {
+	int i;
+
+	threads = n;
+	quit = 0;
+	for (i = 0; i < threads; i++) {
+		workers[i].id = i;
+		workers[i].scratch = (unsigned char *)malloc(blockBytes);
+		if (workers[i].scratch == NULL) return -1;
+		if (i == 0) continue;
+
+		emuEventInit(&workers[i].wake);
+		emuEventInit(&workers[i].done);
+		if (emuThreadCreate(&workers[i].thread, WorkerMain, &workers[i]) != 0) {
+			emuEventDestroy(&workers[i].wake);
+			emuEventDestroy(&workers[i].done);
+			free(workers[i].scratch);
+			workers[i].scratch = NULL;
+			threads = i;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static void StopWorkers() {
+	int i;
+
+	quit = 1;
+	for (i = 1; i < threads; i++) {
+		emuEventSet(&workers[i].wake);
+		emuThreadJoin(&workers[i].thread);
+		emuEventDestroy(&workers[i].wake);
+		emuEventDestroy(&workers[i].done);
+	}
+	for (i = 0; i < threads; i++) {
+		free(workers[i].scratch);
+		workers[i].scratch = NULL;
+	}
+}
+
+static int AllocBatch(isoBatch *b, isoFormat *fmt, int verify) {
+	unsigned long per;
+
+	memset(b, 0, sizeof(isoBatch));
+	b->fmt = fmt;
+	b->verify = verify;
+	b->blockBytes = fmt->sectors * CD_FRAMESIZE_RAW;
+	// worst case growth of either compressor plus its header
+	b->packSlot = b->blockBytes + b->blockBytes / 100 + 1024;
+
+	per = BATCH_BYTES / b->blockBytes;
+	if (per < 1) per = 1;
+	b->count = per * threads;
+
+	b->raw = (unsigned char *)malloc(b->count * b->blockBytes);
+	b->packed = (unsigned char *)malloc(b->count * b->packSlot);
+	b->rawSize = (unsigned long *)malloc(b->count * sizeof(unsigned long));
+	b->packOff = (unsigned long *)malloc(b->count * sizeof(unsigned long));
+	b->packSize = (unsigned long *)malloc(b->count * sizeof(unsigned long));
+	if (b->raw == NULL || b->packed == NULL || b->rawSize == NULL ||
+		b->packOff == NULL || b->packSize == NULL) return -1;
+
+	return 0;
+}
+
+static void FreeBatch(isoBatch *b) {
+	free(b->raw);
+	free(b->packed);
+	free(b->rawSize);
+	free(b->packOff);
+	free(b->packSize);
+}
+
+// reads up to max blocks of the source, returns how many
+static unsigned long ReadBlocks(isoBatch *b, FILE *src, unsigned long left, unsigned long max) {
+	unsigned long i, n;
+
+	for (n = 0; n < max && left > 0; n++) {
+		unsigned long sectors = left < b->fmt->sectors ? left : b->fmt->sectors;
+
+		b->rawSize[n] = sectors * CD_FRAMESIZE_RAW;
+		if (fread(b->raw + n * b->blockBytes, 1, b->rawSize[n], src) != b->rawSize[n]) break;
+		left -= sectors;
+	}
+	for (i = n; i < max; i++) b->rawSize[i] = 0;
+
+	return n;
+}
+
+static void Progress(const char *what, unsigned long done, unsigned long total) {
+	fprintf(stderr, "\r%s: %lu%%", what, total ? (done * 100) / total : 100);
+	fflush(stderr);
+}
+
+static int Compress(const char *file, const char *out, isoFormat *fmt, unsigned long sectors) {
+	isoBatch b;
+	FILE *src, *Z, *f = NULL;
+	char table[300] = "";
+	u32 header[4];
+	u32 *index = NULL;
+	unsigned long blocks, done = 0, c = 0, left = sectors;
+	int ret = -1;
+
+	blocks = (sectors + fmt->sectors - 1) / fmt->sectors;
+
+	src = fopen(file, "rb");
+	Z = fopen(out, "wb");
+	if (src == NULL || Z == NULL) {
+		fprintf(stderr, "Error opening %s\n", src == NULL ? file : out);
+		goto end;
+	}
+
+	if (fmt->table != NULL) {
+		sprintf(table, "%s%s", out, fmt->table);
+		f = fopen(table, "wb");
+		if (f == NULL) {
+			fprintf(stderr, "Error opening %s\n", table);
+			goto end;
+		}
+	} else {
+		// the index is only known at the end, it's written over the placeholder
+		index = (u32 *)calloc(blocks + 1, 4);
+		if (index == NULL) goto end;
+		header[0] = HZ_MAGIC;
+		header[1] = HZ_VERSION;
+		header[2] = sectors;
+		header[3] = fmt->sectors;
+		fwrite(header, 4, 4, Z);
+		fwrite(index, 4, blocks + 1, Z);
+		c = HZ_HEADER + (blocks + 1) * 4;
+	}
+
+	if (AllocBatch(&b, fmt, 0) != 0) {
+		fprintf(stderr, "Out of memory\n");
+		FreeBatch(&b);
+		goto end;
+	}
+
+	while (done < blocks) {
+		unsigned long i, n, count = b.count;
+
+		n = ReadBlocks(&b, src, left, count);
+		if (n == 0) {
+			fprintf(stderr, "\nError reading %s\n", file);
+			break;
+		}
+		b.count = n;
+		ProcessBatch(&b);
+		b.count = count;
+		if (b.bad >= 0) {
+			fprintf(stderr, "\nSector %lu can't be stored as %s, try another format\n",
+				(done + b.bad) * fmt->sectors, fmt->ext);
+			break;
+		}
+
+		for (i = 0; i < n; i++) {
+			u32 pos = c;
+			unsigned short size = (unsigned short)b.packSize[i];
+
+			if (f != NULL) {
+				fwrite(&pos, 1, 4, f);
+				if (fmt->Zmode == 1) fwrite(&size, 1, 2, f);
+			} else index[done + i] = pos;
+
+			fwrite(b.packed + i * b.packSlot, 1, b.packSize[i], Z);
+			c += b.packSize[i];
+			left -= b.rawSize[i] / CD_FRAMESIZE_RAW;
+		}
+		done += n;
+		Progress("compress", done, blocks);
+	}
+	fprintf(stderr, "\n");
+
+	if (done == blocks) {
+		u32 pos = c;
+
+		if (fmt->Zmode == 2) fwrite(&pos, 1, 4, f);
+		if (index != NULL) {
+			index[blocks] = pos;
+			fseek(Z, HZ_HEADER, SEEK_SET);
+			fwrite(index, 4, blocks + 1, Z);
+		}
+		if (ferror(Z) || (f != NULL && ferror(f))) fprintf(stderr, "Error writing %s\n", out);
+		else {
+			printf("%s: %lu sectors, %lu -> %lu bytes\n", out, sectors,
+				sectors * CD_FRAMESIZE_RAW, c + (f != NULL ? (unsigned long)ftell(f) : 0));
+			ret = 0;
+		}
+	}
+	FreeBatch(&b);
+
+end:
+	if (src) fclose(src);
+	if (Z) fclose(Z);
+	if (f) fclose(f);
+	free(index);
+	// don't leave a half written image behind for cdriso to pick up
+	if (ret != 0 && Z) {
+		remove(out);
+		if (fmt->table != NULL) remove(table);
+	}
+	return ret;
+}
+
+// loads the block offsets and sizes the way cdriso would find them
+static long LoadIndex(const char *out, isoFormat *fmt, FILE *Z, unsigned long sectors,
+					  unsigned long **off, unsigned long **len) {
+	struct stat buf;
+	char table[300];
+	unsigned char *t;
+	unsigned long i, blocks;
+	FILE *f;
+
+	blocks = (sectors + fmt->sectors - 1) / fmt->sectors;
+	*off = (unsigned long *)malloc((blocks + 1) * sizeof(unsigned long));
+	*len = (unsigned long *)malloc((blocks + 1) * sizeof(unsigned long));
+	t = (unsigned char *)malloc((blocks + 1) * 6);
+	if (*off == NULL || *len == NULL || t == NULL) {
+		free(t);
+		return -1;
+	}
+
+	if (fmt->table != NULL) {
+		sprintf(table, "%s%s", out, fmt->table);
+		f = fopen(table, "rb");
+		if (f == NULL) {
+			fprintf(stderr, "Error opening %s\n", table);
+			free(t);
+			return -1;
+		}
+		fstat(fileno(f), &buf);
+		if ((unsigned long)buf.st_size != (fmt->Zmode == 1 ? blocks * 6 : (blocks + 1) * 4) ||
+			fread(t, 1, buf.st_size, f) != (unsigned long)buf.st_size) {
+			fprintf(stderr, "%s doesn't match the source\n", table);
+			fclose(f);
+			free(t);
+			return -1;
+		}
+		fclose(f);
+	} else {
+		u32 header[4];
+
+		if (fread(header, 4, 4, Z) != 4 || header[0] != HZ_MAGIC || header[1] != HZ_VERSION ||
+			header[2] != sectors || header[3] != fmt->sectors ||
+			fread(t, 4, blocks + 1, Z) != blocks + 1) {
+			fprintf(stderr, "%s doesn't match the source\n", out);
+			free(t);
+			return -1;
+		}
+	}
+
+	for (i = 0; i < blocks; i++) {
+		if (fmt->Zmode == 1) {
+			(*off)[i] = *(u32 *)&t[i * 6];
+			(*len)[i] = *(unsigned short *)&t[i * 6 + 4];
+		} else {
+			(*off)[i] = ((u32 *)t)[i];
+			(*len)[i] = ((u32 *)t)[i + 1] - ((u32 *)t)[i];
+		}
+	}
+	free(t);
+
+	return blocks;
+}
+
+static int Verify(const char *file, const char *out, isoFormat *fmt, unsigned long sectors) {
+	isoBatch b;
+	FILE *src, *Z;
+	unsigned long *off = NULL, *len = NULL;
+	unsigned long done = 0, left = sectors;
+	long blocks = -1;
+	int ret = -1;
+
+	memset(&b, 0, sizeof(isoBatch));
+	src = fopen(file, "rb");
+	Z = fopen(out, "rb");
+	if (src == NULL || Z == NULL) {
+		fprintf(stderr, "Error opening %s\n", src == NULL ? file : out);
+		goto end;
+	}
+
+	blocks = LoadIndex(out, fmt, Z, sectors, &off, &len);
+	if (blocks < 0) goto end;
+
+	if (AllocBatch(&b, fmt, 1) != 0) {
+		fprintf(stderr, "Out of memory\n");
+		goto end;
+	}
+
+	while (done < (unsigned long)blocks) {
+		unsigned long i, n, start, end, count = b.count;
+
+		n = ReadBlocks(&b, src, left, count);
+		if (n == 0) {
+			fprintf(stderr, "\nError reading %s\n", file);
+			break;
+		}
+
+		// the blocks of a batch are one contiguous run of the image
+		start = off[done];
+		end = start;
+		for (i = 0; i < n; i++) {
+			if (off[done + i] < start || len[i + done] > b.packSlot) break;
+			b.packOff[i] = off[done + i] - start;
+			b.packSize[i] = len[done + i];
+			if (b.packOff[i] + b.packSize[i] > end - start) end = start + b.packOff[i] + b.packSize[i];
+		}
+		if (i < n || end - start > count * b.packSlot) {
+			fprintf(stderr, "\nBad index entry for sector %lu\n", (done + i) * fmt->sectors);
+			break;
+		}
+		fseek(Z, start, SEEK_SET);
+		if (fread(b.packed, 1, end - start, Z) != end - start) {
+			fprintf(stderr, "\n%s is truncated\n", out);
+			break;
+		}
+
+		b.count = n;
+		ProcessBatch(&b);
+		b.count = count;
+		if (b.bad >= 0) {
+			unsigned long first = (done + b.bad) * fmt->sectors;
+			fprintf(stderr, "\nMismatch in block %lu (sectors %lu-%lu)\n", done + b.bad,
+				first, first + b.rawSize[b.bad] / CD_FRAMESIZE_RAW - 1);
+			break;
+		}
+
+		for (i = 0; i < n; i++) left -= b.rawSize[i] / CD_FRAMESIZE_RAW;
+		done += n;
+		Progress("verify", done, blocks);
+	}
+	fprintf(stderr, "\n");
+
+	if (done == (unsigned long)blocks) {
+		printf("%s: %lu sectors verified OK\n", out, sectors);
+		ret = 0;
+	}
+
+end:
+	FreeBatch(&b);
+	if (src) fclose(src);
+	if (Z) fclose(Z);
+	free(off);
+	free(len);
+	return ret;
+}
+
+static void Usage() {
+	printf("usage: isoconv [-z|-bz|-hz] [-j threads] [-o output] [-n|-t] image\n");
+	printf("  -z          .Z + .table, sector granular\n");
+	printf("  -bz         .bz + .index, best ratio (default)\n");
+	printf("  -hz         .hz, fast random access\n");
+	printf("  -j threads  worker threads (default: one per cpu)\n");
+	printf("  -o output   output image (default: image + extension)\n");
+	printf("  -n          don't verify after compressing\n");
+	printf("  -t          only verify an existing output against image\n");
+}
+
+int main(int argc, char *argv[]) {
+	isoFormat *fmt = &formats[1];
+	char out[256];
+	const char *file = NULL, *name = NULL;
+	int n = 0, check = 1, pack = 1;
+	struct stat buf;
+	unsigned long sectors;
+	int i, ret = 0;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-z")) fmt = &formats[0];
+		else if (!strcmp(argv[i], "-bz")) fmt = &formats[1];
+		else if (!strcmp(argv[i], "-hz")) fmt = &formats[2];
+		else if (!strcmp(argv[i], "-j") && i + 1 < argc) n = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc) name = argv[++i];
+		else if (!strcmp(argv[i], "-n")) check = 0;
+		else if (!strcmp(argv[i], "-t")) pack = 0;
+		else if (argv[i][0] != '-' && file == NULL) file = argv[i];
+		else {
+			Usage();
+			return 1;
+		}
+	}
+	if (file == NULL) {
+		Usage();
+		return 1;
+	}
+
+	if (name != NULL) snprintf(out, sizeof(out), "%s", name);
+	else snprintf(out, sizeof(out), "%s%s", file, fmt->ext);
+
+	if (stat(file, &buf) == -1) {
+		fprintf(stderr, "Error opening %s\n", file);
+		return 1;
+	}
+	sectors = buf.st_size / CD_FRAMESIZE_RAW;
+	if (buf.st_size % CD_FRAMESIZE_RAW)
+		fprintf(stderr, "%s: ignoring %lu trailing bytes\n", file,
+			(unsigned long)(buf.st_size % CD_FRAMESIZE_RAW));
+	if (sectors == 0) {
+		fprintf(stderr, "%s is empty\n", file);
+		return 1;
+	}
+
+	if (n <= 0) n = emuCpuCount();
+	if (n > MAXTHREADS) n = MAXTHREADS;
+	emuMutexInit(&failLock);
+	if (StartWorkers(n, fmt->sectors * CD_FRAMESIZE_RAW) != 0) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	if (pack) ret = Compress(file, out, fmt, sectors);
+	if (ret == 0 && check) ret = Verify(file, out, fmt, sectors);
+
+	StopWorkers();
+	emuMutexDestroy(&failLock);
+
+	return ret == 0 ? 0 : 1;
+}
@@ -105,8 +105,13 @@ int MOV_ReadMovieFile(char* szChoice, struct MovieType *tempMovie) {
 		tempMovie->cheatListIncluded = tempMovie->movieFlags&MOVIE_FLAG_CHEAT_LIST;
 		tempMovie->irqHacksIncluded = tempMovie->movieFlags&MOVIE_FLAG_IRQ_HACKS;
 		tempMovie->palTiming = tempMovie->movieFlags&MOVIE_FLAG_PAL_TIMING;
+		tempMovie->cdAudio = (tempMovie->movieFlags&MOVIE_FLAG_CD_AUDIO) ? 1 : 0;
 	}
-	fread(&empty, 1, 1, fd);  //reserved for more flags
+	empty = 0;
+	fread(&empty, 1, 1, fd);  //fast-disc factor (was reserved)
+	tempMovie->cdFast = 1;
+	if (tempMovie->movieFlags&MOVIE_FLAG_FAST_CD && empty > 1 && empty <= MOVIE_MAX_CDFAST)
+		tempMovie->cdFast = (unsigned char)empty;
 
 	fread(&tempMovie->padType1, 1, 1, fd);
 	fread(&tempMovie->padType2, 1, 1, fd);
@@ -199,12 +204,21 @@ static void WriteMovieHeader()
 		Movie.movieFlags |= MOVIE_FLAG_IRQ_HACKS;
 	if (Config.PsxType)
 		Movie.movieFlags |= MOVIE_FLAG_PAL_TIMING;
+	Movie.cdFast = 1;
+	if (Config.CdFast > 1) {
+		if (Config.CdFast > MOVIE_MAX_CDFAST)
+			Config.CdFast = MOVIE_MAX_CDFAST;
+		Movie.cdFast = (unsigned char)Config.CdFast;
+		Movie.movieFlags |= MOVIE_FLAG_FAST_CD;
+	}
+	Movie.cdAudio = 1;
+	Movie.movieFlags |= MOVIE_FLAG_CD_AUDIO;
 
 	fwrite(&szFileHeader, 1, 4, fpMovie);          //header
 	fwrite(&movieVersion, 1, 4, fpMovie);          //movie version
 	fwrite(&emuVersion, 1, 4, fpMovie);            //emu version
 	fwrite(&Movie.movieFlags, 1, 1, fpMovie);      //flags
-	fwrite(&empty, 1, 1, fpMovie);                 //reserved for more flags
+	fwrite(&Movie.cdFast, 1, 1, fpMovie);          //fast-disc factor
 	fwrite(&Movie.padType1, 1, 1, fpMovie);        //padType1
 	fwrite(&Movie.padType2, 1, 1, fpMovie);        //padType2
 	fwrite(&empty, 1, 4, fpMovie);                 //total frames
@@ -337,6 +351,7 @@ static int StartReplay()
 	SetBytesPerFrame();
 
 	Config.PsxType = Movie.palTiming;
+	Config.CdFast = Movie.cdFast;
 
 	if (Movie.saveStateIncluded)
 		LoadStateEmbed(Movie.movieFilename);
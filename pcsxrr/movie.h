@@ -22,4 +22,8 @@ int MOV_ReadMovieFile(char* filename, struct MovieType *tempMovie);
 bool IsMovieLoaded();
 int MovieFreeze(gzFile f, int Mode);
 
+// movies recorded before cdda got streamed play back without it: no
+// sectors pulled while playing and the old fixed TOC for plain images
+#define MOV_CdAudio() (Movie.mode == MOVIEMODE_INACTIVE || Movie.cdAudio)
+
 #endif /* __MOVIE_H__ */
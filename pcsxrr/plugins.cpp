@@ -64,6 +64,7 @@ GPUkeypressed       GPU_keypressed;
 GPUdisplayText      GPU_displayText;
 GPUmakeSnapshot     GPU_makeSnapshot;
 GPUfreeze           GPU_freeze;
+GPUfreezeEx         GPU_freezeEx;
 GPUgetScreenPic     GPU_getScreenPic;
 GPUshowScreenPic    GPU_showScreenPic;
 GPUclearDynarec     GPU_clearDynarec;
@@ -77,6 +78,8 @@ GPUsetspeedmode     GPU_setspeedmode;
 GPUshowframecounter GPU_showframecounter;
 GPUstartAvi         GPU_startAvi;
 GPUstopAvi          GPU_stopAvi;
+GPUstartAvDump      GPU_startAvDump;
+GPUavDumpFrame      GPU_avDumpFrame;
 GPUsendFpLuaGui     GPU_sendFpLuaGui;
 
 //cd rom function pointers 
@@ -236,6 +239,27 @@ long CALLBACK GPU__freeze(unsigned long ulGetFreezeData, GPUFreeze_t *pF) {
 	return 0;
 }
 
+// plugins without GPUfreezeEx: copy their extra data to the caller's buffer
+
+long CALLBACK GPU__freezeEx(unsigned long ulGetFreezeData, GPUFreeze_t *pF) {
+	void *extra = pF->extraData;
+	int size = pF->extraDataSize;
+	long ret;
+
+	if (ulGetFreezeData != 1) return GPU_freeze(ulGetFreezeData, pF);
+
+	pF->extraData = NULL;
+	pF->extraDataSize = 0;
+	ret = GPU_freeze(1, pF);
+	if (pF->extraData != NULL) {
+		if (pF->extraDataSize > size) ret = 0;
+		else memcpy(extra, pF->extraData, pF->extraDataSize);
+		GPU_freeze(3, pF);
+	}
+	pF->extraData = extra;
+	return ret;
+}
+
 long CALLBACK GPU__configure(void) { return 0; }
 long CALLBACK GPU__test(void) { return 0; }
 void CALLBACK GPU__about(void) {}
@@ -255,6 +279,8 @@ void CALLBACK GPU__setspeedmode(unsigned long newSpeedMode) {}
 void CALLBACK GPU__showframecounter(void) {}
 void CALLBACK GPU__startAvi(char* filename) {}
 void CALLBACK GPU__stopAvi(void) {}
+long CALLBACK GPU__startAvDump(char* filename, long fps) { return -1; }
+void CALLBACK GPU__avDumpFrame(unsigned long frame, unsigned long cycles, short* samples, long count) {}
 void CALLBACK GPU__sendFpLuaGui(void (*fpPCSX_LuaGui)(void *,int,int,int,int)) {}
 
 #define LoadGpuSym1(dest, name) \
@@ -292,6 +318,7 @@ int LoadGPUplugin(char *GPUdll) {
 	LoadGpuSym0(displayText, "GPUdisplayText");
 	LoadGpuSym0(makeSnapshot, "GPUmakeSnapshot");
 	LoadGpuSym0(freeze, "GPUfreeze");
+	LoadGpuSym0(freezeEx, "GPUfreezeEx");
 	LoadGpuSym0(getScreenPic, "GPUgetScreenPic");
 	LoadGpuSym0(showScreenPic, "GPUshowScreenPic");
 	LoadGpuSym0(clearDynarec, "GPUclearDynarec");
@@ -308,6 +335,8 @@ int LoadGPUplugin(char *GPUdll) {
 	LoadGpuSym0(showframecounter, "GPUshowframecounter");
 	LoadGpuSym0(startAvi, "GPUstartAvi");
 	LoadGpuSym0(stopAvi, "GPUstopAvi");
+	LoadGpuSym0(startAvDump, "GPUstartAvDump");
+	LoadGpuSym0(avDumpFrame, "GPUavDumpFrame");
 	LoadGpuSym0(sendFpLuaGui, "GPUsendFpLuaGui");
 
 	return 0;
@@ -68,6 +68,7 @@ unsigned short SPUreadDMA(void);
 void SPUwriteDMAMem(unsigned short *, int);
 void SPUreadDMAMem(unsigned short *, int);
 void SPUplayADPCMchannel(xa_decode_t *);
+void SPUplayCDDAchannel(short *, int);
 //void SPUregisterCallback(void (CALLBACK *callback)(void));
 long SPUconfigure(void);
 long SPUopen(HWND hwnd);
@@ -116,6 +117,8 @@ typedef struct {
 } GPUFreeze_t;
 #pragma pack(pop)
 typedef long (CALLBACK* GPUfreeze)(unsigned long, GPUFreeze_t *);
+// like GPUfreeze 0/1, but extraData is a buffer of extraDataSize bytes owned by the caller
+typedef long (CALLBACK* GPUfreezeEx)(unsigned long, GPUFreeze_t *);
 typedef long (CALLBACK* GPUgetScreenPic)(unsigned char *);
 typedef long (CALLBACK* GPUshowScreenPic)(unsigned char *);
 typedef void (CALLBACK* GPUclearDynarec)(void (CALLBACK *callback)(void));
@@ -130,6 +133,8 @@ typedef void (CALLBACK* GPUsetspeedmode)(unsigned long);
 typedef void (CALLBACK* GPUshowframecounter)(void);
 typedef long (CALLBACK* GPUstartAvi)(char* filename);
 typedef long (CALLBACK* GPUstopAvi)(void);
+typedef long (CALLBACK* GPUstartAvDump)(char*, long);
+typedef void (CALLBACK* GPUavDumpFrame)(unsigned long, unsigned long, short*, long);
 typedef long (CALLBACK* GPUsendFpLuaGui)(void (*fpPCSX_LuaGui)(void *,int,int,int,int));
 
 //plugin stuff From Shadow
@@ -154,6 +159,7 @@ extern GPUkeypressed       GPU_keypressed;
 extern GPUdisplayText      GPU_displayText;
 extern GPUmakeSnapshot     GPU_makeSnapshot;
 extern GPUfreeze           GPU_freeze;
+extern GPUfreezeEx         GPU_freezeEx;
 extern GPUgetScreenPic     GPU_getScreenPic;
 extern GPUshowScreenPic    GPU_showScreenPic;
 extern GPUclearDynarec     GPU_clearDynarec;
@@ -167,6 +173,8 @@ extern GPUsetspeedmode     GPU_setspeedmode;
 extern GPUshowframecounter GPU_showframecounter;
 extern GPUstartAvi         GPU_startAvi;
 extern GPUstopAvi          GPU_stopAvi;
+extern GPUstartAvDump      GPU_startAvDump;
+extern GPUavDumpFrame      GPU_avDumpFrame;
 extern GPUsendFpLuaGui     GPU_sendFpLuaGui;
 
 //cd rom plugin ;)
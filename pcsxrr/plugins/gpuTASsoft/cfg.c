@@ -855,6 +855,7 @@ void ReadConfig(void)
 	iUseNoStretchBlt = GetPrivateProfileInt("GPU", "iUseNoStretchBlt", 0, Conf_File);
 	iUseDither = GetPrivateProfileInt("GPU", "iUseDither", 0, Conf_File);
 	iUseGammaVal = GetPrivateProfileInt("GPU", "iUseGammaVal", 2048, Conf_File);
+	iGPUThread = GetPrivateProfileInt("GPU", "iGPUThread", 0, Conf_File);
 
 	if (!iFrameLimit)
 	{
@@ -1012,6 +1013,8 @@ void WriteConfig(void)
 	WritePrivateProfileString("GPU", "iUseDither", Str_Tmp, Conf_File);
 	sprintf(Str_Tmp, "%d", iUseGammaVal);
 	WritePrivateProfileString("GPU", "iUseGammaVal", Str_Tmp, Conf_File);
+	sprintf(Str_Tmp, "%d", iGPUThread);
+	WritePrivateProfileString("GPU", "iGPUThread", Str_Tmp, Conf_File);
 	sprintf(Str_Tmp, "%f", fFrameRate);
 	WritePrivateProfileString("GPU", "fFrameRate", Str_Tmp, Conf_File);
 	sprintf(Str_Tmp, "%d", iSysMemory);
@@ -1573,6 +1576,17 @@ void AboutDlgProc(void)
 
 ////////////////////////////////////////////////////////////////////////
 
+#ifdef _HEADLESS
+// the config file reader lives in the gtk cfg tool (conf.c), which
+// needs a display... headless runs go with the defaults below
+
+void ReadConfigFile(void)
+{
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
 void ReadConfig(void)
 {
 // defaults
@@ -1592,6 +1606,7 @@ void ReadConfig(void)
 	iUseDither=0;
 	iShowFPS=0;
 	bSSSPSXLimit=FALSE;
+	iGPUThread=0;
 
 // read sets
 	ReadConfigFile();
@@ -1678,6 +1693,7 @@ void WriteConfig(void)
 	SetFloatValue("FrameRate", fFrameRate);
 	SetValue("CfgFixes", (unsigned int)dwCfgFixes);
 	SetValue("UseFixes", iUseFixes);
+	SetValue("GPUThread", iGPUThread);
 
 	out = fopen(t,"wb");
 	if (!out) return;
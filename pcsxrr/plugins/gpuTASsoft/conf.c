@@ -66,20 +66,20 @@ static XF86VidModeModeInfo **modes=0;
 
 int            iResX;
 int            iResY;
-long           GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP;
-long           GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
-short          ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;
-long           lLowerpart;
+GPU_TLS long   GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP;
+GPU_TLS long   GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
+GPU_TLS short  ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;
+GPU_TLS long   lLowerpart;
 BOOL           bIsFirstFrame;
 int            iWinSize;
-BOOL           bCheckMask;
-unsigned short sSetMask;
-unsigned long  lSetMask;
+GPU_TLS BOOL   bCheckMask;
+GPU_TLS unsigned short sSetMask;
+GPU_TLS unsigned long  lSetMask;
 BOOL           bDeviceOK;
-short          g_m1;
-short          g_m2;
-short          g_m3;
-short          DrawSemiTrans;
+GPU_TLS short  g_m1;
+GPU_TLS short  g_m2;
+GPU_TLS short  g_m3;
+GPU_TLS short  DrawSemiTrans;
 int            iUseGammaVal;
 int            iUseScanLines;
 int            iUseDither;
@@ -87,22 +87,23 @@ int            iDesktopCol;
 int            iUseNoStretchBlt;
 int            iShowFPS;
 int            iFastFwd;
+int            iGPUThread;
 
 
-BOOL           bUsingTWin;
-TWin_t         TWin;
-unsigned long  clutid;
+GPU_TLS BOOL   bUsingTWin;
+GPU_TLS TWin_t TWin;
+GPU_TLS unsigned long  clutid;
 void (*primTableJ[256])(unsigned char *);
 void (*primTableSkip[256])(unsigned char *);
-unsigned short  usMirror;
+GPU_TLS unsigned short usMirror;
 unsigned long  dwCfgFixes;
 unsigned long  dwActFixes;
 int            iUseFixes;
 BOOL           bDoVSyncUpdate;
-long           drawX;
-long           drawY;
-long           drawW;
-long           drawH;
+GPU_TLS long   drawX;
+GPU_TLS long   drawY;
+GPU_TLS long   drawW;
+GPU_TLS long   drawH;
 
 VRAMLoad_t     VRAMWrite;
 VRAMLoad_t     VRAMRead;
@@ -673,6 +674,10 @@ void ReadConfigFile()
 	if (iUseFixes<0) iUseFixes=0;
 	if (iUseFixes>1) iUseFixes=1;
 
+	GetValue("GPUThread", iGPUThread);
+	if (iGPUThread<0) iGPUThread=0;
+	if (iGPUThread>8) iGPUThread=8;
+
 	free(pB);
 
 }
@@ -698,6 +703,7 @@ void ReadConfig(void)
 	iUseNoStretchBlt=1;
 	iShowFPS=0;
 	bSSSPSXLimit=FALSE;
+	iGPUThread=0;
 
 // read sets
 	ReadConfigFile();
@@ -783,6 +789,7 @@ void WriteConfig(void)
 	SetFloatValue("FrameRate", fFrameRate);
 	SetValue("CfgFixes", (unsigned int)dwCfgFixes);
 	SetValue("UseFixes", iUseFixes);
+	SetValue("GPUThread", iGPUThread);
 
 	out = fopen(t,"wb");
 	if (!out) return;
@@ -106,17 +106,20 @@
 #include "draw.h"
 #include "prim.h"
 #include "menu.h"
+#include "soft.h"
+#include "../../emuthread.h"
+#include "../../emusimd.h"
 
 ////////////////////////////////////////////////////////////////////////////////////
 // misc globals
 ////////////////////////////////////////////////////////////////////////////////////
 int            iResX;
 int            iResY;
-long           lLowerpart;
+GPU_TLS long   lLowerpart;
 BOOL           bIsFirstFrame = TRUE;
-BOOL           bCheckMask=FALSE; //!
-unsigned short sSetMask=0; //!
-unsigned long  lSetMask=0; //!
+GPU_TLS BOOL   bCheckMask=FALSE; //!
+GPU_TLS unsigned short sSetMask=0; //!
+GPU_TLS unsigned long  lSetMask=0; //!
 int            iDesktopCol=16;
 int            iShowFPS=0;
 int            iWinSize;
@@ -133,10 +136,6 @@ unsigned int   LUT16to32[65536];
 unsigned int   RGBtoYUV[65536];
 
 // prototypes
-extern void hq2x_16( unsigned char * srcPtr, DWORD srcPitch, unsigned char * dstPtr, int width, int height);
-extern void hq3x_16( unsigned char * srcPtr, DWORD srcPitch, unsigned char * dstPtr, int width, int height);
-extern void hq2x_32( unsigned char * srcPtr, DWORD srcPitch, unsigned char * dstPtr, int width, int height);
-extern void hq3x_32( unsigned char * srcPtr, DWORD srcPitch, unsigned char * dstPtr, int width, int height);
 void NoStretchedBlit2x(void);
 void NoStretchedBlit3x(void);
 void StretchedBlit2x(void);
@@ -189,6 +188,184 @@ __asm__ __volatile__ ( "movl %%edx, %0": "=g" (nMMXsupport));
 	return nMMXsupport;
 }
 
+////////////////////////////////////////////////////////////////////////
+// unchanged frame check: the display surface keeps the last blitted
+// frame, so if neither the display settings nor a vram tile below the
+// shown rect got written since then, the blit can be skipped
+////////////////////////////////////////////////////////////////////////
+
+typedef struct BLITFRAMETAG
+{
+	long          x,y;
+	long          x0,x1,y0,dy;
+	long          rgb24;
+	unsigned long stamp;
+} BlitFrame_t;
+
+static BlitFrame_t blitFrame;
+static BOOL        bBlitFrameValid=FALSE;
+
+void BlitFrameDirty(void)                              // surface got cleared/lost
+{
+	bBlitFrameValid=FALSE;
+}
+
+BOOL BlitFrameUnchanged(long x,long y,BOOL bOverlay)
+{
+	BlitFrame_t f;
+	long w;
+
+	if (bOverlay || iDebugMode ||                         // surface gets painted over
+	    DataWriteMode==DR_VRAMTRANSFER)                   // or vram upload not done yet
+	{
+		bBlitFrameValid=FALSE;
+		return FALSE;
+	}
+
+	w=PreviousPSXDisplay.Range.x1;
+	if (PSXDisplay.RGB24) w=((w*3)>>1)+1;
+
+	memset(&f,0,sizeof(f));
+	f.x=x;f.y=y;
+	f.x0=PreviousPSXDisplay.Range.x0;
+	f.x1=PreviousPSXDisplay.Range.x1;
+	f.y0=PreviousPSXDisplay.Range.y0;
+	f.dy=PreviousPSXDisplay.DisplayMode.y;
+	f.rgb24=PSXDisplay.RGB24;
+	f.stamp=VramStamp(x,y,x+w-1,y+f.dy-1);
+
+	if (bBlitFrameValid && !memcmp(&f,&blitFrame,sizeof(f))) return TRUE;
+
+	blitFrame=f;
+	bBlitFrameValid=TRUE;
+	return FALSE;
+}
+
+#define BLITOVERLAY (fpPCSX_LuaGui || usCursorActive || (ulKeybits&KEY_SHOWFPS))
+
+////////////////////////////////////////////////////////////////////////
+// scaler bands: the 2xSaI/scale/hq filters can do any rows y0..y1 of
+// the picture (with the usual edge handling), so the picture gets split
+// into horizontal bands done by a few threads... the caller does the
+// last band itself
+////////////////////////////////////////////////////////////////////////
+
+#define SCALE_MAX_THREADS 7
+#define SCALE_MIN_ROWS    16                           // smaller bands aren't worth it
+
+typedef struct SCALEJOBTAG
+{
+	ScaleBandFunc   func;
+	unsigned char * src;
+	unsigned char * dst;
+	DWORD           pitch;
+	int             width,height,y0,y1;
+} ScaleJob_t;
+
+static int           iScaleThreads=-1;                 // -1: not started yet
+static int           scaleThreadNum[SCALE_MAX_THREADS];
+static emuThread     scaleThread[SCALE_MAX_THREADS];
+static emuEvent      scaleWakeEvent[SCALE_MAX_THREADS];
+static emuEvent      scaleDoneEvent[SCALE_MAX_THREADS];
+static ScaleJob_t    scaleJob[SCALE_MAX_THREADS];
+static volatile BOOL bScaleQuit=FALSE;
+
+static void ScaleThreadFunc(void *arg)
+{
+	int i=*(int *)arg;
+	ScaleJob_t * j=&scaleJob[i];
+
+	for (;;)
+	{
+		emuEventWait(&scaleWakeEvent[i]);
+		if (bScaleQuit) break;
+		j->func(j->src,j->pitch,j->dst,j->width,j->height,j->y0,j->y1);
+		emuEventSet(&scaleDoneEvent[i]);
+	}
+}
+
+static void ScaleStartThreads(void)
+{
+	int i,n=emuCpuCount()-1;
+
+	if (n>SCALE_MAX_THREADS) n=SCALE_MAX_THREADS;
+
+	bScaleQuit=FALSE;
+	for (i=0;i<n;i++)
+	{
+		scaleThreadNum[i]=i;
+		emuEventInit(&scaleWakeEvent[i]);
+		emuEventInit(&scaleDoneEvent[i]);
+		if (emuThreadCreate(&scaleThread[i],ScaleThreadFunc,&scaleThreadNum[i])!=0)
+		{
+			emuEventDestroy(&scaleWakeEvent[i]);
+			emuEventDestroy(&scaleDoneEvent[i]);
+			break;
+		}
+	}
+	iScaleThreads=i;                                      // maybe 0: all on the caller
+}
+
+void ScaleStopThreads(void)
+{
+	int i;
+
+	if (iScaleThreads<=0) {iScaleThreads=-1;return;}
+
+	bScaleQuit=TRUE;
+	emuMemoryBarrier();
+
+	for (i=0;i<iScaleThreads;i++)
+	{
+		emuEventSet(&scaleWakeEvent[i]);
+		emuThreadJoin(&scaleThread[i]);
+		emuEventDestroy(&scaleWakeEvent[i]);
+		emuEventDestroy(&scaleDoneEvent[i]);
+	}
+	iScaleThreads=-1;
+}
+
+void ScaleBands(ScaleBandFunc func,unsigned char * src,DWORD pitch,
+                unsigned char * dst,int width,int height)
+{
+	int i,n,y,h;
+
+	if (iScaleThreads<0) ScaleStartThreads();
+
+	n=height/SCALE_MIN_ROWS;
+	if (n>iScaleThreads+1) n=iScaleThreads+1;
+	if (n<=1)
+	{
+		func(src,pitch,dst,width,height,0,height);
+		return;
+	}
+
+	h=height/n;
+	for (i=0,y=0;i<n-1;i++,y+=h)
+	{
+		scaleJob[i].func=func;
+		scaleJob[i].src=src;
+		scaleJob[i].dst=dst;
+		scaleJob[i].pitch=pitch;
+		scaleJob[i].width=width;
+		scaleJob[i].height=height;
+		scaleJob[i].y0=y;
+		scaleJob[i].y1=y+h;
+		emuEventSet(&scaleWakeEvent[i]);
+	}
+
+	func(src,pitch,dst,width,height,y,height);            // the last one is ours
+
+	for (i=0;i<n-1;i++) emuEventWait(&scaleDoneEvent[i]);
+}
+
+#define SCALE_BANDS(name)                                     \
+void name(unsigned char *srcPtr, DWORD srcPitch,              \
+          unsigned char *dstPtr, int width, int height)       \
+{                                                             \
+	ScaleBands(name##_band,srcPtr,srcPitch,dstPtr,width,height); \
+}
+
 ////////////////////////////////////////////////////////////////////////
 // generic 2xSaI helpers
 ////////////////////////////////////////////////////////////////////////
@@ -236,8 +413,8 @@ static __inline int GetResult2(DWORD A, DWORD B, DWORD C, DWORD D, DWORD E)
 	+ ((((A & qlowpixelMask8) + (B & qlowpixelMask8) + (C & qlowpixelMask8) + (D & qlowpixelMask8)) >> 2) & qlowpixelMask8))))
 
 
-void Super2xSaI_ex8(unsigned char *srcPtr, DWORD srcPitch,
-                    unsigned char  *dstBitmap, int width, int height)
+static void Super2xSaI_ex8_band(unsigned char *srcPtr, DWORD srcPitch,
+                                unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	DWORD srcPitchHalf    = srcPitch>>1;
@@ -254,10 +431,13 @@ void Super2xSaI_ex8(unsigned char *srcPtr, DWORD srcPitch,
 	DWORD product1a, product1b,
 	product2a, product2b;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (DWORD *)srcPtr;
 			dP = (DWORD *)(dstBitmap + line*dstPitch);
@@ -410,10 +590,12 @@ void Super2xSaI_ex8(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
+SCALE_BANDS(Super2xSaI_ex8)
+
 ////////////////////////////////////////////////////////////////////////
 
-void Std2xSaI_ex8(unsigned char *srcPtr, DWORD srcPitch,
-                  unsigned char *dstBitmap, int width, int height)
+static void Std2xSaI_ex8_band(unsigned char *srcPtr, DWORD srcPitch,
+                              unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	DWORD srcPitchHalf    = srcPitch>>1;
@@ -430,10 +612,13 @@ void Std2xSaI_ex8(unsigned char *srcPtr, DWORD srcPitch,
 	colorM, colorN, colorO, colorP;
 	DWORD product, product1, product2;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (DWORD *)srcPtr;
 			dP = (DWORD *)(dstBitmap + line*dstPitch);
@@ -644,10 +829,12 @@ void Std2xSaI_ex8(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
+SCALE_BANDS(Std2xSaI_ex8)
+
 ////////////////////////////////////////////////////////////////////////
 
-void SuperEagle_ex8(unsigned char *srcPtr, DWORD srcPitch,
-                    unsigned char  *dstBitmap, int width, int height)
+static void SuperEagle_ex8_band(unsigned char *srcPtr, DWORD srcPitch,
+                                unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	DWORD srcPitchHalf    = srcPitch>>1;
@@ -664,10 +851,13 @@ void SuperEagle_ex8(unsigned char *srcPtr, DWORD srcPitch,
 	DWORD product1a, product1b,
 	product2a, product2b;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (DWORD *)srcPtr;
 			dP = (DWORD *)(dstBitmap + line*dstPitch);
@@ -840,9 +1030,36 @@ void SuperEagle_ex8(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
+SCALE_BANDS(SuperEagle_ex8)
+
 /////////////////////////
 
-static __inline void scale2x_32_def_whole(unsigned long* dst0, unsigned long* dst1, const unsigned long* src0, const unsigned long* src1, const unsigned long* src2, unsigned count)
+#ifdef ENABLE_SSE2
+#define SCALE_SSE2
+
+// scale2x on 16 bytes: B above, H below, D/F left/right of E
+
+#define SCALE2X_SSE2(cmpeq,unpacklo,unpackhi,B,D,E,F,H,d0,d1)     \
+	{                                                           \
+		__m128i eqBH=cmpeq(B,H),eqDF=cmpeq(D,F),ne=_mm_or_si128(eqBH,eqDF); \
+		__m128i m0=_mm_andnot_si128(ne,cmpeq(D,B));             \
+		__m128i m1=_mm_andnot_si128(ne,cmpeq(F,B));             \
+		__m128i m2=_mm_andnot_si128(ne,cmpeq(D,H));             \
+		__m128i m3=_mm_andnot_si128(ne,cmpeq(F,H));             \
+		__m128i e0=_mm_or_si128(_mm_and_si128(m0,B),_mm_andnot_si128(m0,E)); \
+		__m128i e1=_mm_or_si128(_mm_and_si128(m1,B),_mm_andnot_si128(m1,E)); \
+		__m128i e2=_mm_or_si128(_mm_and_si128(m2,H),_mm_andnot_si128(m2,E)); \
+		__m128i e3=_mm_or_si128(_mm_and_si128(m3,H),_mm_andnot_si128(m3,E)); \
+		_mm_storeu_si128((__m128i *)(d0),  unpacklo(e0,e1));    \
+		_mm_storeu_si128((__m128i *)(d0)+1,unpackhi(e0,e1));    \
+		_mm_storeu_si128((__m128i *)(d1),  unpacklo(e2,e3));    \
+		_mm_storeu_si128((__m128i *)(d1)+1,unpackhi(e2,e3));    \
+	}
+
+#define LOADU(p) _mm_loadu_si128((const __m128i *)(p))
+#endif
+
+static __inline void scale2x_32_def_whole(unsigned int* dst0, unsigned int* dst1, const unsigned int* src0, const unsigned int* src1, const unsigned int* src2, unsigned count)
 {
 
 	// first pixel
@@ -868,6 +1085,19 @@ static __inline void scale2x_32_def_whole(unsigned long* dst0, unsigned long* ds
 
 	// central pixels
 	count -= 2;
+#ifdef SCALE_SSE2
+	for (; count>=4; count-=4)                            // 4 at once
+	{
+		SCALE2X_SSE2(_mm_cmpeq_epi32,_mm_unpacklo_epi32,_mm_unpackhi_epi32,
+		             LOADU(src0),LOADU(src1-1),LOADU(src1),LOADU(src1+1),LOADU(src2),
+		             dst0,dst1)
+		src0 += 4;
+		src1 += 4;
+		src2 += 4;
+		dst0 += 8;
+		dst1 += 8;
+	}
+#endif
 	while (count)
 	{
 		if (src0[0] != src2[0] && src1[-1] != src1[1])
@@ -910,89 +1140,139 @@ static __inline void scale2x_32_def_whole(unsigned long* dst0, unsigned long* ds
 	}
 }
 
-
-
-#ifndef MAX
-#define MAX(a,b)    (((a) > (b)) ? (a) : (b))
-#define MIN(a,b)    (((a) < (b)) ? (a) : (b))
-#endif
-
-void Scale2x_ex8(unsigned char *srcPtr, DWORD srcPitch,
-                 unsigned char  *dstPtr, int width, int height)
+static __inline void scale2x_16_def_whole(unsigned short* dst0, unsigned short* dst1, const unsigned short* src0, const unsigned short* src1, const unsigned short* src2, unsigned count)
 {
-#ifdef _WINDOWS
 
-	const int dstPitch = srcPitch;
-	int srcpitch = srcPitch >> 2;
-	int count = height;
+	if (count<2)                                          // one pixel wide
+	{
+		dst0[0] = dst0[1] = dst1[0] = dst1[1] = src1[0];
+		return;
+	}
 
-	unsigned long  *dst0 = (unsigned long  *)dstPtr;
-	unsigned long  *dst1 = dst0 + (dstPitch >> 1);
+	// first pixel
+	if (src0[0] != src2[0] && src1[0] != src1[1])
+	{
+		dst0[0] = src1[0] == src0[0] ? src0[0] : src1[0];
+		dst0[1] = src1[1] == src0[0] ? src0[0] : src1[0];
+		dst1[0] = src1[0] == src2[0] ? src2[0] : src1[0];
+		dst1[1] = src1[1] == src2[0] ? src2[0] : src1[0];
+	}
+	else
+	{
+		dst0[0] = src1[0];
+		dst0[1] = src1[0];
+		dst1[0] = src1[0];
+		dst1[1] = src1[0];
+	}
+	++src0;
+	++src1;
+	++src2;
+	dst0 += 2;
+	dst1 += 2;
 
-	unsigned long  *src0 = (unsigned long  *)srcPtr;
-	unsigned long  *src1 = src0 + srcpitch;
-	unsigned long  *src2 = src1 + srcpitch;
-	scale2x_32_def_whole(dst0, dst1, src0, src0, src1, width);
+	// central pixels
 	count -= 2;
+#ifdef SCALE_SSE2
+	for (; count>=8; count-=8)                            // 8 at once
+	{
+		SCALE2X_SSE2(_mm_cmpeq_epi16,_mm_unpacklo_epi16,_mm_unpackhi_epi16,
+		             LOADU(src0),LOADU(src1-1),LOADU(src1),LOADU(src1+1),LOADU(src2),
+		             dst0,dst1)
+		src0 += 8;
+		src1 += 8;
+		src2 += 8;
+		dst0 += 16;
+		dst1 += 16;
+	}
+#endif
 	while (count)
 	{
-		dst0 += dstPitch;
-		dst1 += dstPitch;
-		scale2x_32_def_whole(dst0, dst1, src0, src1, src2, width);
-		src0 = src1;
-		src1 = src2;
-		src2 += srcpitch;
+		if (src0[0] != src2[0] && src1[-1] != src1[1])
+		{
+			dst0[0] = src1[-1] == src0[0] ? src0[0] : src1[0];
+			dst0[1] = src1[1] == src0[0] ? src0[0] : src1[0];
+			dst1[0] = src1[-1] == src2[0] ? src2[0] : src1[0];
+			dst1[1] = src1[1] == src2[0] ? src2[0] : src1[0];
+		}
+		else
+		{
+			dst0[0] = src1[0];
+			dst0[1] = src1[0];
+			dst1[0] = src1[0];
+			dst1[1] = src1[0];
+		}
+
+		++src0;
+		++src1;
+		++src2;
+		dst0 += 2;
+		dst1 += 2;
 		--count;
 	}
-	dst0 += dstPitch;
-	dst1 += dstPitch;
-	scale2x_32_def_whole(dst0, dst1, src0, src1, src1, width);
-#else
 
-	int looph, loopw;
+	// last pixel
+	if (src0[0] != src2[0] && src1[-1] != src1[0])
+	{
+		dst0[0] = src1[-1] == src0[0] ? src0[0] : src1[0];
+		dst0[1] = src1[0] == src0[0] ? src0[0] : src1[0];
+		dst1[0] = src1[-1] == src2[0] ? src2[0] : src1[0];
+		dst1[1] = src1[0] == src2[0] ? src2[0] : src1[0];
+	}
+	else
+	{
+		dst0[0] = src1[0];
+		dst0[1] = src1[0];
+		dst1[0] = src1[0];
+		dst1[1] = src1[0];
+	}
+}
+
+#ifndef MAX
+#define MAX(a,b)    (((a) > (b)) ? (a) : (b))
+#define MIN(a,b)    (((a) < (b)) ? (a) : (b))
+#endif
+
+////////////////////////////////////////////////////////////////////////
+// scale2x/3x bands: the rows above/below get clamped at the picture
+// edges... the target pitch is 2*srcPitch (3*srcPitch for 3x off windows)
 
-	unsigned char * srcpix = srcPtr;
-	unsigned char * dstpix = dstPtr;
+#define SCALE_ROWS(type,src,pitch)                            \
+	const type * src1 = (const type *)((src) + y0*(pitch));   \
+	const type * src0 = (y0>0)        ? (const type *)((const unsigned char *)src1-(pitch)) : src1; \
+	const type * src2 = (y0<height-1) ? (const type *)((const unsigned char *)src1+(pitch)) : src1;
 
-	const int srcpitch = srcPitch;
+static void Scale2x_ex8_band(unsigned char *srcPtr, DWORD srcPitch,
+                             unsigned char *dstPtr, int width, int height, int y0, int y1)
+{
 	const int dstpitch = srcPitch<<1;
 
-	unsigned long E0, E1, E2, E3, B, D, E, F, H;
-	for (looph = 0; looph < height; ++looph)
+	for (; y0<y1; y0++)
 	{
-		for (loopw = 0; loopw < width; ++ loopw)
-		{
-			B = *(unsigned long*)(srcpix + (MAX(0,looph-1)*srcpitch) + (4*loopw));
-			D = *(unsigned long*)(srcpix + (looph*srcpitch) + (4*MAX(0,loopw-1)));
-			E = *(unsigned long*)(srcpix + (looph*srcpitch) + (4*loopw));
-			F = *(unsigned long*)(srcpix + (looph*srcpitch) + (4*MIN(width-1,loopw+1)));
-			H = *(unsigned long*)(srcpix + (MIN(height-1,looph+1)*srcpitch) + (4*loopw));
+		SCALE_ROWS(unsigned int,srcPtr,srcPitch)
+		unsigned int * dst0 = (unsigned int *)(dstPtr + y0*2*dstpitch);
 
-			if (B != H && D != F)
-			{
-				E0 = D == B ? D : E;
-				E1 = B == F ? F : E;
-				E2 = D == H ? D : E;
-				E3 = H == F ? F : E;
-			}
-			else
-			{
-				E0 = E;
-				E1 = E;
-				E2 = E;
-				E3 = E;
-			}
+		scale2x_32_def_whole(dst0, (unsigned int *)((unsigned char *)dst0+dstpitch), src0, src1, src2, width);
+	}
+}
 
+SCALE_BANDS(Scale2x_ex8)
 
-			*(unsigned long*)(dstpix + looph*2*dstpitch + loopw*2*4) = E0;
-			*(unsigned long*)(dstpix + looph*2*dstpitch + (loopw*2+1)*4) = E1;
-			*(unsigned long*)(dstpix + (looph*2+1)*dstpitch + loopw*2*4) = E2;
-			*(unsigned long*)(dstpix + (looph*2+1)*dstpitch + (loopw*2+1)*4) = E3;
-		}
+static void Scale2x_ex6_5_band(unsigned char *srcPtr, DWORD srcPitch,
+                               unsigned char *dstPtr, int width, int height, int y0, int y1)
+{
+	const int dstpitch = srcPitch<<1;
+
+	for (; y0<y1; y0++)
+	{
+		SCALE_ROWS(unsigned short,srcPtr,srcPitch)
+		unsigned short * dst0 = (unsigned short *)(dstPtr + y0*2*dstpitch);
+
+		scale2x_16_def_whole(dst0, (unsigned short *)((unsigned char *)dst0+dstpitch), src0, src1, src2, width);
 	}
-#endif
 }
 
+SCALE_BANDS(Scale2x_ex6_5)
+
 static __inline void scale3x_16_def_whole(unsigned short* dst0, unsigned short* dst1, unsigned short* dst2, const unsigned short* src0, const unsigned short* src1, const unsigned short* src2, unsigned count)
 {
 	// first pixel
@@ -1093,7 +1373,7 @@ static __inline void scale3x_16_def_whole(unsigned short* dst0, unsigned short*
 }
 
 
-static __inline void scale3x_32_def_whole(unsigned long* dst0, unsigned long* dst1, unsigned long* dst2, const unsigned long* src0, const unsigned long* src1, const unsigned long* src2, unsigned count)
+static __inline void scale3x_32_def_whole(unsigned int* dst0, unsigned int* dst1, unsigned int* dst2, const unsigned int* src0, const unsigned int* src1, const unsigned int* src2, unsigned count)
 {
 
 	// first pixel
@@ -1193,211 +1473,45 @@ static __inline void scale3x_32_def_whole(unsigned long* dst0, unsigned long* ds
 	}
 }
 
-void Scale3x_ex6_5(unsigned char *srcPtr, DWORD srcPitch,
-                   unsigned char  *dstPtr, int width, int height)
-{
 #ifdef _WINDOWS
-	int count = height;
-	int dstPitch = srcPitch;
-	int srcpitch = srcPitch>>1;
-
-	unsigned short  *dst0 = (unsigned short  *)dstPtr;
-	unsigned short  *dst1 = dst0 + dstPitch;
-	unsigned short  *dst2 = dst1 + dstPitch;
-
-	unsigned short  *src0 = (unsigned short  *)srcPtr;
-	unsigned short  *src1 = src0 + srcpitch;
-	unsigned short  *src2 = src1 + srcpitch;
-	scale3x_16_def_whole(dst0, dst1, dst2, src0, src0, src1, count);
-	dstPitch *= 3;
-	count -= 2;
-	while (count)
-	{
-
-		dst0 += dstPitch;
-		dst1 += dstPitch;
-		dst2 += dstPitch;
-
-		scale3x_16_def_whole(dst0, dst1, dst2, src0, src1, src2, width);
-		src0 = src1;
-		src1 = src2;
-		src2 += srcpitch;
-		--count;
-	}
-	dst0 += dstPitch;
-	dst1 += dstPitch;
-	dst2 += dstPitch;
-
-	scale3x_16_def_whole(dst0, dst1, dst2, src0, src1, src1, width);
+#define SCALE3X_DSTPITCH(p) ((p)<<1)
 #else
-
-	int looph, loopw;
-
-	unsigned char * srcpix = srcPtr;
-	unsigned char * dstpix = dstPtr;
-
-	const int srcpitch = srcPitch;
-	const int dstpitch = srcPitch*3;
-
-	unsigned short E0, E1, E2, E3, E4, E5, E6, E7, E8;
-	unsigned short A, B, C, D, E, F, G, H, I;
-	for (looph = 0; looph < height; ++looph)
-	{
-		for (loopw = 0; loopw < width; ++ loopw)
-		{
-			A = *(unsigned short*)(srcpix + (MAX(0,looph-1)*srcpitch) + (2*MAX(0,loopw-1)));
-			B = *(unsigned short*)(srcpix + (MAX(0,looph-1)*srcpitch) + (2*loopw));
-			C = *(unsigned short*)(srcpix + (MAX(0,looph-1)*srcpitch) + (2*MIN(width-1,loopw+1)));
-			D = *(unsigned short*)(srcpix + (looph*srcpitch) + (2*MAX(0,loopw-1)));
-			E = *(unsigned short*)(srcpix + (looph*srcpitch) + (2*loopw));
-			F = *(unsigned short*)(srcpix + (looph*srcpitch) + (2*MIN(width-1,loopw+1)));
-			G = *(unsigned short*)(srcpix + (MIN(height-1,looph+1)*srcpitch) + (2*MAX(0,loopw-1)));
-			H = *(unsigned short*)(srcpix + (MIN(height-1,looph+1)*srcpitch) + (2*loopw));
-			I = *(unsigned short*)(srcpix + (MIN(height-1,looph+1)*srcpitch) + (2*MIN(width-1,loopw+1)));
-
-			if (B != H && D != F)
-			{
-				E0 = D == B ? D : E;
-				E1 = (D == B && E != C) || (B == F && E != A) ? B : E;
-				E2 = B == F ? F : E;
-				E3 = (D == B && E != G) || (D == H && E != A) ? D : E;
-				E4 = E;
-				E5 = (B == F && E != I) || (H == F && E != C) ? F : E;
-				E6 = D == H ? D : E;
-				E7 = (D == H && E != I) || (H == F && E != G) ? H : E;
-				E8 = H == F ? F : E;
-			}
-			else
-			{
-				E0 = E;
-				E1 = E;
-				E2 = E;
-				E3 = E;
-				E4 = E;
-				E5 = E;
-				E6 = E;
-				E7 = E;
-				E8 = E;
-			}
-
-
-			*(unsigned long*)(dstpix + looph*3*dstpitch + loopw*3*2) = E0;
-			*(unsigned long*)(dstpix + looph*3*dstpitch + (loopw*3+1)*2) = E1;
-			*(unsigned long*)(dstpix + looph*3*dstpitch + (loopw*3+2)*2) = E2;
-			*(unsigned long*)(dstpix + (looph*3+1)*dstpitch + loopw*3*2) = E3;
-			*(unsigned long*)(dstpix + (looph*3+1)*dstpitch + (loopw*3+1)*2) = E4;
-			*(unsigned long*)(dstpix + (looph*3+1)*dstpitch + (loopw*3+2)*2) = E5;
-			*(unsigned long*)(dstpix + (looph*3+2)*dstpitch + loopw*3*2) = E6;
-			*(unsigned long*)(dstpix + (looph*3+2)*dstpitch + (loopw*3+1)*2) = E7;
-			*(unsigned long*)(dstpix + (looph*3+2)*dstpitch + (loopw*3+2)*2) = E8;
-		}
-	}
+#define SCALE3X_DSTPITCH(p) ((p)*3)
 #endif
-}
 
-void Scale3x_ex8(unsigned char *srcPtr, DWORD srcPitch,
-                 unsigned char  *dstPtr, int width, int height)
+static void Scale3x_ex6_5_band(unsigned char *srcPtr, DWORD srcPitch,
+                               unsigned char *dstPtr, int width, int height, int y0, int y1)
 {
-#ifdef _WINDOWS
-	int count = height;
-
-	int dstPitch = srcPitch >> 1;
-	int srcpitch = srcPitch >> 2;
-
-	unsigned long  *dst0 = (unsigned long  *)dstPtr;
-	unsigned long  *dst1 = dst0 + dstPitch;
-	unsigned long  *dst2 = dst1 + dstPitch;
+	const int dstpitch = SCALE3X_DSTPITCH(srcPitch);
 
-	unsigned long  *src0 = (unsigned long  *)srcPtr;
-	unsigned long  *src1 = src0 + srcpitch;
-	unsigned long  *src2 = src1 + srcpitch;
-	scale3x_32_def_whole(dst0, dst1, dst2, src0, src0, src1, width);
-	dstPitch *= 3;
-	count -= 2;
-	while (count)
+	for (; y0<y1; y0++)
 	{
-		dst0 += dstPitch;
-		dst1 += dstPitch;
-		dst2 += dstPitch;
+		SCALE_ROWS(unsigned short,srcPtr,srcPitch)
+		unsigned short * dst0 = (unsigned short *)(dstPtr + y0*3*dstpitch);
+		unsigned short * dst1 = (unsigned short *)((unsigned char *)dst0+dstpitch);
 
-		scale3x_32_def_whole(dst0, dst1, dst2, src0, src1, src2, width);
-		src0 = src1;
-		src1 = src2;
-		src2 += srcpitch;
-		--count;
+		scale3x_16_def_whole(dst0, dst1, (unsigned short *)((unsigned char *)dst1+dstpitch), src0, src1, src2, width);
 	}
-	dst0 += dstPitch;
-	dst1 += dstPitch;
-	dst2 += dstPitch;
-
-	scale3x_32_def_whole(dst0, dst1, dst2, src0, src1, src1, width);
-
-#else
-
-	int looph, loopw;
+}
 
-	unsigned char * srcpix = srcPtr;
-	unsigned char * dstpix = dstPtr;
+SCALE_BANDS(Scale3x_ex6_5)
 
-	const int srcpitch = srcPitch;
-	const int dstpitch = srcPitch*3;
+static void Scale3x_ex8_band(unsigned char *srcPtr, DWORD srcPitch,
+                             unsigned char *dstPtr, int width, int height, int y0, int y1)
+{
+	const int dstpitch = SCALE3X_DSTPITCH(srcPitch);
 
-	unsigned long E0, E1, E2, E3, E4, E5, E6, E7, E8;
-	unsigned long A, B, C, D, E, F, G, H, I;
-	for (looph = 0; looph < height; ++looph)
+	for (; y0<y1; y0++)
 	{
-		for (loopw = 0; loopw < width; ++ loopw)
-		{
-			A = *(unsigned long*)(srcpix + (MAX(0,looph-1)*srcpitch) + (4*MAX(0,loopw-1)));
-			B = *(unsigned long*)(srcpix + (MAX(0,looph-1)*srcpitch) + (4*loopw));
-			C = *(unsigned long*)(srcpix + (MAX(0,looph-1)*srcpitch) + (4*MIN(width-1,loopw+1)));
-			D = *(unsigned long*)(srcpix + (looph*srcpitch) + (4*MAX(0,loopw-1)));
-			E = *(unsigned long*)(srcpix + (looph*srcpitch) + (4*loopw));
-			F = *(unsigned long*)(srcpix + (looph*srcpitch) + (4*MIN(width-1,loopw+1)));
-			G = *(unsigned long*)(srcpix + (MIN(height-1,looph+1)*srcpitch) + (4*MAX(0,loopw-1)));
-			H = *(unsigned long*)(srcpix + (MIN(height-1,looph+1)*srcpitch) + (4*loopw));
-			I = *(unsigned long*)(srcpix + (MIN(height-1,looph+1)*srcpitch) + (4*MIN(width-1,loopw+1)));
-
-			if (B != H && D != F)
-			{
-				E0 = D == B ? D : E;
-				E1 = (D == B && E != C) || (B == F && E != A) ? B : E;
-				E2 = B == F ? F : E;
-				E3 = (D == B && E != G) || (D == H && E != A) ? D : E;
-				E4 = E;
-				E5 = (B == F && E != I) || (H == F && E != C) ? F : E;
-				E6 = D == H ? D : E;
-				E7 = (D == H && E != I) || (H == F && E != G) ? H : E;
-				E8 = H == F ? F : E;
-			}
-			else
-			{
-				E0 = E;
-				E1 = E;
-				E2 = E;
-				E3 = E;
-				E4 = E;
-				E5 = E;
-				E6 = E;
-				E7 = E;
-				E8 = E;
-			}
-
+		SCALE_ROWS(unsigned int,srcPtr,srcPitch)
+		unsigned int * dst0 = (unsigned int *)(dstPtr + y0*3*dstpitch);
+		unsigned int * dst1 = (unsigned int *)((unsigned char *)dst0+dstpitch);
 
-			*(unsigned long*)(dstpix + looph*3*dstpitch + loopw*3*4) = E0;
-			*(unsigned long*)(dstpix + looph*3*dstpitch + (loopw*3+1)*4) = E1;
-			*(unsigned long*)(dstpix + looph*3*dstpitch + (loopw*3+2)*4) = E2;
-			*(unsigned long*)(dstpix + (looph*3+1)*dstpitch + loopw*3*4) = E3;
-			*(unsigned long*)(dstpix + (looph*3+1)*dstpitch + (loopw*3+1)*4) = E4;
-			*(unsigned long*)(dstpix + (looph*3+1)*dstpitch + (loopw*3+2)*4) = E5;
-			*(unsigned long*)(dstpix + (looph*3+2)*dstpitch + loopw*3*4) = E6;
-			*(unsigned long*)(dstpix + (looph*3+2)*dstpitch + (loopw*3+1)*4) = E7;
-			*(unsigned long*)(dstpix + (looph*3+2)*dstpitch + (loopw*3+2)*4) = E8;
-		}
+		scale3x_32_def_whole(dst0, dst1, (unsigned int *)((unsigned char *)dst1+dstpitch), src0, src1, src2, width);
 	}
-#endif
 }
 
+SCALE_BANDS(Scale3x_ex8)
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -1410,8 +1524,8 @@ void Scale3x_ex8(unsigned char *srcPtr, DWORD srcPitch,
 #define Q_INTERPOLATE6(A, B, C, D) (((((A & qcolorMask6) >> 2) + ((B & qcolorMask6) >> 2) + ((C & qcolorMask6) >> 2) + ((D & qcolorMask6) >> 2) \
 	+ ((((A & qlowpixelMask6) + (B & qlowpixelMask6) + (C & qlowpixelMask6) + (D & qlowpixelMask6)) >> 2) & qlowpixelMask6))))
 
-void Super2xSaI_ex6(unsigned char *srcPtr, DWORD srcPitch,
-                    unsigned char  *dstBitmap, int width, int height)
+static void Super2xSaI_ex6_band(unsigned char *srcPtr, DWORD srcPitch,
+                                unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	int   finWidth        = srcPitch>>1;
@@ -1427,10 +1541,13 @@ void Super2xSaI_ex6(unsigned char *srcPtr, DWORD srcPitch,
 	DWORD product1a, product1b,
 	product2a, product2b;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (unsigned short *)srcPtr;
 			dP = (unsigned short *)(dstBitmap + line*dstPitch);
@@ -1579,10 +1696,12 @@ void Super2xSaI_ex6(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
+SCALE_BANDS(Super2xSaI_ex6)
+
 ////////////////////////////////////////////////////////////////////////
 
-void Std2xSaI_ex6(unsigned char *srcPtr, DWORD srcPitch,
-                  unsigned char  *dstBitmap, int width, int height)
+static void Std2xSaI_ex6_band(unsigned char *srcPtr, DWORD srcPitch,
+                              unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	int   finWidth        = srcPitch>>1;
@@ -1598,10 +1717,13 @@ void Std2xSaI_ex6(unsigned char *srcPtr, DWORD srcPitch,
 	colorM, colorN, colorO, colorP;
 	DWORD product, product1, product2;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (unsigned short *)srcPtr;
 			dP = (unsigned short *)(dstBitmap + line*dstPitch);
@@ -1803,10 +1925,12 @@ void Std2xSaI_ex6(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
+SCALE_BANDS(Std2xSaI_ex6)
+
 ////////////////////////////////////////////////////////////////////////
 
-void SuperEagle_ex6(unsigned char *srcPtr, DWORD srcPitch,
-                    unsigned char  *dstBitmap, int width, int height)
+static void SuperEagle_ex6_band(unsigned char *srcPtr, DWORD srcPitch,
+                                unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	int   finWidth        = srcPitch>>1;
@@ -1822,10 +1946,13 @@ void SuperEagle_ex6(unsigned char *srcPtr, DWORD srcPitch,
 	DWORD product1a, product1b,
 	product2a, product2b;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (unsigned short *)srcPtr;
 			dP = (unsigned short *)(dstBitmap + line*dstPitch);
@@ -1990,58 +2117,9 @@ void SuperEagle_ex6(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
-////////////////////////////////////////////////////////////////////////
-
-#ifndef MAX
-#define MAX(a,b)    (((a) > (b)) ? (a) : (b))
-#define MIN(a,b)    (((a) < (b)) ? (a) : (b))
-#endif
-
-void Scale2x_ex6_5(unsigned char *srcPtr, DWORD srcPitch,
-                   unsigned char  *dstBitmap, int width, int height)
-{
-	int looph, loopw;
-
-	unsigned char * srcpix = srcPtr;
-	unsigned char * dstpix = dstBitmap;
-
-	const int srcpitch = srcPitch;
-	const int dstpitch = srcPitch<<1;
-
-	unsigned short E0, E1, E2, E3, B, D, E, F, H;
-	for (looph = 0; looph < height; ++looph)
-	{
-		for (loopw = 0; loopw < width; ++ loopw)
-		{
-			B = *(unsigned short*)(srcpix + (MAX(0,looph-1)*srcpitch) + (2*loopw));
-			D = *(unsigned short*)(srcpix + (looph*srcpitch) + (2*MAX(0,loopw-1)));
-			E = *(unsigned short*)(srcpix + (looph*srcpitch) + (2*loopw));
-			F = *(unsigned short*)(srcpix + (looph*srcpitch) + (2*MIN(width-1,loopw+1)));
-			H = *(unsigned short*)(srcpix + (MIN(height-1,looph+1)*srcpitch) + (2*loopw));
-
-			if (B != H && D != F)
-			{
-				E0 = D == B ? D : E;
-				E1 = B == F ? F : E;
-				E2 = D == H ? D : E;
-				E3 = H == F ? F : E;
-			}
-			else
-			{
-				E0 = E;
-				E1 = E;
-				E2 = E;
-				E3 = E;
-			}
-
+SCALE_BANDS(SuperEagle_ex6)
 
-			*(unsigned short*)(dstpix + looph*2*dstpitch + loopw*2*2) = E0;
-			*(unsigned short*)(dstpix + looph*2*dstpitch + (loopw*2+1)*2) = E1;
-			*(unsigned short*)(dstpix + (looph*2+1)*dstpitch + loopw*2*2) = E2;
-			*(unsigned short*)(dstpix + (looph*2+1)*dstpitch + (loopw*2+1)*2) = E3;
-		}
-	}
-}
+////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -2067,8 +2145,8 @@ void Scale2x_ex6_5(unsigned char *srcPtr, DWORD srcPitch,
 #define Q_INTERPOLATE5(A, B, C, D) (((((A & qcolorMask5) >> 2) + ((B & qcolorMask5) >> 2) + ((C & qcolorMask5) >> 2) + ((D & qcolorMask5) >> 2) \
 	+ ((((A & qlowpixelMask5) + (B & qlowpixelMask5) + (C & qlowpixelMask5) + (D & qlowpixelMask5)) >> 2) & qlowpixelMask5))))
 
-void Super2xSaI_ex5(unsigned char *srcPtr, DWORD srcPitch,
-                    unsigned char  *dstBitmap, int width, int height)
+static void Super2xSaI_ex5_band(unsigned char *srcPtr, DWORD srcPitch,
+                                unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	int   finWidth        = srcPitch>>1;
@@ -2084,10 +2162,13 @@ void Super2xSaI_ex5(unsigned char *srcPtr, DWORD srcPitch,
 	DWORD product1a, product1b,
 	product2a, product2b;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (unsigned short *)srcPtr;
 			dP = (unsigned short *)(dstBitmap + line*dstPitch);
@@ -2236,10 +2317,12 @@ void Super2xSaI_ex5(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
+SCALE_BANDS(Super2xSaI_ex5)
+
 ////////////////////////////////////////////////////////////////////////
 
-void Std2xSaI_ex5(unsigned char *srcPtr, DWORD srcPitch,
-                  unsigned char  *dstBitmap, int width, int height)
+static void Std2xSaI_ex5_band(unsigned char *srcPtr, DWORD srcPitch,
+                              unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	int   finWidth        = srcPitch>>1;
@@ -2254,10 +2337,13 @@ void Std2xSaI_ex5(unsigned char *srcPtr, DWORD srcPitch,
 	colorM, colorN, colorO, colorP;
 	DWORD product, product1, product2;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (unsigned short *)srcPtr;
 			dP = (unsigned short *)(dstBitmap + line*dstPitch);
@@ -2459,10 +2545,12 @@ void Std2xSaI_ex5(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
+SCALE_BANDS(Std2xSaI_ex5)
+
 ////////////////////////////////////////////////////////////////////////
 
-void SuperEagle_ex5(unsigned char *srcPtr, DWORD srcPitch,
-                    unsigned char  *dstBitmap, int width, int height)
+static void SuperEagle_ex5_band(unsigned char *srcPtr, DWORD srcPitch,
+                                unsigned char *dstBitmap, int width, int height, int y0, int y1)
 {
 	DWORD dstPitch        = srcPitch<<1;
 	int   finWidth        = srcPitch>>1;
@@ -2478,10 +2566,13 @@ void SuperEagle_ex5(unsigned char *srcPtr, DWORD srcPitch,
 	DWORD product1a, product1b,
 	product2a, product2b;
 
-	line = 0;
+	line = y0<<1;                                        // band: rows y0..y1
+	srcPtr += y0*srcPitch;
+	height -= y0;                                         // rows left, as usual
+	y1 = height-(y1-y0);                                  // rows left at the band end
 
 	{
-		for (; height; height-=1)
+		for (; height>y1; height-=1)
 		{
 			bP = (unsigned short *)srcPtr;
 			dP = (unsigned short *)(dstBitmap + line*dstPitch);
@@ -2646,6 +2737,8 @@ void SuperEagle_ex5(unsigned char *srcPtr, DWORD srcPitch,
 	}
 }
 
+SCALE_BANDS(SuperEagle_ex5)
+
 ////////////////////////////////////////////////////////////////////////
 // Win code starts here
 ////////////////////////////////////////////////////////////////////////
@@ -3902,6 +3995,7 @@ void DoClearScreenBuffer(void)                         // CLEAR DX BUFFER
 	ddbltfx.dwFillColor = 0x00000000;
 
 	IDirectDrawSurface_Blt(DX.DDSRender,NULL,NULL,NULL,DDBLT_COLORFILL,&ddbltfx);
+	BlitFrameDirty();
 
 	if (iUseNoStretchBlt>=3)
 	{
@@ -4556,6 +4650,7 @@ void DoBufferSwap(void)                                // SWAP BUFFERS
 	if (ddrval==DDERR_SURFACELOST)
 	{
 		IDirectDrawSurface_Restore(DX.DDSRender);
+		BlitFrameDirty();
 	}
 
 	if (ddrval!=DD_OK)
@@ -4571,7 +4666,8 @@ void DoBufferSwap(void)                                // SWAP BUFFERS
 
 	//----------------------------------------------------//
 
-	BlitScreen((unsigned char *)ddsd.lpSurface,x,y);      // fill DDSRender surface
+	if (!BlitFrameUnchanged(x,y,BLITOVERLAY))             // else it's still there
+		BlitScreen((unsigned char *)ddsd.lpSurface,x,y);    // fill DDSRender surface
 
 	if(fpPCSX_LuaGui)
 		fpPCSX_LuaGui((void *)ddsd.lpSurface,PreviousPSXDisplay.Range.x1,
@@ -4842,6 +4938,7 @@ int DXinitialize()
 
 	// init some DX vars
 	DX.hWnd = (HWND)hWGPU;
+	BlitFrameDirty();
 	DX.DDSHelper=0;
 	DX.DDSScreenPic=0;
 
@@ -5254,6 +5351,7 @@ unsigned long ulInitDisplay(void)
 
 void CloseDisplay(void)
 {
+	ScaleStopThreads();
 	DXcleanup();                                          // cleanup dx
 
 	SetWindowLong(hWGPU, GWL_STYLE,dwGPUStyle);    // repair window
@@ -5529,6 +5627,28 @@ void ShowTextGpuPic(void)                              // CREATE TEXT SCREEN PIC
 
 #else
 
+#ifdef _HEADLESS
+////////////////////////////////////////////////////////////////////////
+// HEADLESS STUFF: no window, no x server... finished frames get blitted
+// to a host buffer and handed to fpHeadlessFrame, if somebody set it
+////////////////////////////////////////////////////////////////////////
+
+char *        Xpixels=NULL;                            // no screen surface
+char *        pCaptionText;
+
+void (*fpHeadlessFrame)(void *s,int width,int height,int bpp,int pitch)=NULL;
+
+void DestroyDisplay(void)
+{
+}
+
+void CreateDisplay(void)
+{
+	iColDepth=32;                                         // frames are always 32 bit
+}
+
+#else
+
 #ifndef _SDL
 ////////////////////////////////////////////////////////////////////////
 // X STUFF :)
@@ -6144,6 +6264,7 @@ void CreateDisplay(void)
 
 }
 #endif
+#endif //HEADLESS
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -6833,10 +6954,10 @@ void XStretchBlt16(unsigned char * pBB,int sdx,int sdy,int ddx,int ddy)
 	unsigned short * pSrc=(unsigned short *)pBackBuffer;
 	unsigned short * pSrcR=NULL;
 	unsigned short * pDst=(unsigned short *)pBB;
-	unsigned long * pDstR=NULL;
+	unsigned short * pDstR=NULL;
 	int x,y,cyo=-1,cy;
 	int xpos, xinc;
-	int ypos, yinc,ddx2=ddx>>1;
+	int ypos, yinc,ddx2=ddx&~1;
 #ifdef USE_DGA2
 	int DGA2fix;
 	int dga2Fix;
@@ -6882,11 +7003,11 @@ void XStretchBlt16(unsigned char * pBB,int sdx,int sdy,int ddx,int ddy)
 		if (cy==cyo)
 		{
 #ifndef USE_DGA2
-			pDstR=(unsigned long *)(pDst-ddx);
+			pDstR=pDst-ddx;
 #else
-			pDstR=(unsigned long *)(pDst-(ddx+dga2Fix));
+			pDstR=pDst-(ddx+dga2Fix);
 #endif
-			for (x=0;x<ddx2;x++) *((unsigned long*)pDst)++=*pDstR++;
+			for (x=0;x<ddx2;x++) *pDst++=*pDstR++;           // same line again
 		}
 		else
 		{
@@ -7480,6 +7601,52 @@ void ShowGunCursor(unsigned char * surf,int iPitch)
 
 ////////////////////////////////////////////////////////////////////////
 
+#ifdef _HEADLESS
+
+static void HeadlessFrame(void)
+{
+	int iW=PreviousPSXDisplay.Range.x1+PreviousPSXDisplay.Range.x0;
+
+	if (fpPCSX_LuaGui)
+		fpPCSX_LuaGui(pBackBuffer,iW,PreviousPSXDisplay.DisplayMode.y,32,iW<<2);
+
+	fpHeadlessFrame(pBackBuffer,iW,PreviousPSXDisplay.DisplayMode.y,32,iW<<2);
+}
+
+void DoBufferSwap(void)                                // SWAP BUFFERS
+{                                                      // (we don't even blit... if nobody looks)
+	long x=PSXDisplay.DisplayPosition.x;
+	long y=PSXDisplay.DisplayPosition.y;
+
+	if (!fpHeadlessFrame) return;
+
+	if (!BlitFrameUnchanged(x,y,BLITOVERLAY))
+		BlitScreen32(pBackBuffer,x,y);                      // psx size, no stretching
+
+	if (usCursorActive) ShowGunCursor(pBackBuffer,PreviousPSXDisplay.Range.x0+PreviousPSXDisplay.Range.x1);
+
+	HeadlessFrame();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void DoClearScreenBuffer(void)                         // CLEAR DX BUFFER
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void DoClearFrontBuffer(void)                          // CLEAR DX BUFFER
+{
+	if (!fpHeadlessFrame) return;
+
+	memset(pBackBuffer,0,640*512*sizeof(unsigned long));  // a black frame
+	BlitFrameDirty();
+	HeadlessFrame();
+}
+
+#else
+
 #include <time.h>
 extern time_t tStart;
 
@@ -7541,11 +7708,14 @@ void NoStretchSwap(void)
 
 		iOldDX=iDX;
 		iOldDY=iDY;
+		BlitFrameDirty();
 	}
 #ifndef _SDL2
-	BlitScreenNS((unsigned char *)Xpixels,
-	             PSXDisplay.DisplayPosition.x,
-	             PSXDisplay.DisplayPosition.y);
+	if (!BlitFrameUnchanged(PSXDisplay.DisplayPosition.x,
+	                        PSXDisplay.DisplayPosition.y,BLITOVERLAY))
+		BlitScreenNS((unsigned char *)Xpixels,
+		             PSXDisplay.DisplayPosition.x,
+		             PSXDisplay.DisplayPosition.y);
 
 	if (usCursorActive) ShowGunCursor((unsigned char *)Xpixels,iResX);
 
@@ -7661,18 +7831,22 @@ void DoBufferSwap(void)                                // SWAP BUFFERS
 	}
 
 #ifndef _SDL2
-	BlitScreen(pBackBuffer,
-	           PSXDisplay.DisplayPosition.x,
-	           PSXDisplay.DisplayPosition.y);
+	if (!BlitFrameUnchanged(PSXDisplay.DisplayPosition.x,  // else Xpixels still has it
+	                        PSXDisplay.DisplayPosition.y,BLITOVERLAY))
+	{
+		BlitScreen(pBackBuffer,
+		           PSXDisplay.DisplayPosition.x,
+		           PSXDisplay.DisplayPosition.y);
 
-	if (usCursorActive) ShowGunCursor(pBackBuffer,PreviousPSXDisplay.Range.x0+PreviousPSXDisplay.Range.x1);
+		if (usCursorActive) ShowGunCursor(pBackBuffer,PreviousPSXDisplay.Range.x0+PreviousPSXDisplay.Range.x1);
 
-	//----------------------------------------------------//
+		//----------------------------------------------------//
 
-	XStretchBlt((unsigned char *)Xpixels,
-	            PreviousPSXDisplay.Range.x1+PreviousPSXDisplay.Range.x0,
-	            PreviousPSXDisplay.DisplayMode.y,
-	            iResX,iResY);
+		XStretchBlt((unsigned char *)Xpixels,
+		            PreviousPSXDisplay.Range.x1+PreviousPSXDisplay.Range.x0,
+		            PreviousPSXDisplay.DisplayMode.y,
+		            iResX,iResY);
+	}
 
 	//----------------------------------------------------//
 #else
@@ -7797,11 +7971,14 @@ void DoClearFrontBuffer(void)                          // CLEAR DX BUFFER
 #endif
 }
 
+#endif //HEADLESS
 
 ////////////////////////////////////////////////////////////////////////
 
 int Xinitialize()
 {
+	BlitFrameDirty();                                     // fresh buffers
+
 #ifndef _SDL2
 
 	pBackBuffer=(unsigned char *)malloc(640*512*sizeof(unsigned long));
@@ -7954,6 +8131,36 @@ void Xcleanup()                                        // X CLEANUP
 
 ////////////////////////////////////////////////////////////////////////
 
+#ifdef _HEADLESS
+
+unsigned long ulInitDisplay(void)
+{
+	CreateDisplay();
+	Xinitialize();
+	return 1;                                             // no display, but fine
+}
+
+void CloseDisplay(void)
+{
+	ScaleStopThreads();
+	Xcleanup();
+	DestroyDisplay();
+}
+
+void CreatePic(unsigned char * pMem)
+{
+}
+
+void DestroyPic(void)
+{
+}
+
+void DisplayPic(void)
+{
+}
+
+#else
+
 unsigned long ulInitDisplay(void)
 {
 	CreateDisplay();                                      // x stuff
@@ -7965,6 +8172,7 @@ unsigned long ulInitDisplay(void)
 
 void CloseDisplay(void)
 {
+	ScaleStopThreads();
 	Xcleanup();                                           // cleanup dx
 	DestroyDisplay();
 }
@@ -8102,6 +8310,8 @@ void DisplayPic(void)
 #endif
 }
 
+#endif //HEADLESS
+
 ///////////////////////////////////////////////////////////////////////////////////////
 
 void ShowGpuPic(void)
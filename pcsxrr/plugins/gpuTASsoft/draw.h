@@ -37,11 +37,28 @@ void          DestroyPic(void);
 void          DisplayPic(void);
 void          ShowGpuPic(void);
 void          ShowTextGpuPic(void);
+void          BlitFrameDirty(void);
+BOOL          BlitFrameUnchanged(long x,long y,BOOL bOverlay);
+
+typedef void (*ScaleBandFunc)(unsigned char *,DWORD,unsigned char *,int,int,int,int);
+void          ScaleBands(ScaleBandFunc func,unsigned char * src,DWORD pitch,
+                         unsigned char * dst,int width,int height);
+void          ScaleStopThreads(void);
+
+// hq filters (hqx.c), banded like the others
+void          hq2x_16(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height);
+void          hq3x_16(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height);
+void          hq2x_32(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height);
+void          hq3x_32(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height);
 
 #ifdef _WINDOWS
 void          MoveScanLineArea(HWND hwnd);
 #endif
 
+#ifdef _HEADLESS
+extern void   (*fpHeadlessFrame)(void *s,int width,int height,int bpp,int pitch);
+#endif
+
 ///////////////////////////////////////////////////////////////////////
 
 #endif // _GPU_DRAW_H_
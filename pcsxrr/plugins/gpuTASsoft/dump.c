@@ -0,0 +1,155 @@
+/***************************************************************************
+                          dump.c  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+//*************************************************************************//
+// History of changes:
+//
+// 2026/10/19
+// - gpu call recorder: the gpu state at the start plus every gp0/gp1
+//   write, vram read and vsync, for replaying scenes in gpubench
+//
+//*************************************************************************//
+
+#include "stdafx.h"
+
+#include <stddef.h>
+
+#include "externals.h"
+#include "gpu.h"
+#include "dump.h"
+
+////////////////////////////////////////////////////////////////////////
+
+BOOL                bGPUDump=FALSE;                    // checked before each dump call
+static FILE *       fDump=NULL;
+static long         lDumpFrames=0;                     // frames to dump, 0: till stopped
+static unsigned int ulDumpFrame=0;
+static unsigned int dumpBuf[4096];                     // gp0 words, 32 bit on all hosts
+
+static void DumpTag(unsigned int type,unsigned int count)
+{
+	unsigned int t=DUMP_TAG(type,count);
+	fwrite(&t,sizeof(t),1,fDump);
+}
+
+////////////////////////////////////////////////////////////////////////
+// start: the header with the current gpu state (like a freeze)
+
+BOOL DumpStart(char * pFile,long lFrames)
+{
+	DumpHeader_t h;
+	GPUFreeze_t * pF;
+	int i;
+
+	DumpStop();
+
+	pF=(GPUFreeze_t *)malloc(sizeof(GPUFreeze_t));
+	if (!pF) return FALSE;
+
+	pF->ulFreezeVersion=1;
+	pF->extraData=NULL;
+	pF->extraDataSize=0;
+	GPUfreezeEx(1,pF);                                    // just gets the extra size
+	pF->extraData=malloc(pF->extraDataSize);
+
+	if (pF->extraData && GPUfreezeEx(1,pF))
+		fDump=fopen(pFile,"wb");
+
+	if (fDump)
+	{
+		setvbuf(fDump,NULL,_IOFBF,1024*1024);
+
+		memset(&h,0,sizeof(h));
+		memcpy(h.szMagic,DUMP_MAGIC,sizeof(DUMP_MAGIC));
+		h.ulVersion=DUMP_VERSION;
+		h.ulVRamHeight=iGPUHeight;
+		h.ulExtraSize=pF->extraDataSize;
+		h.ulStatus=pF->ulStatus;
+		for (i=0;i<256;i++) h.ulControl[i]=pF->ulControl[i];
+
+		fwrite(&h,sizeof(h),1,fDump);
+		fwrite(pF->psxVRam,1024*2,iGPUHeight,fDump);
+		fwrite(pF->extraData,pF->extraDataSize,1,fDump);
+	}
+
+	free(pF->extraData);
+	free(pF);
+
+	if (!fDump) return FALSE;
+
+	lDumpFrames=lFrames;
+	ulDumpFrame=0;
+	bGPUDump=TRUE;
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void DumpStop(void)
+{
+	if (!fDump) return;
+
+	DumpTag(DUMP_END,0);
+
+	fseek(fDump,offsetof(DumpHeader_t,ulFrames),SEEK_SET); // now we know the frames
+	fwrite(&ulDumpFrame,sizeof(ulDumpFrame),1,fDump);
+
+	fclose(fDump);
+	fDump=NULL;
+	bGPUDump=FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////
+// the gpu calls
+
+void DumpWriteData(unsigned long * pMem,int iSize)
+{
+	int i,n;
+
+	while (iSize>0)
+	{
+		n=(iSize>4096)?4096:iSize;
+		for (i=0;i<n;i++) dumpBuf[i]=(unsigned int)pMem[i];
+
+		DumpTag(DUMP_DATA,n);
+		fwrite(dumpBuf,sizeof(unsigned int),n,fDump);
+
+		pMem+=n;
+		iSize-=n;
+	}
+}
+
+void DumpWriteStatus(unsigned long gdata)
+{
+	unsigned int l=(unsigned int)gdata;
+
+	DumpTag(DUMP_STATUS,0);
+	fwrite(&l,sizeof(l),1,fDump);
+}
+
+void DumpReadData(int iSize)
+{
+	if (iSize>0) DumpTag(DUMP_READ,iSize);
+}
+
+void DumpVSync(void)
+{
+	DumpTag(DUMP_VSYNC,0);
+
+	ulDumpFrame++;
+	if (lDumpFrames && ulDumpFrame>=(unsigned int)lDumpFrames)
+		DumpStop();
+}
@@ -0,0 +1,58 @@
+/***************************************************************************
+                          dump.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef _GPU_DUMP_H_
+#define _GPU_DUMP_H_
+
+////////////////////////////////////////////////////////////////////////
+// gpu dump file: the header, the vram (1024*ulVRamHeight shorts), the
+// freeze extra data (ulExtraSize bytes), then the tagged gpu calls...
+// one 32 bit tag each, type<<24 | count, all in host byte order
+
+#define DUMP_MAGIC    "PGPUDMP"
+#define DUMP_VERSION  1
+
+#define DUMP_END      0                                // end of dump
+#define DUMP_DATA     1                                // count gp0 words follow
+#define DUMP_STATUS   2                                // one gp1 word follows
+#define DUMP_READ     3                                // count gp0 words got read
+#define DUMP_VSYNC    4                                // updateLace: frame done
+
+#define DUMP_TAG(type,count) (((type)<<24)|(count))
+#define DUMP_TYPE(tag)       ((tag)>>24)
+#define DUMP_COUNT(tag)      ((tag)&0xffffff)
+
+typedef struct DUMPHEADERTAG
+{
+	char           szMagic[8];
+	unsigned int   ulVersion;
+	unsigned int   ulVRamHeight;
+	unsigned int   ulExtraSize;                          // sizeof FreezeExtra of the dumping build
+	unsigned int   ulFrames;                             // vsyncs in the dump
+	unsigned int   ulStatus;
+	unsigned int   ulControl[256];
+} DumpHeader_t;
+
+extern BOOL bGPUDump;
+
+BOOL DumpStart(char * pFile,long lFrames);
+void DumpStop(void);
+void DumpWriteData(unsigned long * pMem,int iSize);
+void DumpWriteStatus(unsigned long gdata);
+void DumpReadData(int iSize);
+void DumpVSync(void);
+
+#endif // _GPU_DUMP_H_
@@ -58,6 +58,19 @@
 #define DR_NORMAL        0
 #define DR_VRAMTRANSFER  1
 
+// drawing state is per thread, so several gpu threads can rasterize at once.
+// __declspec(thread) in a dll loaded with LoadLibrary needs Vista or later,
+// XP never sets the tls block up and the first draw faults. GPUinit refuses
+// to run there... an XP build defines GPU_NO_TLS and draws on the emu thread.
+
+#if defined(GPU_NO_TLS)
+#define GPU_TLS
+#elif defined(_MSC_VER)
+#define GPU_TLS __declspec(thread)
+#else
+#define GPU_TLS __thread
+#endif
+
 
 #define GPUSTATUS_ODDLINES            0x80000000
 #define GPUSTATUS_DMABITS             0x60000000 // Two bits
@@ -206,20 +219,20 @@ extern char *         pCaptionText;
 
 extern int            iResX;
 extern int            iResY;
-extern long           GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP;
-extern long           GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
-extern short          ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;
-extern long           lLowerpart;
+extern GPU_TLS long   GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP;
+extern GPU_TLS long   GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
+extern GPU_TLS short  ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;
+extern GPU_TLS long   lLowerpart;
 extern BOOL           bIsFirstFrame;
 extern int            iWinSize;
-extern BOOL           bCheckMask;
-extern unsigned short sSetMask;
-extern unsigned long  lSetMask;
+extern GPU_TLS BOOL   bCheckMask;
+extern GPU_TLS unsigned short sSetMask;
+extern GPU_TLS unsigned long  lSetMask;
 extern BOOL           bDeviceOK;
-extern short          g_m1;
-extern short          g_m2;
-extern short          g_m3;
-extern short          DrawSemiTrans;
+extern GPU_TLS short  g_m1;
+extern GPU_TLS short  g_m2;
+extern GPU_TLS short  g_m3;
+extern GPU_TLS short  DrawSemiTrans;
 extern int            iUseGammaVal;
 extern int            iUseScanLines;
 extern int            iDesktopCol;
@@ -242,23 +255,23 @@ extern int            iFPSEInterface;
 
 #ifndef _IN_PRIMDRAW
 
-extern BOOL           bUsingTWin;
-extern TWin_t         TWin;
-extern unsigned long  clutid;
+extern GPU_TLS BOOL   bUsingTWin;
+extern GPU_TLS TWin_t TWin;
+extern GPU_TLS unsigned long  clutid;
 extern void (*primTableJ[256])(unsigned char *);
 extern void (*primTableSkip[256])(unsigned char *);
-extern unsigned short  usMirror;
-extern int            iDither;
+extern GPU_TLS unsigned short usMirror;
+extern GPU_TLS int    iDither;
 extern unsigned long  dwCfgFixes;
 extern unsigned long  dwActFixes;
 extern unsigned long  dwEmuFixes;
 extern int            iUseFixes;
 extern int            iUseDither;
 extern BOOL           bDoVSyncUpdate;
-extern long           drawX;
-extern long           drawY;
-extern long           drawW;
-extern long           drawH;
+extern GPU_TLS long   drawX;
+extern GPU_TLS long   drawY;
+extern GPU_TLS long   drawW;
+extern GPU_TLS long   drawH;
 
 #endif
 
@@ -281,6 +294,7 @@ extern BOOL           bDebugText;
 //extern unsigned long  dwDMAChainStop;
 extern PSXDisplay_t   PSXDisplay;
 extern PSXDisplay_t   PreviousPSXDisplay;
+extern GPU_TLS PSXSPoint_t DrawOffset;
 extern BOOL           bSkipNextFrame;
 extern long           lGPUstatusRet;
 extern long           drawingLines;
@@ -298,6 +312,7 @@ extern DWORD          dwLaceCnt;
 extern unsigned long  lGPUInfoVals[];
 extern unsigned long  ulStatusControl[];
 extern int            iRumbleVal;
+extern int            iGPUThread;
 extern int            iRumbleTime;
 
 #endif
@@ -370,7 +385,7 @@ extern char * pConfigFile;
 extern unsigned long dwGPUVersion;
 extern int           iGPUHeight;
 extern int           iGPUHeightMask;
-extern int           GlobalTextIL;
+extern GPU_TLS int   GlobalTextIL;
 extern int           iTileCheat;
 
 #endif
@@ -136,10 +136,14 @@
 #include "draw.h"
 #include "cfg.h"
 #include "prim.h"
+#include "soft.h"
 #include "psemu.h"
 #include "menu.h"
 #include "key.h"
 #include "fps.h"
+#include "dump.h"
+#include "vdump.h"
+#include "../../emuthread.h"
 
 //#define SMALLDEBUG
 //#include <dbgout.h>
@@ -148,10 +152,10 @@
 unsigned long dwGPUVersion;
 int           iGPUHeight;
 int           iGPUHeightMask;
-int           GlobalTextIL;
 int           iTileCheat;
 
 void (*fpPCSX_LuaGui)(void *s, int width, int height, int bpp, int pitch);
+void (*fpGPUprimHook)(unsigned char command,unsigned long * gpuData,BOOL bDone)=NULL;
 int iMaximumSpeed=0;
 
 ////////////////////////////////////////////////////////////////////////
@@ -165,6 +169,10 @@ const  unsigned char build    = 2;   // increase that with each version
 #ifdef _WINDOWS
 static char *libraryName      = "TAS Soft Graphics Plugin";
 #else
+#ifdef _HEADLESS
+static char *libraryName      = "P.E.Op.S. SoftNull Driver";
+static char *libraryInfo      = "P.E.Op.S. SoftNull Driver V1.18\nCoded by Pete Bernert and the P.E.Op.S. team\n";
+#else
 #ifndef _SDL
 static char *libraryName      = "P.E.Op.S. SoftX Driver";
 static char *libraryInfo      = "P.E.Op.S. SoftX Driver V1.18\nCoded by Pete Bernert and the P.E.Op.S. team\n";
@@ -173,6 +181,7 @@ static char *libraryName      = "P.E.Op.S. SoftSDL Driver";
 static char *libraryInfo      = "P.E.Op.S. SoftSDL Driver V1.18\nCoded by Pete Bernert and the P.E.Op.S. team\n";
 #endif
 #endif
+#endif
 
 static char *PluginAuthor     = "Pete Bernert and the P.E.Op.S. team";
 
@@ -225,11 +234,13 @@ int               iWindowMode;
 short             sDispWidths[8] = {256,320,512,640,368,384,512,640};
 PSXDisplay_t      PSXDisplay; //!
 PSXDisplay_t      PreviousPSXDisplay; //!
+GPU_TLS PSXSPoint_t DrawOffset; //!
 long              lSelectedSlot=0;
 BOOL              bChangeWinMode=FALSE;
 BOOL              bDoLazyUpdate=FALSE;
 unsigned long     lGPUInfoVals[16]; //!
 int               iFakePrimBusy=0;
+int               iGPUThread=0;
 int               iRumbleVal=0;
 int               iRumbleTime=0;
 
@@ -446,9 +457,15 @@ void DoTextSnapShot(int iNum)
 
 void CALLBACK GPUmakeSnapshot(void)
 {
+#ifdef _WINDOWS
 	makeNormalSnapshotPNG();
+#else
+	makeVramSnapshot();                                   // no png/bmp headers here
+#endif
 }
 
+#ifdef _WINDOWS
+
 void makeNormalSnapshotPNG(void)                    // snapshot of current screen
 {
 	static unsigned short *srcs,*src,cs;
@@ -463,6 +480,8 @@ void makeNormalSnapshotPNG(void)                    // snapshot of current scree
 	png_structp png_ptr;
 	png_infop info_ptr;
 
+	GPUsync();                                            // let the gpu thread finish drawing
+
 	BMP_INFO.biWidth = PSXDisplay.DisplayMode.x;
 	BMP_INFO.biHeight = PSXDisplay.DisplayMode.y;
 	BMP_INFO.biBitCount = 16;
@@ -610,6 +629,8 @@ void makeNormalSnapshotBMP(void)                    // snapshot of current scree
 	unsigned long snapshotnr = 0;
 	long size;
 
+	GPUsync();                                            // let the gpu thread finish drawing
+
 	BMP_INFO.biWidth = PSXDisplay.DisplayMode.x;
 	BMP_INFO.biHeight = PSXDisplay.DisplayMode.y;
 	BMP_INFO.biBitCount = 24;
@@ -734,6 +755,8 @@ void makeNormalSnapshotBMP(void)                    // snapshot of current scree
 	GPUdisplayText(sendThisText);
 }
 
+#endif
+
 void makeVramSnapshot(void)                    // snapshot of current screen
 {
 	char sendThisText[50];
@@ -746,6 +769,9 @@ void makeVramSnapshot(void)                    // snapshot of current screen
 	unsigned char empty[2]={0,0};
 	unsigned short color;
 	unsigned long snapshotnr = 0;
+
+	GPUsync();                                            // let the gpu thread finish drawing
+
 	start_x = PSXDisplay.DisplayPosition.x;
 	start_y = PSXDisplay.DisplayPosition.y;
 	width=PSXDisplay.DisplayMode.x;
@@ -828,6 +854,8 @@ void makeFullVramSnapshot(void)                    // snapshot of whole vram
 	unsigned short color;
 	unsigned long snapshotnr = 0;
 
+	GPUsync();                                            // let the gpu thread finish drawing
+
 	height=iGPUHeight;
 
 	size=height*1024*3+0x38;
@@ -898,6 +926,14 @@ void makeFullVramSnapshot(void)                    // snapshot of whole vram
 
 long CALLBACK GPUinit()                                // GPU INIT
 {
+#if defined(_WINDOWS) && !defined(GPU_NO_TLS)
+	if (LOBYTE(LOWORD(GetVersion()))<6)                   // implicit tls: see externals.h
+	{
+		MessageBox(NULL,"This GPU needs Windows Vista or later!\nOn XP use a build with GPU_NO_TLS.","Error",MB_OK|MB_ICONSTOP);
+		return -1;
+	}
+#endif
+
 	memset(ulStatusControl,0,256*sizeof(unsigned long));  // init save state scontrol field
 
 	szDebugText[0]=0;                                     // init debug text buffer
@@ -923,8 +959,8 @@ long CALLBACK GPUinit()                                // GPU INIT
 
 	PSXDisplay.RGB24        = FALSE;                      // init some stuff
 	PSXDisplay.Interlaced   = FALSE;
-	PSXDisplay.DrawOffset.x = 0;
-	PSXDisplay.DrawOffset.y = 0;
+	DrawOffset.x            = 0;
+	DrawOffset.y            = 0;
 	PSXDisplay.DisplayMode.x= 320;
 	PSXDisplay.DisplayMode.y= 240;
 	PreviousPSXDisplay.DisplayMode.x= 320;
@@ -982,6 +1018,7 @@ long CALLBACK GPUopen(HWND hwndGPU)                    // GPU OPEN
 	if (iStopSaver)
 		D_SetThreadExecutionState(ES_SYSTEM_REQUIRED|ES_DISPLAY_REQUIRED|ES_CONTINUOUS);
 
+	GPUstartThread();                                     // optional drawing thread
 
 	return 0;
 }
@@ -1009,8 +1046,11 @@ long GPUopen(unsigned long * disp,char * CapText,char * CfgFile)
 
 	if (disp) *disp=d;                                    // wanna x pointer? ok
 
-	if (d) return 0;
-	return -1;
+	if (!d) return -1;
+
+	GPUstartThread();                                     // optional drawing thread
+
+	return 0;
 }
 
 #endif
@@ -1021,6 +1061,12 @@ long GPUopen(unsigned long * disp,char * CapText,char * CfgFile)
 
 long CALLBACK GPUclose()                               // GPU CLOSE
 {
+	DumpStop();
+
+	GPUstopThread();                                      // finish queued prims first
+
+	VDUMP_Stop();
+
 #ifdef _WINDOWS
 	if (RECORD_RECORDING==TRUE)
 	{
@@ -1052,6 +1098,7 @@ long CALLBACK GPUshutdown()                            // GPU SHUTDOWN
 	FreeKernel32();
 
 	free(psxVSecure);
+	TexCacheFree();
 
 	return 0;                                             // nothinh to do
 }
@@ -1060,8 +1107,16 @@ long CALLBACK GPUshutdown()                            // GPU SHUTDOWN
 // Update display (swap buffers)
 ////////////////////////////////////////////////////////////////////////
 
+static void ShowBuffer(void)
+{
+	GPUskipShow();                                        // skipped prims in there get drawn
+	DoBufferSwap();
+}
+
 void updateDisplay(void)                               // UPDATE DISPLAY
 {
+	GPUsyncThreads();                                     // frame must be complete
+
 	if (PSXDisplay.Disabled)                              // disable?
 	{
 		DoClearFrontBuffer();                               // -> clear frontbuffer
@@ -1087,7 +1142,7 @@ void updateDisplay(void)                               // UPDATE DISPLAY
 		if (iMaximumSpeed)
 			bSkipNextFrame=1;
 
-		if (!bSkipNextFrame) DoBufferSwap();                // -> to skip or not to skip
+		if (!bSkipNextFrame) ShowBuffer();                  // -> to skip or not to skip
 		if (fpscount%6 || iMaximumSpeed)                    // -> skip 6/7 frames
 			bSkipNextFrame = TRUE;
 		else bSkipNextFrame = FALSE;
@@ -1098,7 +1153,7 @@ void updateDisplay(void)                               // UPDATE DISPLAY
 
 	if (UseFrameSkip)                                     // skip ?
 	{
-		if (!bSkipNextFrame) DoBufferSwap();                // -> to skip or not to skip
+		if (!bSkipNextFrame) ShowBuffer();                  // -> to skip or not to skip
 		if (dwActFixes&0xa0)                                // -> pc fps calculation fix/old skipping fix
 		{
 			if ((fps_skip < fFrameRateHz) && !(bSkipNextFrame)) // -> skip max one in a row
@@ -1112,7 +1167,7 @@ void updateDisplay(void)                               // UPDATE DISPLAY
 	}
 	else                                                  // no skip ?
 	{
-		DoBufferSwap();                                     // -> swap
+		ShowBuffer();                                       // -> swap
 	}
 }
 
@@ -1316,6 +1371,10 @@ void CALLBACK GPUcursor(int iPlayer,int x,int y)
 
 void CALLBACK GPUupdateLace(void)                      // VSYNC
 {
+	if (bGPUDump) DumpVSync();
+
+	GPUsyncThreads();                                     // vram must be complete for display/recording
+
 	if (!(dwActFixes&1))
 		lGPUstatusRet^=0x80000000;                           // odd/even bit
 
@@ -1347,14 +1406,27 @@ void CALLBACK GPUupdateLace(void)                      // VSYNC
 //				}
 //		}
 
+	if (bVDump && !bVDumpAudio)                           // avi dumps get their frames from the core
+	{
+		GPUskipShow();                                      // the dumped frame too
+		if (VDUMP_WriteFrame(0,0,NULL,0)==FALSE)
+		{
+			VDUMP_Stop();
+			BuildDispMenu(0);
+		}
+	}
+
 #ifdef _WINDOWS
 
 	if (RECORD_RECORDING)
+	{
+		GPUskipShow();                                      // the recorded frame too
 		if (RECORD_WriteFrame()==FALSE)
 		{
 			RECORD_RECORDING=FALSE;
 			RECORD_Stop();
 		}
+	}
 
 	if (bChangeWinMode) ChangeWindowMode();               // toggle full - window mode
 
@@ -1410,6 +1482,8 @@ void CALLBACK GPUwriteStatus(unsigned long gdata)      // WRITE STATUS
 {
 	unsigned long lCommand=(gdata>>24)&0xff;
 
+	if (bGPUDump) DumpWriteStatus(gdata);
+
 	ulStatusControl[lCommand]=gdata;                      // store command for freezing
 
 	switch (lCommand)
@@ -1417,11 +1491,12 @@ void CALLBACK GPUwriteStatus(unsigned long gdata)      // WRITE STATUS
 		//--------------------------------------------------//
 		// reset gpu
 	case 0x00:
+		GPUsync();                                          // drawing state gets reset below
 		memset(lGPUInfoVals,0x00,16*sizeof(unsigned long));
 		lGPUstatusRet=0x14802000;
 		PSXDisplay.Disabled=1;
 		DataWriteMode=DataReadMode=DR_NORMAL;
-		PSXDisplay.DrawOffset.x=PSXDisplay.DrawOffset.y=0;
+		DrawOffset.x=DrawOffset.y=0;
 		drawX=drawY=0;
 		drawW=drawH=0;
 		sSetMask=0;
@@ -1435,6 +1510,7 @@ void CALLBACK GPUwriteStatus(unsigned long gdata)      // WRITE STATUS
 		PSXDisplay.RGB24=FALSE;
 		PSXDisplay.Interlaced=FALSE;
 		bUsingTWin = FALSE;
+		GPUimportDrawState();                               // gpu threads get the reset state too
 		return;
 		//--------------------------------------------------//
 		// dis/enable display
@@ -1707,6 +1783,10 @@ void CALLBACK GPUreadDataMem(unsigned long * pMem, int iSize)
 
 	if (DataReadMode!=DR_VRAMTRANSFER) return;
 
+	if (bGPUDump) DumpReadData(iSize);
+
+	GPUsyncThreads();                                     // queued prims may still touch the read area
+
 	GPUIsBusy;
 
 	// adjust read ptr, if necessary
@@ -1858,248 +1938,1265 @@ const unsigned char primTableCX[256] =
 	0,0,0,0,0,0,0,0
 };
 
-void CALLBACK GPUwriteDataMem(unsigned long * pMem, int iSize)
+////////////////////////////////////////////////////////////////////////
+// optional gpu threads: finished packets go through a single producer/
+// multi consumer ring, and every worker walks all of them in order, so
+// each one keeps its own (thread local) drawing state up to date. The
+// pixels of a drawing prim are done by one owner thread only, the others
+// just run it against an empty draw area. Ownership is spread over 64x64
+// vram tiles, and an owner first waits until the prims which touched the
+// same tiles before (drawn to or used as texture/clut) are done by the
+// other threads... so every vram pixel still sees the prims in psx order.
+// The emu thread replays the prims the same way to keep its own copy of
+// the drawing state (used for the tile rects and for freezes).
+// Everything the emu side can see from vram (reads, display, freezes)
+// calls GPUsync() first... or GPUsyncThreads(), if skipped prims in
+// vram (see lazy frame skipping below) got checked already
+////////////////////////////////////////////////////////////////////////
+
+#define GPU_RING_SIZE   0x10000                        // in words, power of 2
+#define GPU_RING_MASK   (GPU_RING_SIZE-1)
+#define GPU_MAX_THREADS 8
+
+#define GPU_TILE_SHIFT  6                              // 64x64 tiles
+#define GPU_TILE_COLS   (1024>>GPU_TILE_SHIFT)
+#define GPU_TILES       (GPU_TILE_COLS*(1024>>GPU_TILE_SHIFT))
+
+#define GPU_PKT_PRIM    0                              // packet: [len|kind<<16|owner<<24][seq][need 0..n-1][data]
+#define GPU_PKT_IMPORT  1
+#define GPU_OWNER_ALL   0xff
+#define GPU_OWNER_NONE  0xfe
+
+typedef struct GPUDRAWSTATETAG
 {
-	unsigned char command;
-	unsigned long gdata=0;
-	int i=0;
+	long           lLowerpart;
+	BOOL           bCheckMask;
+	unsigned short sSetMask;
+	unsigned long  lSetMask;
+	BOOL           bUsingTWin;
+	TWin_t         TWin;
+	unsigned long  clutid;
+	unsigned short usMirror;
+	int            iDither;
+	long           drawX,drawY,drawW,drawH;
+	PSXSPoint_t    DrawOffset;
+	short          g_m1,g_m2,g_m3;
+	short          DrawSemiTrans;
+	short          ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;
+	long           GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP;
+	long           GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
+	int            GlobalTextIL;
+} GPUDrawState_t;
+
+static unsigned long          gpuRing[GPU_RING_SIZE];
+static volatile unsigned long gpuRingHead=0;           // written by emu thread only
+static volatile unsigned long gpuRingTail[GPU_MAX_THREADS];  // each written by its gpu thread only
+static volatile unsigned long gpuThreadSeq[GPU_MAX_THREADS]; // last packet done by each gpu thread
+static volatile long          gpuThreadIdle[GPU_MAX_THREADS];
+static volatile long          gpuThreadWaitFor[GPU_MAX_THREADS]; // 1+thread it waits for, 0: none
+static volatile long          gpuEmuWaiting=0;
+static volatile BOOL          bGPUThreadQuit=FALSE;
+static BOOL                   bGPUThread=FALSE;
+static int                    iGPUThreads=0;           // running gpu threads
+static int                    gpuThreadNum[GPU_MAX_THREADS];
+static emuThread              gpuThread[GPU_MAX_THREADS];
+static emuEvent               gpuWakeEvent[GPU_MAX_THREADS]; // emu -> gpu: new packets
+static emuEvent               gpuSeqEvent[GPU_MAX_THREADS];  // gpu -> gpu: waited for packet done
+static emuEvent               gpuDoneEvent;            // gpu -> emu: ring drained
+static unsigned long          gpuSeq=0;                // packet counter, 0 means "none"
+static unsigned long          gpuTileSeq[GPU_TILES];   // last packet touching a tile
+static unsigned char          gpuTileOwner[GPU_TILES]; // and the thread drawing it
+static GPUDrawState_t         gpuDrawState;            // for GPU_PKT_IMPORT
+
+static void GPUsaveDrawState(GPUDrawState_t * s)
+{
+	s->lLowerpart=lLowerpart;
+	s->bCheckMask=bCheckMask;
+	s->sSetMask=sSetMask;
+	s->lSetMask=lSetMask;
+	s->bUsingTWin=bUsingTWin;
+	s->TWin=TWin;
+	s->clutid=clutid;
+	s->usMirror=usMirror;
+	s->iDither=iDither;
+	s->drawX=drawX;
+	s->drawY=drawY;
+	s->drawW=drawW;
+	s->drawH=drawH;
+	s->DrawOffset=DrawOffset;
+	s->g_m1=g_m1;
+	s->g_m2=g_m2;
+	s->g_m3=g_m3;
+	s->DrawSemiTrans=DrawSemiTrans;
+	s->ly0=ly0; s->lx0=lx0; s->ly1=ly1; s->lx1=lx1;
+	s->ly2=ly2; s->lx2=lx2; s->ly3=ly3; s->lx3=lx3;
+	s->GlobalTextAddrX=GlobalTextAddrX;
+	s->GlobalTextAddrY=GlobalTextAddrY;
+	s->GlobalTextTP=GlobalTextTP;
+	s->GlobalTextREST=GlobalTextREST;
+	s->GlobalTextABR=GlobalTextABR;
+	s->GlobalTextPAGE=GlobalTextPAGE;
+	s->GlobalTextIL=GlobalTextIL;
+}
 
-	GPUIsBusy;
-	GPUIsNotReadyForCommands;
+static void GPUloadDrawState(GPUDrawState_t * s)
+{
+	lLowerpart=s->lLowerpart;
+	bCheckMask=s->bCheckMask;
+	sSetMask=s->sSetMask;
+	lSetMask=s->lSetMask;
+	bUsingTWin=s->bUsingTWin;
+	TWin=s->TWin;
+	clutid=s->clutid;
+	usMirror=s->usMirror;
+	iDither=s->iDither;
+	drawX=s->drawX;
+	drawY=s->drawY;
+	drawW=s->drawW;
+	drawH=s->drawH;
+	DrawOffset=s->DrawOffset;
+	g_m1=s->g_m1;
+	g_m2=s->g_m2;
+	g_m3=s->g_m3;
+	DrawSemiTrans=s->DrawSemiTrans;
+	ly0=s->ly0; lx0=s->lx0; ly1=s->ly1; lx1=s->lx1;
+	ly2=s->ly2; lx2=s->lx2; ly3=s->ly3; lx3=s->lx3;
+	GlobalTextAddrX=s->GlobalTextAddrX;
+	GlobalTextAddrY=s->GlobalTextAddrY;
+	GlobalTextTP=s->GlobalTextTP;
+	GlobalTextREST=s->GlobalTextREST;
+	GlobalTextABR=s->GlobalTextABR;
+	GlobalTextPAGE=s->GlobalTextPAGE;
+	GlobalTextIL=s->GlobalTextIL;
+}
 
-STARTVRAM:
+////////////////////////////////////////////////////////////////////////
+// run a prim for its drawing state only
 
-	if (DataWriteMode==DR_VRAMTRANSFER)
+static void GPUskipPrim(unsigned char command,unsigned char * baseAddr)
+{
+	long x,y,w,h;
+
+	if (command==0x02 || command==0x80) return;           // pure vram work, no state
+
+	if (command<0x20 || command>=0x80)                    // state cmds: just do them
 	{
-		BOOL bFinished=FALSE;
+		primTableJ[command](baseAddr);
+		return;
+	}
 
-		// make sure we are in vram
-		while (VRAMWrite.ImagePtr>=psxVuw_eom)
-			VRAMWrite.ImagePtr-=iGPUHeight*1024;
-		while (VRAMWrite.ImagePtr<psxVuw)
-			VRAMWrite.ImagePtr+=iGPUHeight*1024;
+	x=drawX;y=drawY;w=drawW;h=drawH;
 
-		// now do the loop
-		while (VRAMWrite.ColsRemaining>0)
-		{
-			while (VRAMWrite.RowsRemaining>0)
-			{
-				if (i>=iSize)
-				{
-					goto ENDVRAM;
-				}
-				i++;
+	drawX=drawY=2048;                                     // empty draw area: all the
+	drawW=drawH=-2048;                                    // soft.c funcs bail out early
+	primTableJ[command](baseAddr);
 
-				gdata=*pMem++;
+	drawX=x;drawY=y;drawW=w;drawH=h;
+}
 
-				*VRAMWrite.ImagePtr++ = (unsigned short)gdata;
-				if (VRAMWrite.ImagePtr>=psxVuw_eom) VRAMWrite.ImagePtr-=iGPUHeight*1024;
-				VRAMWrite.RowsRemaining --;
+////////////////////////////////////////////////////////////////////////
+// vram rects (x0,y0,x1,y1 inclusive) a prim may touch
 
-				if (VRAMWrite.RowsRemaining <= 0)
-				{
-					VRAMWrite.ColsRemaining--;
-					if (VRAMWrite.ColsRemaining <= 0)             // last pixel is odd width
-					{
-						gdata=(gdata&0xFFFF)|(((unsigned long)(*VRAMWrite.ImagePtr))<<16);
-						FinishedVRAMWrite();
-						bDoVSyncUpdate=TRUE;
-						goto ENDVRAM;
-					}
-					VRAMWrite.RowsRemaining = VRAMWrite.Width;
-					VRAMWrite.ImagePtr += 1024 - VRAMWrite.Width;
-				}
+static __inline void GPUrectAll(long * r)
+{
+	r[0]=0;r[1]=0;r[2]=1023;r[3]=iGPUHeight-1;
+}
 
-				*VRAMWrite.ImagePtr++ = (unsigned short)(gdata>>16);
-				if (VRAMWrite.ImagePtr>=psxVuw_eom) VRAMWrite.ImagePtr-=iGPUHeight*1024;
-				VRAMWrite.RowsRemaining --;
-			}
+static __inline void GPUrectAddPoint(long * r,long x,long y)
+{
+	if (x<r[0]) r[0]=x;
+	if (y<r[1]) r[1]=y;
+	if (x>r[2]) r[2]=x;
+	if (y>r[3]) r[3]=y;
+}
 
-			VRAMWrite.RowsRemaining = VRAMWrite.Width;
-			VRAMWrite.ColsRemaining--;
-			VRAMWrite.ImagePtr += 1024 - VRAMWrite.Width;
-			bFinished=TRUE;
+static __inline void GPUrectAddVertex(long * r,unsigned long v)
+{
+	short x=(short)(((int)(short)(v&0xffff)<<21)>>21);   // 11 bit signed, like AdjustCoord
+	short y=(short)(((int)(short)(v>>16)<<21)>>21);
+
+	GPUrectAddPoint(r,(short)(x+DrawOffset.x),(short)(y+DrawOffset.y));
+}
+
+static __inline void GPUrectPage(long * r,long x,long y,long w,long h)
+{
+	r[0]=x;r[1]=y;r[2]=x+w-1;r[3]=y+h-1;
+	if (r[2]>1023) {r[0]=0;r[2]=1023;r[3]++;}             // runs into the next line
+	if (r[3]>iGPUHeight-1) r[3]=iGPUHeight-1;
+}
+
+// where a prim draws to, from the emu thread's drawing state before it ran
+
+static BOOL GPUprimWriteRect(unsigned char command,unsigned long * gpuData,long lCount,long * r)
+{
+	long i;
+
+	if (command==0x02)                                    // blk fill: no draw area clipping
+	{
+		short *sgpuData = ((short *) gpuData);
+		short sX = sgpuData[2];
+		short sY = sgpuData[3];
+		short sW = sgpuData[4] & 0x3ff;
+		short sH = sgpuData[5] & 0x3ff;
+
+		sW = (sW+15) & ~15;
+		if (sH >= 1023) sH=1024;
+		if (sW >= 1023) sW=1024;
+
+		if (sX<0 || sY<0) GPUrectAll(r);
+		else
+		{
+			r[0]=sX;r[1]=sY;r[2]=sX+sW-1;r[3]=sY+sH-1;
+			if (r[2]>1023)         r[2]=1023;
+			if (r[3]>iGPUHeight-1) r[3]=iGPUHeight-1;
 		}
+		return (r[0]<=r[2] && r[1]<=r[3]);
+	}
 
-		FinishedVRAMWrite();
-		if (bFinished) bDoVSyncUpdate=TRUE;
+	if (command==0x80)                                    // move image: may wrap around
+	{
+		GPUrectAll(r);
+		return TRUE;
 	}
 
-ENDVRAM:
+	if (command<0x20 || command>=0x80) return FALSE;      // state only
 
-	if (DataWriteMode==DR_NORMAL)
+	if (dwActFixes&8)                                     // no coord checks: whole draw area
 	{
-		void (* *primFunc)(unsigned char *);
-		/*if (bSkipNextFrame)
-			primFunc=primTableSkip; //causes desync if frame skip is enabled
-		else*/
-			primFunc=primTableJ;
+		r[0]=drawX;r[1]=drawY;r[2]=drawW;r[3]=drawH;
+	}
+	else
+	{
+		r[0]=r[1]=32767;
+		r[2]=r[3]=-32768;
 
-		for (;i<iSize;)
+		if (command<0x40)                                   // polys
 		{
-			if (DataWriteMode==DR_VRAMTRANSFER) goto STARTVRAM;
+			long lStep=1+((command&0x04)?1:0)+((command&0x10)?1:0);
+			long lNum=(command&0x08)?4:3;
 
-			gdata=*pMem++;
-			i++;
+			for (i=0;i<lNum;i++) GPUrectAddVertex(r,gpuData[1+i*lStep]);
+		}
+		else if (command<0x60)                              // lines
+		{
+			GPUrectAddVertex(r,gpuData[1]);
 
-			if (gpuDataC == 0)
+			if (command&0x10)                                 // shaded
 			{
-				command = (unsigned char)((gdata>>24) & 0xff);
-
-//if(command>=0xb0 && command<0xc0) auxprintf("b0 %x!!!!!!!!!\n",command);
-
-				if (primTableCX[command])
+				if (command&0x08)
 				{
-					gpuDataC = primTableCX[command];
-					gpuCommand = command;
-					gpuDataM[0] = gdata;
-					gpuDataP = 1;
+					for (i=2;i+1<lCount;i+=2)
+					{
+						if (i>=4 && (gpuData[i] & 0xF000F000) == 0x50005000) break;
+						GPUrectAddVertex(r,gpuData[i+1]);
+					}
 				}
-				else continue;
+				else GPUrectAddVertex(r,gpuData[3]);
 			}
 			else
 			{
-				gpuDataM[gpuDataP] = gdata;
-				if (gpuDataC>128)
+				if (command&0x08)
 				{
-					if ((gpuDataC==254 && gpuDataP>=3) ||
-					    (gpuDataC==255 && gpuDataP>=4 && !(gpuDataP&1)))
+					for (i=2;i<lCount;i++)
 					{
-						if ((gpuDataM[gpuDataP] & 0xF000F000) == 0x50005000)
-							gpuDataP=gpuDataC-1;
+						if (i>=3 && (gpuData[i] & 0xF000F000) == 0x50005000) break;
+						GPUrectAddVertex(r,gpuData[i]);
 					}
 				}
-				gpuDataP++;
+				else GPUrectAddVertex(r,gpuData[2]);
 			}
+		}
+		else                                                // tiles and sprites
+		{
+			short *sgpuData = ((short *) gpuData);
+			short x=(short)(((int)sgpuData[2]<<21)>>21);
+			short y=(short)(((int)sgpuData[3]<<21)>>21);
+			long  w,h;
 
-			if (gpuDataP == gpuDataC)
+			if (x<-512 && DrawOffset.x<=-512) x+=2048;        // see AdjustCoord1
+			if (y<-512 && DrawOffset.y<=-512) y+=2048;
+
+			switch ((command>>3)&3)
 			{
-				gpuDataC=gpuDataP=0;
-				primFunc[gpuCommand]((unsigned char *)gpuDataM);
+			case 0:
+				if (command&0x04) {w=sgpuData[6]&0x3ff;h=sgpuData[7]&0x1ff;}
+				else              {w=sgpuData[4]&0x3ff;h=sgpuData[5]&iGPUHeightMask;}
+				break;
+			case 1:  w=h=1;  break;
+			case 2:  w=h=8;  break;
+			default: w=h=16; break;
+			}
 
-				if (dwEmuFixes&0x0001 || dwActFixes&0x0400)     // hack for emulating "gpu busy" in some games
-					iFakePrimBusy=4;
+			if (command==0x64 || command==0x65 || command==0x66 || command==0x67)
+			{
+				unsigned char * pT=(unsigned char *)gpuData;   // primSprtSRest draws the parts past
+				if (pT[8]+w>256 || pT[9]+h>256) GPUrectAll(r); // the page from re-wrapped coords
 			}
+
+			x+=DrawOffset.x;
+			y+=DrawOffset.y;
+			GPUrectAddPoint(r,x,y);
+			GPUrectAddPoint(r,x+w,y+h);
 		}
+
+		r[0]-=2;r[1]-=2;r[2]+=2;r[3]+=2;                    // some slack for the edge rules
 	}
 
-	lGPUdataRet=gdata;
+	if (r[0]<drawX) r[0]=drawX;
+	if (r[1]<drawY) r[1]=drawY;
+	if (r[2]>drawW) r[2]=drawW;
+	if (r[3]>drawH) r[3]=drawH;
+	if (r[0]<0)            r[0]=0;
+	if (r[1]<0)            r[1]=0;
+	if (r[2]>1023)         r[2]=1023;
+	if (r[3]>iGPUHeight-1) r[3]=iGPUHeight-1;
 
-	GPUIsReadyForCommands;
-	GPUIsIdle;
+	return (r[0]<=r[2] && r[1]<=r[3]);
 }
 
-////////////////////////////////////////////////////////////////////////
+// texture page and clut a prim reads, from the emu thread's drawing state
+// after it ran... returns the number of rects
 
-void CALLBACK GPUwriteData(unsigned long gdata)
+static int GPUprimReadRects(unsigned char command,unsigned long * gpuData,long * r)
 {
-	GPUwriteDataMem(&gdata,1);
-}
+	BOOL bSprite=(command>=0x60);
+	unsigned long c;
+	long tw,th;
 
-////////////////////////////////////////////////////////////////////////
-// this functions will be removed soon (or 'soonish')... not really needed, but some emus want them
-////////////////////////////////////////////////////////////////////////
+	if (command<0x20 || command>=0x80)                return 0;
+	if ((command>=0x40 && command<0x60) || !(command&0x04)) return 0; // lines, untextured
 
-void CALLBACK GPUsetMode(unsigned long gdata)
-{
-// Peops does nothing here...
-// DataWriteMode=(gdata&1)?DR_VRAMTRANSFER:DR_NORMAL;
-// DataReadMode =(gdata&2)?DR_VRAMTRANSFER:DR_NORMAL;
-}
+	if (dwGPUVersion==2 || iGPUHeight!=512 || GlobalTextIL || (bSprite && usMirror))
+	{
+		GPUrectAll(r);
+		return 1;
+	}
 
-long CALLBACK GPUgetMode(void)
-{
-	long iT=0;
+	tw=64<<GlobalTextTP;                                  // 256 texels in vram words
+	th=256;
+	if (bSprite) {tw<<=1;th<<=1;}                         // 8/16 sprites can run over the page
 
-	if (DataWriteMode==DR_VRAMTRANSFER) iT|=0x1;
-	if (DataReadMode ==DR_VRAMTRANSFER) iT|=0x2;
-	return iT;
+	GPUrectPage(r,GlobalTextAddrX,GlobalTextAddrY,tw,th);
+
+	if (GlobalTextTP>=2) return 1;
+
+	c=gpuData[2]>>16;                                     // clut
+	GPUrectPage(r+4,(c<<4)&0x3f0,(c>>6)&iGPUHeightMask,GlobalTextTP?256:16,1);
+
+	return 2;
 }
 
-////////////////////////////////////////////////////////////////////////
-// call config dlg
 ////////////////////////////////////////////////////////////////////////
 
-long CALLBACK GPUconfigure(void)
+static long GPUprimCount(unsigned long *gpuData, long lCount)
 {
-#ifdef _WINDOWS
-	HWND hWP=GetActiveWindow();
-
-	DialogBox(hInst,MAKEINTRESOURCE(IDD_CFGSOFT),
-	          hWP,(DLGPROC)SoftDlgProc);
-#else // LINUX
-	SoftDlgProc();
-#endif
+	long i;
 
-	return 0;
+	if (lCount>128)                                       // polylines: only up to the terminator
+	{
+		for (i=(lCount==254)?3:4;i<lCount;i+=(lCount==254)?1:2)
+			if ((gpuData[i] & 0xF000F000) == 0x50005000) break;
+		lCount=(i<lCount)?i+1:256;
+	}
+	return lCount;
 }
 
 ////////////////////////////////////////////////////////////////////////
-// sets all kind of act fixes
-////////////////////////////////////////////////////////////////////////
+// a drawn prim makes the cached textures under its write rect stale...
+// draw prims leave the draw area and offset alone, so the drawing
+// thread's state after the prim gives the same rect the queue used
 
-void SetFixes(void)
+static __inline void GPUprimDrawn(unsigned char command,unsigned long * gpuData,long lCount)
 {
-#ifdef _WINDOWS
-	BOOL bOldPerformanceCounter=IsPerformanceCounter;    // store curr timer mode
-
-	if (dwActFixes&0x10)                                 // check fix 0x10
-		IsPerformanceCounter=FALSE;
-	else SetFPSHandler();
-
-	if (bOldPerformanceCounter!=IsPerformanceCounter)    // we have change it?
-		InitFPS();                                          // -> init fps again
-#endif
+	long r[4];
 
-	if (dwActFixes&0x02) sDispWidths[4]=384;
-	else                sDispWidths[4]=368;
+	if (command>=0x20 && command<0x80 &&
+	    GPUprimWriteRect(command,gpuData,GPUprimCount(gpuData,lCount),r))
+		TexCacheDirty(r[0],r[1],r[2],r[3]);
 }
 
 ////////////////////////////////////////////////////////////////////////
-// process gpu commands
-////////////////////////////////////////////////////////////////////////
-
-unsigned long lUsedAddr[3];
 
-__inline BOOL CheckForEndlessLoop(unsigned long laddr)
+static void GPUthreadWait(int iThread,int iOther,unsigned long seq)
 {
-	if (laddr==lUsedAddr[1]) return TRUE;
-	if (laddr==lUsedAddr[2]) return TRUE;
-
-	if (laddr<lUsedAddr[0]) lUsedAddr[1]=laddr;
-	else                   lUsedAddr[2]=laddr;
-	lUsedAddr[0]=laddr;
-	return FALSE;
+	while ((long)(gpuThreadSeq[iOther]-seq)<0)
+	{
+		gpuThreadWaitFor[iThread]=iOther+1;
+		emuMemoryBarrier();
+		if ((long)(gpuThreadSeq[iOther]-seq)<0)
+			emuEventWait(&gpuSeqEvent[iThread]);
+		gpuThreadWaitFor[iThread]=0;
+	}
+	emuMemoryBarrier();                                   // its pixels are visible now
 }
 
-long CALLBACK GPUdmaChain(unsigned long * baseAddrL, unsigned long addr)
+static void GPUthreadFunc(void *arg)
 {
-	unsigned long dmaMem;
-	unsigned char * baseAddrB;
-	short count;
-	unsigned int DMACommandCounter = 0;
-
-	GPUIsBusy;
+	int iThread=*(int *)arg;
+	unsigned long gpuDataT[256];
+	unsigned long tail,head,len,kind,owner,seq,need,i;
+	unsigned long lHead=2+iGPUThreads;
+	int j;
 
-	lUsedAddr[0]=lUsedAddr[1]=lUsedAddr[2]=0xffffff;
-
-	baseAddrB = (unsigned char*) baseAddrL;
-
-	do
+	for (;;)
 	{
-		if (iGPUHeight==512) addr&=0x1FFFFC;
-		if (DMACommandCounter++ > 2000000) break;
-		if (CheckForEndlessLoop(addr)) break;
+		tail=gpuRingTail[iThread];
 
-		count = baseAddrB[addr+3];
-
-		dmaMem=addr+4;
+		if (gpuRingHead==tail)                              // nothing to do -> sleep
+		{
+			if (bGPUThreadQuit) break;
+			gpuThreadIdle[iThread]=1;
+			emuMemoryBarrier();
+			if (gpuRingHead==tail && !bGPUThreadQuit) emuEventWait(&gpuWakeEvent[iThread]);
+			gpuThreadIdle[iThread]=0;
+			continue;
+		}
 
-		if (count>0) GPUwriteDataMem(&baseAddrL[dmaMem>>2],count);
+		emuMemoryBarrier();                                 // packet words are visible after head
 
-		addr = baseAddrL[addr>>2]&0xffffff;
-	}
-	while (addr != 0xffffff);
+		len  =gpuRing[tail&GPU_RING_MASK];
+		kind =(len>>16)&0xff;
+		owner=len>>24;
+		len &=0xffff;
+		seq  =gpuRing[(tail+1)&GPU_RING_MASK];
+
+		if (kind==GPU_PKT_IMPORT)
+			GPUloadDrawState(&gpuDrawState);
+		else
+		{
+			for (i=0;i<len;i++) gpuDataT[i]=gpuRing[(tail+lHead+i)&GPU_RING_MASK];
+
+			if (owner==(unsigned long)iThread)                // mine: wait for the tiles first
+			{
+				for (j=0;j<iGPUThreads;j++)
+				{
+					need=gpuRing[(tail+2+j)&GPU_RING_MASK];
+					if (need && j!=iThread) GPUthreadWait(iThread,j,need);
+				}
+				primTableJ[(gpuDataT[0]>>24)&0xff]((unsigned char *)gpuDataT);
+				GPUprimDrawn((unsigned char)(gpuDataT[0]>>24),gpuDataT,len);
+			}
+			else if (owner==GPU_OWNER_ALL)
+			{
+				primTableJ[(gpuDataT[0]>>24)&0xff]((unsigned char *)gpuDataT);
+				GPUprimDrawn((unsigned char)(gpuDataT[0]>>24),gpuDataT,len);
+			}
+			else
+				GPUskipPrim((unsigned char)(gpuDataT[0]>>24),(unsigned char *)gpuDataT);
+		}
+
+		emuMemoryBarrier();
+		gpuThreadSeq[iThread]=seq;
+		tail+=lHead+len;
+		gpuRingTail[iThread]=tail;
+		emuMemoryBarrier();
+
+		for (j=0;j<iGPUThreads;j++)                         // wake the ones waiting for us
+			if (gpuThreadWaitFor[j]==iThread+1) emuEventSet(&gpuSeqEvent[j]);
+
+		head=gpuRingHead;
+		if (gpuEmuWaiting &&                                // emu waits for a drain or for space
+		    (head==tail || head-tail<=GPU_RING_SIZE/2))
+			emuEventSet(&gpuDoneEvent);
+	}
+
+	TexCacheFree();
+}
+
+static unsigned long GPUringUsed(void)
+{
+	unsigned long lUsed=0,l;
+	int i;
+
+	for (i=0;i<iGPUThreads;i++)                           // the slowest thread counts
+	{
+		l=gpuRingHead-gpuRingTail[i];
+		if (l>lUsed) lUsed=l;
+	}
+	return lUsed;
+}
+
+static void GPUwaitRing(unsigned long lFree)
+{
+	while (GPU_RING_SIZE-GPUringUsed()<lFree)
+	{
+		gpuEmuWaiting=1;
+		emuMemoryBarrier();
+		if (GPU_RING_SIZE-GPUringUsed()<lFree)
+			emuEventWait(&gpuDoneEvent);
+		gpuEmuWaiting=0;
+	}
+	emuMemoryBarrier();
+}
+
+void GPUsyncThreads(void)
+{
+	if (!bGPUThread) return;
+	GPUwaitRing(GPU_RING_SIZE);                           // all free -> all drawn
+	memset(gpuTileSeq,0,sizeof(gpuTileSeq));              // nothing pending on any tile
+}
+
+static unsigned long GPUnextSeq(void)
+{
+	if (++gpuSeq==0) ++gpuSeq;
+	return gpuSeq;
+}
+
+static void GPUwritePacket(unsigned long lHdr,unsigned long seq,unsigned long * need,unsigned long * gpuData,long lCount)
+{
+	unsigned long head=gpuRingHead;
+	unsigned long lHead=2+iGPUThreads;
+	long i;
+
+	GPUwaitRing(lHead+lCount);
+
+	gpuRing[head&GPU_RING_MASK]=lHdr|lCount;
+	gpuRing[(head+1)&GPU_RING_MASK]=seq;
+	for (i=0;i<iGPUThreads;i++) gpuRing[(head+2+i)&GPU_RING_MASK]=need[i];
+	for (i=0;i<lCount;i++)      gpuRing[(head+lHead+i)&GPU_RING_MASK]=gpuData[i];
+
+	emuMemoryBarrier();
+	gpuRingHead=head+lHead+lCount;
+	emuMemoryBarrier();
+
+	for (i=0;i<iGPUThreads;i++)
+		if (gpuThreadIdle[i]) emuEventSet(&gpuWakeEvent[i]);
+}
+
+static void GPUqueuePrim(unsigned long *gpuData, long lCount)
+{
+	unsigned char command=(unsigned char)((gpuData[0]>>24)&0xff);
+	unsigned long need[GPU_MAX_THREADS];
+	unsigned long seq=GPUnextSeq();
+	unsigned long owner=GPU_OWNER_ALL;
+	long r[12];
+	int  iRects=0,n,t,tx,ty;
+
+	lCount=GPUprimCount(gpuData,lCount);
+
+	memset(need,0,sizeof(need));
+
+	if (command==0x02 || (command>=0x20 && command<=0x80))
+	{
+		owner=0;                                            // clipped away: no deps needed
+		if (GPUprimWriteRect(command,gpuData,lCount,r)) iRects=1;
+	}
+
+	GPUskipPrim(command,(unsigned char *)gpuData);        // keep our drawing state in step
+
+	if (iRects && iGPUThreads>1)
+	{
+		iRects+=GPUprimReadRects(command,gpuData,r+4);
+
+		tx=((r[0]+r[2])>>1)>>GPU_TILE_SHIFT;                // owner by the middle of the prim
+		ty=((r[1]+r[3])>>1)>>GPU_TILE_SHIFT;
+		owner=(tx+ty)%iGPUThreads;
+
+		for (n=0;n<iRects;n++)
+		{
+			for (ty=r[n*4+1]>>GPU_TILE_SHIFT;ty<=(r[n*4+3]>>GPU_TILE_SHIFT);ty++)
+			{
+				for (tx=r[n*4]>>GPU_TILE_SHIFT;tx<=(r[n*4+2]>>GPU_TILE_SHIFT);tx++)
+				{
+					t=ty*GPU_TILE_COLS+tx;
+					if (gpuTileSeq[t] && gpuTileOwner[t]!=owner &&
+					    (!need[gpuTileOwner[t]] || (long)(gpuTileSeq[t]-need[gpuTileOwner[t]])>0))
+						need[gpuTileOwner[t]]=gpuTileSeq[t];
+					gpuTileSeq[t]=seq;
+					gpuTileOwner[t]=(unsigned char)owner;
+				}
+			}
+		}
+	}
+
+	GPUwritePacket((GPU_PKT_PRIM<<16)|(owner<<24),seq,need,gpuData,lCount);
+}
+
+// a prim nobody draws, the threads just keep their drawing state in step
+
+static void GPUqueueSkip(unsigned long *gpuData, long lCount)
+{
+	unsigned long need[GPU_MAX_THREADS];
+
+	memset(need,0,sizeof(need));
+	GPUskipPrim((unsigned char)((gpuData[0]>>24)&0xff),(unsigned char *)gpuData);
+	GPUwritePacket((GPU_PKT_PRIM<<16)|(GPU_OWNER_NONE<<24),GPUnextSeq(),need,gpuData,lCount);
+}
+
+////////////////////////////////////////////////////////////////////////
+// the emu thread's drawing state is the master copy... hand it to the
+// gpu threads after it got changed from outside (start, reset, freeze)
+
+void GPUimportDrawState(void)
+{
+	unsigned long need[GPU_MAX_THREADS];
+
+	if (!bGPUThread) return;
+
+	GPUsync();                                            // nobody reads gpuDrawState now
+	GPUsaveDrawState(&gpuDrawState);
+	memset(need,0,sizeof(need));
+	GPUwritePacket((GPU_PKT_IMPORT<<16)|(GPU_OWNER_ALL<<24),GPUnextSeq(),need,NULL,0);
+	GPUsync();
+}
+
+static void GPUfreeThreads(int iRunning)
+{
+	int i;
+
+	bGPUThreadQuit=TRUE;
+	emuMemoryBarrier();
+
+	for (i=0;i<iRunning;i++)
+	{
+		emuEventSet(&gpuWakeEvent[i]);
+		emuThreadJoin(&gpuThread[i]);
+	}
+
+	for (i=0;i<iGPUThreads;i++)
+	{
+		emuEventDestroy(&gpuWakeEvent[i]);
+		emuEventDestroy(&gpuSeqEvent[i]);
+	}
+	emuEventDestroy(&gpuDoneEvent);
+
+	iGPUThreads=0;
+}
+
+void GPUstartThread(void)
+{
+	int i,n=iGPUThread;
+
+	if (bGPUThread) return;
+
+#ifdef GPU_NO_TLS
+	n=0;                                                  // one drawing state only
+#endif
+	if (n>GPU_MAX_THREADS)   n=GPU_MAX_THREADS;
+	if (n>emuCpuCount()-1)   n=emuCpuCount()-1;           // one cpu stays with the emu
+	if (n<1) return;
+
+	gpuRingHead=0;
+	gpuSeq=0;
+	gpuEmuWaiting=0;
+	bGPUThreadQuit=FALSE;
+	memset(gpuTileSeq,0,sizeof(gpuTileSeq));
+	memset(gpuTileOwner,0,sizeof(gpuTileOwner));
+
+	iGPUThreads=n;
+	emuEventInit(&gpuDoneEvent);
+	for (i=0;i<n;i++)
+	{
+		gpuRingTail[i]=gpuThreadSeq[i]=0;
+		gpuThreadIdle[i]=gpuThreadWaitFor[i]=0;
+		gpuThreadNum[i]=i;
+		emuEventInit(&gpuWakeEvent[i]);
+		emuEventInit(&gpuSeqEvent[i]);
+	}
+
+	for (i=0;i<n;i++)
+		if (emuThreadCreate(&gpuThread[i],GPUthreadFunc,&gpuThreadNum[i])!=0) break;
+
+	if (i<n)                                              // no luck: draw on the emu thread
+	{
+		GPUfreeThreads(i);
+		return;
+	}
+
+	bGPUThread=TRUE;
+
+	GPUimportDrawState();                                 // threads start with our state
+}
+
+void GPUstopThread(void)
+{
+	if (!bGPUThread) return;
+
+	GPUsync();                                            // our drawing state is up to date already
+	GPUfreeThreads(iGPUThreads);
+
+	bGPUThread=FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////
+// lazy frame skipping
+//
+// In a skipped frame the prims drawing into the display buffers (the
+// shown and the previous one) are not drawn, they just get logged with
+// the vram rects they write and read. The prims and state cmds after
+// them get logged as well, for the drawing state. Everything else (vram
+// transfers, fills, moves, drawing to textures) runs as usual. The log
+// gets replayed, starting with the drawing state from its begin, as soon
+// as something could see the missing pixels: a vram op or prim touching
+// the logged rects, a shown frame, a vram read, a freeze... so vram
+// always looks like no frame got skipped, and skipping can't desync
+// movies or freezes. Logged prims a blk fill covers completely are dead
+// and never get drawn at all.
+////////////////////////////////////////////////////////////////////////
+
+#define GPU_SKIP_PRIMS  0x2000                         // log size: entries
+#define GPU_SKIP_WORDS  0x20000                        // and prim words
+
+#define GPU_SKIP_STATE  0                              // logged for the drawing state
+#define GPU_SKIP_DRAW   1                              // skipped prim, still to draw
+#define GPU_SKIP_DEAD   2                              // skipped prim, filled over
+
+typedef struct GPUSKIPTAG
+{
+	unsigned long  lOffset;                              // in gpuSkipData
+	long           lCount;
+	unsigned char  command;
+	unsigned char  flags;
+	int            iRects;                               // write rect + read rects
+	long           r[12];
+} GPUSkip_t;
+
+static GPUSkip_t      gpuSkip[GPU_SKIP_PRIMS];
+static unsigned long  gpuSkipData[GPU_SKIP_WORDS];
+static int            gpuSkipPrims=0;
+static unsigned long  gpuSkipWords=0;
+static long           gpuSkipBox[4];                   // all rects of the skipped prims
+static GPUDrawState_t gpuSkipState;                    // drawing state at the log start
+
+static __inline BOOL GPUrectHit(long * a,long * b)
+{
+	return (a[0]<=b[2] && b[0]<=a[2] && a[1]<=b[3] && b[1]<=a[3]);
+}
+
+static __inline BOOL GPUrectInside(long * a,long * b)
+{
+	return (a[0]>=b[0] && a[2]<=b[2] && a[1]>=b[1] && a[3]<=b[3]);
+}
+
+static __inline void GPUrectVram(long * r,long x,long y,long w,long h)
+{
+	if (w<=0 || h<=0 || x+w>1024 || y+h>iGPUHeight)      // wraps around
+		GPUrectAll(r);
+	else
+	{
+		r[0]=x;r[1]=y;r[2]=x+w-1;r[3]=y+h-1;
+	}
+}
+
+// vram shown at display pos x,y
+
+static void GPUrectDisplay(long * r,long x,long y)
+{
+	long w=PSXDisplay.DisplayMode.x;
+
+	if (PSXDisplay.RGB24) w=(w*3)>>1;
+
+	r[0]=x;r[1]=y;r[2]=x+w-1;r[3]=y+PSXDisplay.DisplayMode.y-1;
+	if (r[2]>1023)         {r[0]=0;r[2]=1023;}
+	if (r[3]>iGPUHeight-1) {r[1]=0;r[3]=iGPUHeight-1;}
+}
+
+////////////////////////////////////////////////////////////////////////
+// draw the skipped prims
+
+static void GPUskipFlush(void)
+{
+	GPUDrawState_t s;
+	GPUSkip_t * e;
+	int i;
+
+	if (!gpuSkipPrims) return;
+
+	GPUsyncThreads();                                     // we draw on this thread
+
+	GPUsaveDrawState(&s);
+	GPUloadDrawState(&gpuSkipState);
+
+	for (i=0;i<gpuSkipPrims;i++)
+	{
+		e=&gpuSkip[i];
+		if (e->flags==GPU_SKIP_DRAW)
+		{
+			primTableJ[e->command]((unsigned char *)(gpuSkipData+e->lOffset));
+			GPUprimDrawn(e->command,gpuSkipData+e->lOffset,e->lCount);
+		}
+		else GPUskipPrim(e->command,(unsigned char *)(gpuSkipData+e->lOffset));
+	}
+
+	GPUloadDrawState(&s);
+
+	gpuSkipPrims=0;
+	gpuSkipWords=0;
+}
+
+// does an op writing rect w (if any) and reading rects rd touch skipped pixels?
+
+static BOOL GPUskipHit(long * w,long * rd,int iReads)
+{
+	GPUSkip_t * e;
+	int i,j;
+
+	if (!gpuSkipPrims) return FALSE;
+
+	for (j=0;j<iReads;j++)
+		if (GPUrectHit(rd+j*4,gpuSkipBox)) break;
+	if (j==iReads && !(w && GPUrectHit(w,gpuSkipBox))) return FALSE;
+
+	for (i=0;i<gpuSkipPrims;i++)
+	{
+		e=&gpuSkip[i];
+		if (e->flags!=GPU_SKIP_DRAW) continue;
+
+		for (j=0;j<iReads;j++)                              // reads its pixels
+			if (GPUrectHit(rd+j*4,e->r)) return TRUE;
+
+		if (!w) continue;
+
+		for (j=0;j<e->iRects;j++)                           // draws over/blends with its pixels
+			if (GPUrectHit(w,e->r+j*4)) return TRUE;         // or changes its texture
+	}
+	return FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////
+// pure vram ops are never skipped, skipped prims they touch get drawn
+// first... a blk fill just kills the ones it covers
+
+static void GPUskipVramOp(unsigned char command,unsigned long * gpuData)
+{
+	unsigned short *sgpuData = ((unsigned short *) gpuData);
+	GPUSkip_t * e;
+	long r[8];
+	int i,j;
+
+	if (!gpuSkipPrims) return;
+
+	switch (command)
+	{
+		case 0x02:                                          // blk fill
+		{
+			BOOL bExact=((short)sgpuData[2]>=0 && (short)sgpuData[3]>=0);
+
+			if (!GPUprimWriteRect(command,gpuData,3,r)) return;
+			if (!GPUrectHit(r,gpuSkipBox)) return;
+
+			for (i=0;i<gpuSkipPrims;i++)
+			{
+				e=&gpuSkip[i];
+				if (e->flags!=GPU_SKIP_DRAW) continue;
+				if (bExact && GPUrectInside(e->r,r)) continue;  // gets killed below
+				for (j=0;j<e->iRects;j++)
+					if (GPUrectHit(r,e->r+j*4)) {GPUskipFlush();return;}
+			}
+
+			for (i=0;i<gpuSkipPrims;i++)
+			{
+				e=&gpuSkip[i];
+				if (e->flags==GPU_SKIP_DRAW && GPUrectInside(e->r,r))
+					e->flags=GPU_SKIP_DEAD;
+			}
+			return;
+		}
+
+		case 0x80:                                          // move image
+			if ((short)sgpuData[6]<=0 || (short)sgpuData[7]<=0) return;
+			GPUrectVram(r,  sgpuData[2]&0x3ff,sgpuData[3]&iGPUHeightMask,(short)sgpuData[6],(short)sgpuData[7]);
+			GPUrectVram(r+4,sgpuData[4]&0x3ff,sgpuData[5]&iGPUHeightMask,(short)sgpuData[6],(short)sgpuData[7]);
+			if (GPUskipHit(r+4,r,1)) GPUskipFlush();
+			return;
+
+		case 0xa0:                                          // load image
+			GPUrectVram(r,sgpuData[2]&0x3ff,sgpuData[3]&iGPUHeightMask,(short)sgpuData[4],(short)sgpuData[5]);
+			if (GPUskipHit(r,NULL,0)) GPUskipFlush();
+			return;
+
+		case 0xc0:                                          // store image
+			GPUrectVram(r,sgpuData[2]&0x3ff,sgpuData[3]&iGPUHeightMask,(short)sgpuData[4],(short)sgpuData[5]);
+			if (GPUskipHit(NULL,r,1)) GPUskipFlush();
+			return;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// called for each prim before it runs... TRUE: skipped, don't draw it
+
+static BOOL GPUskipLog(unsigned long * gpuData,long lCount)
+{
+	unsigned char command=(unsigned char)((gpuData[0]>>24)&0xff);
+	GPUDrawState_t s;
+	GPUSkip_t * e;
+	long r[12],d[4];
+	int  iRects=0,i;
+	BOOL bSkip=FALSE;
+
+	if (!gpuSkipPrims && !bSkipNextFrame) return FALSE;  // the usual case
+
+	if (command==0x02 || command==0x80 || command==0xa0 || command==0xc0)
+	{
+		GPUskipVramOp(command,gpuData);
+		return FALSE;                                       // no drawing state: not logged
+	}
+
+	lCount=GPUprimCount(gpuData,lCount);
+
+	if (command>=0x20 && command<0x80 && GPUprimWriteRect(command,gpuData,lCount,r))
+	{
+		iRects=1;
+		GPUsaveDrawState(&s);                               // reads need the state after it
+		GPUskipPrim(command,(unsigned char *)gpuData);
+		iRects+=GPUprimReadRects(command,gpuData,r+4);
+		GPUloadDrawState(&s);
+
+		if (bSkipNextFrame)                                 // only skip display drawing
+		{
+			GPUrectDisplay(d,PSXDisplay.DisplayPosition.x,PSXDisplay.DisplayPosition.y);
+			bSkip=GPUrectInside(r,d);
+			if (!bSkip)
+			{
+				GPUrectDisplay(d,PreviousPSXDisplay.DisplayPosition.x,PreviousPSXDisplay.DisplayPosition.y);
+				bSkip=GPUrectInside(r,d);
+			}
+		}
+	}
+
+	if (gpuSkipPrims==GPU_SKIP_PRIMS || gpuSkipWords+lCount>GPU_SKIP_WORDS)
+		GPUskipFlush();                                     // log is full
+	else if (!bSkip && iRects && GPUskipHit(r,r+4,iRects-1))
+		GPUskipFlush();
+
+	if (!bSkip && !gpuSkipPrims) return FALSE;            // nothing to log for
+
+	if (!gpuSkipPrims)
+	{
+		GPUsaveDrawState(&gpuSkipState);
+		gpuSkipBox[0]=gpuSkipBox[1]=32767;
+		gpuSkipBox[2]=gpuSkipBox[3]=-32768;
+	}
+
+	e=&gpuSkip[gpuSkipPrims++];
+	e->lOffset=gpuSkipWords;
+	e->lCount=lCount;
+	e->command=command;
+	e->flags=bSkip?GPU_SKIP_DRAW:GPU_SKIP_STATE;
+	e->iRects=0;
+	memcpy(gpuSkipData+gpuSkipWords,gpuData,lCount*sizeof(unsigned long));
+	gpuSkipWords+=lCount;
+
+	if (!bSkip) return FALSE;
+
+	e->iRects=iRects;
+	memcpy(e->r,r,iRects*4*sizeof(long));
+	for (i=0;i<iRects;i++)
+	{
+		GPUrectAddPoint(gpuSkipBox,r[i*4],r[i*4+1]);
+		GPUrectAddPoint(gpuSkipBox,r[i*4+2],r[i*4+3]);
+	}
+
+	if (bGPUThread) GPUqueueSkip(gpuData,lCount);         // state only
+	else            GPUskipPrim(command,(unsigned char *)gpuData);
+
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////
+// the shown frame must not miss skipped prims
+
+void GPUskipShow(void)
+{
+	long r[4];
+
+	GPUrectDisplay(r,PSXDisplay.DisplayPosition.x,PSXDisplay.DisplayPosition.y);
+	if (GPUskipHit(NULL,r,1)) GPUskipFlush();
+}
+
+////////////////////////////////////////////////////////////////////////
+// everything drawn: queued and skipped prims
+
+void GPUsync(void)
+{
+	GPUsyncThreads();
+	GPUskipFlush();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void CALLBACK GPUwriteDataMem(unsigned long * pMem, int iSize)
+{
+	unsigned char command;
+	unsigned long gdata=0;
+	int i=0;
+
+	if (bGPUDump) DumpWriteData(pMem,iSize);
+
+	GPUIsBusy;
+	GPUIsNotReadyForCommands;
+
+STARTVRAM:
+
+	if (DataWriteMode==DR_VRAMTRANSFER)
+	{
+		BOOL bFinished=FALSE;
+
+		// make sure we are in vram
+		while (VRAMWrite.ImagePtr>=psxVuw_eom)
+			VRAMWrite.ImagePtr-=iGPUHeight*1024;
+		while (VRAMWrite.ImagePtr<psxVuw)
+			VRAMWrite.ImagePtr+=iGPUHeight*1024;
+
+		// now do the loop
+		while (VRAMWrite.ColsRemaining>0)
+		{
+			while (VRAMWrite.RowsRemaining>0)
+			{
+				if (i>=iSize)
+				{
+					goto ENDVRAM;
+				}
+				i++;
+
+				gdata=*pMem++;
+
+				*VRAMWrite.ImagePtr++ = (unsigned short)gdata;
+				if (VRAMWrite.ImagePtr>=psxVuw_eom) VRAMWrite.ImagePtr-=iGPUHeight*1024;
+				VRAMWrite.RowsRemaining --;
+
+				if (VRAMWrite.RowsRemaining <= 0)
+				{
+					VRAMWrite.ColsRemaining--;
+					if (VRAMWrite.ColsRemaining <= 0)             // last pixel is odd width
+					{
+						gdata=(gdata&0xFFFF)|(((unsigned long)(*VRAMWrite.ImagePtr))<<16);
+						FinishedVRAMWrite();
+						bDoVSyncUpdate=TRUE;
+						goto ENDVRAM;
+					}
+					VRAMWrite.RowsRemaining = VRAMWrite.Width;
+					VRAMWrite.ImagePtr += 1024 - VRAMWrite.Width;
+				}
+
+				*VRAMWrite.ImagePtr++ = (unsigned short)(gdata>>16);
+				if (VRAMWrite.ImagePtr>=psxVuw_eom) VRAMWrite.ImagePtr-=iGPUHeight*1024;
+				VRAMWrite.RowsRemaining --;
+			}
+
+			VRAMWrite.RowsRemaining = VRAMWrite.Width;
+			VRAMWrite.ColsRemaining--;
+			VRAMWrite.ImagePtr += 1024 - VRAMWrite.Width;
+			bFinished=TRUE;
+		}
+
+		FinishedVRAMWrite();
+		if (bFinished) bDoVSyncUpdate=TRUE;
+	}
+
+ENDVRAM:
+
+	if (DataWriteMode==DR_NORMAL)
+	{
+		for (;i<iSize;)
+		{
+			if (DataWriteMode==DR_VRAMTRANSFER) goto STARTVRAM;
+
+			gdata=*pMem++;
+			i++;
+
+			if (gpuDataC == 0)
+			{
+				command = (unsigned char)((gdata>>24) & 0xff);
+
+//if(command>=0xb0 && command<0xc0) auxprintf("b0 %x!!!!!!!!!\n",command);
+
+				if (primTableCX[command])
+				{
+					gpuDataC = primTableCX[command];
+					gpuCommand = command;
+					gpuDataM[0] = gdata;
+					gpuDataP = 1;
+				}
+				else continue;
+			}
+			else
+			{
+				gpuDataM[gpuDataP] = gdata;
+				if (gpuDataC>128)
+				{
+					if ((gpuDataC==254 && gpuDataP>=3) ||
+					    (gpuDataC==255 && gpuDataP>=4 && !(gpuDataP&1)))
+					{
+						if ((gpuDataM[gpuDataP] & 0xF000F000) == 0x50005000)
+							gpuDataP=gpuDataC-1;
+					}
+				}
+				gpuDataP++;
+			}
+
+			if (gpuDataP == gpuDataC)
+			{
+				long lCount=gpuDataC;
+
+				gpuDataC=gpuDataP=0;
+				primStatusUpdate(gpuCommand,gpuDataM);            // status regs are always done here
+				if (gpuCommand==0x02 || gpuCommand==0x80 ||       // and so is the vsync flag, the
+				    (gpuCommand>=0x20 && gpuCommand<0x80))        // prim may run on a gpu thread
+					bDoVSyncUpdate=TRUE;
+
+				if (GPUskipLog(gpuDataM,lCount)) ;              // skipped frame: drawn later, if ever
+				else if (bGPUThread && gpuCommand!=0xa0 && gpuCommand!=0xc0) // vram transfers stay on this thread
+					GPUqueuePrim(gpuDataM,lCount);
+				else
+				{
+					GPUsyncThreads();
+					if (fpGPUprimHook) fpGPUprimHook(gpuCommand,gpuDataM,FALSE);
+					primTableJ[gpuCommand]((unsigned char *)gpuDataM);
+					GPUprimDrawn(gpuCommand,gpuDataM,lCount);
+					if (fpGPUprimHook) fpGPUprimHook(gpuCommand,gpuDataM,TRUE);
+				}
+
+				if (dwEmuFixes&0x0001 || dwActFixes&0x0400)     // hack for emulating "gpu busy" in some games
+					iFakePrimBusy=4;
+			}
+		}
+	}
+
+	lGPUdataRet=gdata;
+
+	GPUIsReadyForCommands;
+	GPUIsIdle;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void CALLBACK GPUwriteData(unsigned long gdata)
+{
+	GPUwriteDataMem(&gdata,1);
+}
+
+////////////////////////////////////////////////////////////////////////
+// this functions will be removed soon (or 'soonish')... not really needed, but some emus want them
+////////////////////////////////////////////////////////////////////////
+
+void CALLBACK GPUsetMode(unsigned long gdata)
+{
+// Peops does nothing here...
+// DataWriteMode=(gdata&1)?DR_VRAMTRANSFER:DR_NORMAL;
+// DataReadMode =(gdata&2)?DR_VRAMTRANSFER:DR_NORMAL;
+}
+
+long CALLBACK GPUgetMode(void)
+{
+	long iT=0;
+
+	if (DataWriteMode==DR_VRAMTRANSFER) iT|=0x1;
+	if (DataReadMode ==DR_VRAMTRANSFER) iT|=0x2;
+	return iT;
+}
+
+////////////////////////////////////////////////////////////////////////
+// call config dlg
+////////////////////////////////////////////////////////////////////////
+
+long CALLBACK GPUconfigure(void)
+{
+#ifdef _WINDOWS
+	HWND hWP=GetActiveWindow();
+
+	DialogBox(hInst,MAKEINTRESOURCE(IDD_CFGSOFT),
+	          hWP,(DLGPROC)SoftDlgProc);
+#else // LINUX
+	SoftDlgProc();
+#endif
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+// sets all kind of act fixes
+////////////////////////////////////////////////////////////////////////
+
+void SetFixes(void)
+{
+#ifdef _WINDOWS
+	BOOL bOldPerformanceCounter=IsPerformanceCounter;    // store curr timer mode
+
+	if (dwActFixes&0x10)                                 // check fix 0x10
+		IsPerformanceCounter=FALSE;
+	else SetFPSHandler();
+
+	if (bOldPerformanceCounter!=IsPerformanceCounter)    // we have change it?
+		InitFPS();                                          // -> init fps again
+#endif
+
+	if (dwActFixes&0x02) sDispWidths[4]=384;
+	else                sDispWidths[4]=368;
+}
+
+////////////////////////////////////////////////////////////////////////
+// process gpu commands
+////////////////////////////////////////////////////////////////////////
+
+// A visited bit per list node catches every loop exactly (walking the
+// same nodes once more clears them again). The packets get gathered
+// and sent in one go: it's the same data stream, just fewer calls
+
+#define DMA_NODES       (0x1000000>>2)                 // 24 bit node addresses
+#define DMA_BATCH       0x4000                         // words per GPUwriteDataMem
+
+static unsigned long dmaVisited[DMA_NODES/32];
+static unsigned long dmaBatch[DMA_BATCH];
+
+static __inline BOOL DMAvisited(unsigned long laddr,BOOL bClear)
+{
+	unsigned long n=(laddr>>2)&(DMA_NODES-1);
+	unsigned long b=1UL<<(n&31);
+	BOOL bSet=(dmaVisited[n>>5]&b)?TRUE:FALSE;
+
+	if (bClear) dmaVisited[n>>5]&=~b;
+	else        dmaVisited[n>>5]|=b;
+	return bSet;
+}
+
+long CALLBACK GPUdmaChain(unsigned long * baseAddrL, unsigned long addr)
+{
+	unsigned char * baseAddrB;
+	unsigned long mask,start;
+	long count,lBatch=0;
+
+	GPUIsBusy;
+
+	baseAddrB = (unsigned char*) baseAddrL;
+	mask=(iGPUHeight==512)?0x1FFFFC:0xffffff;
+	start=addr&=mask;
+
+	for (;;)
+	{
+		while (!(count=baseAddrB[addr+3]))                   // empty (ot) nodes: just follow
+		{
+			if (DMAvisited(addr,FALSE)) goto DMAEND;           // loop
+			addr=baseAddrL[addr>>2]&0xffffff;
+			if (addr==0xffffff) goto DMAEND;
+			addr&=mask;
+		}
+
+		if (DMAvisited(addr,FALSE)) break;
+
+		if (lBatch+count>DMA_BATCH)
+		{
+			GPUwriteDataMem(dmaBatch,lBatch);
+			lBatch=0;
+		}
+		memcpy(dmaBatch+lBatch,&baseAddrL[(addr+4)>>2],count*sizeof(unsigned long));
+		lBatch+=count;
+
+		addr=baseAddrL[addr>>2]&0xffffff;
+		if (addr==0xffffff) break;
+		addr&=mask;
+	}
+
+DMAEND:
+
+	if (lBatch) GPUwriteDataMem(dmaBatch,lBatch);
+
+	for (addr=start;DMAvisited(addr,TRUE);)               // clear the bits again
+	{
+		addr=baseAddrL[addr>>2]&0xffffff;
+		if (addr==0xffffff) break;
+		addr&=mask;
+	}
 
 	GPUIsIdle;
 
@@ -2158,20 +3255,6 @@ long CALLBACK GPUtest(void)
 // Freeze
 ////////////////////////////////////////////////////////////////////////
 
-#pragma pack(push, 1)
-typedef struct GPUFREEZETAG
-{
-	void* extraData;
-	int extraDataSize;
-	unsigned long ulFreezeVersion;      // should be always 1 for now (set by main emu)
-	unsigned long ulStatus;             // current gpu status
-	unsigned long ulControl[256];       // latest control register values
-	unsigned char psxVRam[1024*1024*2]; // current VRam image (full 2 MB for ZN)
-} GPUFreeze_t;
-#pragma pack(pop)
-
-////////////////////////////////////////////////////////////////////////
-
 struct FreezeExtra
 {
 	long           lLowerpart;
@@ -2220,14 +3303,14 @@ struct FreezeExtra
 
 void FreezeExtra_save(struct FreezeExtra* extra)
 {
-	extern short g_m1,g_m2,g_m3;
-	extern short DrawSemiTrans;
-	extern short Ymin;
-	extern short Ymax;
+	extern GPU_TLS short g_m1,g_m2,g_m3;
+	extern GPU_TLS short DrawSemiTrans;
+	extern GPU_TLS short Ymin;
+	extern GPU_TLS short Ymax;
 
-	extern short          ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;        // global psx vertex coords
-	extern long           GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP; //!
-	extern long           GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
+	extern GPU_TLS short  ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;        // global psx vertex coords
+	extern GPU_TLS long   GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP; //!
+	extern GPU_TLS long   GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
 
 	extra->lLowerpart = lLowerpart;
 	extra->bCheckMask= bCheckMask;
@@ -2248,6 +3331,7 @@ void FreezeExtra_save(struct FreezeExtra* extra)
 	extra->dwLaceCnt = dwLaceCnt;
 
 	extra->PSXDisplay = PSXDisplay;
+	extra->PSXDisplay.DrawOffset = DrawOffset;
 	extra->PreviousPSXDisplay = PreviousPSXDisplay; 
 
 	memcpy(extra->lGPUInfoVals,lGPUInfoVals,sizeof(lGPUInfoVals));
@@ -2288,14 +3372,14 @@ void FreezeExtra_save(struct FreezeExtra* extra)
 
 void FreezeExtra_load(struct FreezeExtra* extra)
 {
-	extern short g_m1,g_m2,g_m3;
-	extern short DrawSemiTrans;
-	extern short Ymin;
-	extern short Ymax;
+	extern GPU_TLS short g_m1,g_m2,g_m3;
+	extern GPU_TLS short DrawSemiTrans;
+	extern GPU_TLS short Ymin;
+	extern GPU_TLS short Ymax;
 
-	extern short          ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;        // global psx vertex coords
-	extern long           GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP; //!
-	extern long           GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
+	extern GPU_TLS short  ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;        // global psx vertex coords
+	extern GPU_TLS long   GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP; //!
+	extern GPU_TLS long   GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
 
 	lLowerpart = extra->lLowerpart;
 	bCheckMask= extra->bCheckMask;
@@ -2316,6 +3400,7 @@ void FreezeExtra_load(struct FreezeExtra* extra)
 	dwLaceCnt = extra->dwLaceCnt;
 
 	PSXDisplay = extra->PSXDisplay;
+	DrawOffset = extra->PSXDisplay.DrawOffset;
 	PreviousPSXDisplay = extra->PreviousPSXDisplay; 
 
 	memcpy(lGPUInfoVals,extra->lGPUInfoVals,sizeof(lGPUInfoVals));
@@ -2354,34 +3439,32 @@ void FreezeExtra_load(struct FreezeExtra* extra)
 	GlobalTextPAGE = extra->GlobalTextPAGE;
 };
 
-long CALLBACK GPUfreeze(unsigned long ulGetFreezeData,GPUFreeze_t * pF)
+////////////////////////////////////////////////////////////////////////
+// GPUfreezeEx: like GPUfreeze 0/1, but the caller owns the extra data
+// buffer (pF->extraData, pF->extraDataSize bytes), so nothing gets
+// allocated here. If it's too small for a save, we return 0 with the
+// size needed in pF->extraDataSize.
+////////////////////////////////////////////////////////////////////////
+
+long CALLBACK GPUfreezeEx(unsigned long ulGetFreezeData,GPUFreeze_t * pF)
 {
-	if(ulGetFreezeData==3)
-	{
-		free(pF->extraData);
-		return 1;
-	}
-	//----------------------------------------------------//
-	if (ulGetFreezeData==2)                               // 2: info, which save slot is selected? (just for display)
-	{
-		long lSlotNum=*((long *)pF);
-		if (lSlotNum<0) return 0;
-		if (lSlotNum>8) return 0;
-		lSelectedSlot=lSlotNum+1;
-		BuildDispMenu(0);
-		return 1;
-	}
-	//----------------------------------------------------//
 	if (!pF)                    return 0;                 // some checks
 	if (pF->ulFreezeVersion!=1) return 0;
 
 	if (ulGetFreezeData==1)                               // 1: get data
 	{
+		if (!pF->extraData || pF->extraDataSize<(int)sizeof(struct FreezeExtra))
+		{
+			pF->extraDataSize = sizeof(struct FreezeExtra);
+			return 0;
+		}
+
+		GPUsync();                                          // state must not be in flight
+
 		pF->ulStatus=lGPUstatusRet;
 		memcpy(pF->ulControl,ulStatusControl,256*sizeof(unsigned long));
 		memcpy(pF->psxVRam,  psxVub,         1024*iGPUHeight*2);
 		pF->extraDataSize = sizeof(struct FreezeExtra);
-		pF->extraData = malloc(pF->extraDataSize);
 		FreezeExtra_save((struct FreezeExtra*)pF->extraData);
 
 		return 1;
@@ -2391,13 +3474,16 @@ long CALLBACK GPUfreeze(unsigned long ulGetFreezeData,GPUFreeze_t * pF)
 
 	//loadstate:
 
+	DumpStop();                                           // the dumped calls don't lead here
+
+	GPUsync();                                            // state must not be in flight
+
 	lGPUstatusRet=pF->ulStatus;
 	memcpy(ulStatusControl,pF->ulControl,256*sizeof(unsigned long));
-	memcpy(psxVub,         pF->psxVRam,  1024*iGPUHeight*2);
+	VramLoad((unsigned short *)pF->psxVRam);              // only changed tiles count as dirty
 
 	FreezeExtra_load((struct FreezeExtra*)pF->extraData);
-
-// RESET TEXTURE STORE HERE, IF YOU USE SOMETHING LIKE THAT
+	GPUimportDrawState();                                 // hand the loaded state to the gpu threads
 
 	//GPUwriteStatus(ulStatusControl[0]);
 	//GPUwriteStatus(ulStatusControl[1]);
@@ -2412,6 +3498,35 @@ long CALLBACK GPUfreeze(unsigned long ulGetFreezeData,GPUFreeze_t * pF)
 	return 1;
 }
 
+////////////////////////////////////////////////////////////////////////
+
+long CALLBACK GPUfreeze(unsigned long ulGetFreezeData,GPUFreeze_t * pF)
+{
+	if(ulGetFreezeData==3)
+	{
+		free(pF->extraData);
+		return 1;
+	}
+	//----------------------------------------------------//
+	if (ulGetFreezeData==2)                               // 2: info, which save slot is selected? (just for display)
+	{
+		long lSlotNum=*((long *)pF);
+		if (lSlotNum<0) return 0;
+		if (lSlotNum>8) return 0;
+		lSelectedSlot=lSlotNum+1;
+		BuildDispMenu(0);
+		return 1;
+	}
+	//----------------------------------------------------//
+	if (ulGetFreezeData==1 && pF && pF->ulFreezeVersion==1) // 1: extra data is ours, freed with 3
+	{
+		pF->extraDataSize = sizeof(struct FreezeExtra);
+		pF->extraData = malloc(pF->extraDataSize);
+	}
+
+	return GPUfreezeEx(ulGetFreezeData,pF);
+}
+
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
@@ -3372,30 +4487,110 @@ void CALLBACK GPUsetcurrentmode(char newModeFlags)
 	modeFlags = newModeFlags;
 	BuildDispMenu(0);
 }
+////////////////////////////////////////////////////////////////////////
+// avi: .y4m/.raw files go to the threaded dumper (vdump.c), on windows
+// everything else is recorded with video for windows
+
+#ifdef _WINDOWS
 void OnRecording(HWND hW);
+#endif
+
 void CALLBACK GPUstartAvi(char* filename)
 {
-	if (!RECORD_RECORDING)
+	if (bVDump) return;
+
+#ifdef _WINDOWS
+	if (RECORD_RECORDING) return;
+
+	if (VDUMP_FileFormat(filename)==VDUMP_NONE)
 	{
 		HWND hWP=GetActiveWindow();
 		OnRecording(hWP);
 		RECORD_RECORDING=TRUE;
 		RECORD_Start(filename);
 		BuildDispMenu(0);
+		return;
+	}
+#endif
+
+	VDUMP_Start(filename,0);
+	BuildDispMenu(0);
+}
+
+////////////////////////////////////////////////////////////////////////
+// av dump: one avi with the frames and the sound, the core calls
+// GPUavDumpFrame on each vsync (after GPUupdateLace) with the sound mixed
+// since the last one, the movie frame and the cpu cycles that frame took.
+// Stopped by GPUstopAvi.
+
+long CALLBACK GPUstartAvDump(char * pFile,long lFps)
+{
+	if (bVDump) return -1;
+#ifdef _WINDOWS
+	if (RECORD_RECORDING) return -1;
+#endif
+
+	if (!VDUMP_Start(pFile,lFps)) return -1;
+	BuildDispMenu(0);
+	return 0;
+}
+
+void CALLBACK GPUavDumpFrame(unsigned long ulFrame,unsigned long ulCycles,short * pSamples,long lSamples)
+{
+	if (!bVDump || !bVDumpAudio) return;
+
+	GPUsyncThreads();
+	GPUskipShow();
+	if (VDUMP_WriteFrame(ulFrame,ulCycles,pSamples,lSamples)==FALSE)
+	{
+		VDUMP_Stop();
+		BuildDispMenu(0);
 	}
 }
 
 void CALLBACK GPUstopAvi()
 {
+	if (bVDump)
+	{
+		VDUMP_Stop();
+		BuildDispMenu(0);
+	}
+
+#ifdef _WINDOWS
 	if (RECORD_RECORDING)
 	{
 		RECORD_RECORDING=FALSE;
 		RECORD_Stop();
 		BuildDispMenu(0);
 	}
+#endif
 }
 
 void CALLBACK GPUsendFpLuaGui(void (*fpPCSX_LuaGuiTemp)(void *s, int width, int height, int bpp, int pitch))
 {
 	fpPCSX_LuaGui = fpPCSX_LuaGuiTemp;
 }
+
+////////////////////////////////////////////////////////////////////////
+// gpu dump: records the gpu calls of the next lFrames frames (0: till
+// GPUstopDump) for replaying them in gpubench
+
+long CALLBACK GPUstartDump(char * pFile,long lFrames)
+{
+	return DumpStart(pFile,lFrames)?0:-1;
+}
+
+void CALLBACK GPUstopDump(void)
+{
+	DumpStop();
+}
+
+#ifdef _HEADLESS
+// headless build: who gets the finished frames (32 bit, psx size)...
+// NULL: nobody, then they don't even get blitted
+
+void CALLBACK GPUsetFrameCallback(void (*fpFrame)(void *s, int width, int height, int bpp, int pitch))
+{
+	fpHeadlessFrame = fpFrame;
+}
+#endif
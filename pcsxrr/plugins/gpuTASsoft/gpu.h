@@ -61,11 +61,36 @@ void           updateDisplay(void);
 void           SetAutoFrameCap(void);
 void           SetFixes(void);
 void           speedModifier(unsigned long option);
+#ifdef _WINDOWS
 void           makeNormalSnapshotPNG(void);
 void           makeNormalSnapshotBMP(void);
+#endif
 void           makeVramSnapshot(void);
 void           makeFullVramSnapshot(void);
-void           (*fpPCSX_LuaGui)(void *s, int width, int height, int bpp, int pitch);
+void           GPUsync(void);
+void           GPUsyncThreads(void);
+void           GPUskipShow(void);
+void           GPUstartThread(void);
+void           GPUstopThread(void);
+void           GPUimportDrawState(void);
+extern void    (*fpPCSX_LuaGui)(void *s, int width, int height, int bpp, int pitch);
+extern void    (*fpGPUprimHook)(unsigned char command,unsigned long * gpuData,BOOL bDone);
+
+/////////////////////////////////////////////////////////////////////////////
+
+#pragma pack(push, 1)
+typedef struct GPUFREEZETAG
+{
+	void* extraData;
+	int extraDataSize;
+	unsigned long ulFreezeVersion;      // should be always 1 for now (set by main emu)
+	unsigned long ulStatus;             // current gpu status
+	unsigned long ulControl[256];       // latest control register values
+	unsigned char psxVRam[1024*1024*2]; // current VRam image (full 2 MB for ZN)
+} GPUFreeze_t;
+#pragma pack(pop)
+
+long CALLBACK  GPUfreezeEx(unsigned long ulGetFreezeData,GPUFreeze_t * pF);
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,470 @@
+/***************************************************************************
+                         gpubench.c  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+//*************************************************************************//
+// History of changes:
+//
+// 2026/10/19
+// - replays gpu dumps (see dump.h) through the soft rasteriser with the
+//   headless display, and reports the time spent per prim type
+//
+//*************************************************************************//
+
+// usage: gpubench [-l loops] [-t] dump...
+//
+// Each prim drawn gets timed on its own, its pixels are the area of its
+// polygon/rect clipped to the drawing area (lines: their length), so
+// ns/pixel is the rasteriser cost. With -t the drawing threads of the
+// config file stay on, then only the totals are of any use.
+
+#include "stdafx.h"
+
+#include <time.h>
+
+#include "externals.h"
+#include "gpu.h"
+#include "dump.h"
+
+long CALLBACK GPUinit(void);
+long CALLBACK GPUshutdown(void);
+long GPUopen(unsigned long * disp,char * CapText,char * CfgFile);
+long CALLBACK GPUclose(void);
+void CALLBACK GPUwriteStatus(unsigned long gdata);
+void CALLBACK GPUwriteDataMem(unsigned long * pMem,int iSize);
+void CALLBACK GPUreadDataMem(unsigned long * pMem,int iSize);
+void CALLBACK GPUupdateLace(void);
+
+////////////////////////////////////////////////////////////////////////
+
+typedef struct BENCHSTATTAG
+{
+	unsigned long  lCount;
+	double         dPixels;
+	double         dNs;
+} BenchStat_t;
+
+static BenchStat_t     benchStat[256];                 // per gp0 cmd
+static struct timespec tsPrim;
+
+static double BenchNs(struct timespec * a,struct timespec * b)
+{
+	return (double)(b->tv_sec-a->tv_sec)*1e9+(double)(b->tv_nsec-a->tv_nsec);
+}
+
+////////////////////////////////////////////////////////////////////////
+// pixels of a prim: polygon area in the drawing area
+
+static __inline long BenchX(unsigned long v) {return (long)((v&0x7ff)^0x400)-0x400+DrawOffset.x;}
+static __inline long BenchY(unsigned long v) {return (long)(((v>>16)&0x7ff)^0x400)-0x400+DrawOffset.y;}
+
+static int BenchClipEdge(double * in,int n,double * out,int iAxis,double dLimit,int iSign)
+{
+	int i,m=0;
+	double * a,* b,t;
+
+	for (i=0;i<n;i++)
+	{
+		a=in+i*2;
+		b=in+((i+1)%n)*2;
+
+		if ((a[iAxis]-dLimit)*iSign>=0)
+		{
+			out[m*2]=a[0];out[m*2+1]=a[1];m++;
+		}
+		if (((a[iAxis]-dLimit)*iSign>=0)!=((b[iAxis]-dLimit)*iSign>=0))
+		{
+			t=(dLimit-a[iAxis])/(b[iAxis]-a[iAxis]);
+			out[m*2]  =a[0]+(b[0]-a[0])*t;
+			out[m*2+1]=a[1]+(b[1]-a[1])*t;
+			m++;
+		}
+	}
+	return m;
+}
+
+static double BenchTriArea(long x0,long y0,long x1,long y1,long x2,long y2)
+{
+	double p[16],q[16],a=0;
+	int i,n=3;
+
+	p[0]=x0;p[1]=y0;p[2]=x1;p[3]=y1;p[4]=x2;p[5]=y2;
+
+	n=BenchClipEdge(p,n,q,0,(double)drawX,1);            // to the drawing area
+	n=BenchClipEdge(q,n,p,0,(double)drawW+1,-1);
+	n=BenchClipEdge(p,n,q,1,(double)drawY,1);
+	n=BenchClipEdge(q,n,p,1,(double)drawH+1,-1);
+
+	for (i=0;i<n;i++)
+		a+=p[i*2]*p[((i+1)%n)*2+1]-p[((i+1)%n)*2]*p[i*2+1];
+	return (a<0)?-a/2:a/2;
+}
+
+static double BenchRectArea(long x,long y,long w,long h)
+{
+	long x1=x+w,y1=y+h;
+
+	if (x<drawX)    x=drawX;
+	if (y<drawY)    y=drawY;
+	if (x1>drawW+1) x1=drawW+1;
+	if (y1>drawH+1) y1=drawH+1;
+	if (x1<=x || y1<=y) return 0;
+	return (double)(x1-x)*(double)(y1-y);
+}
+
+static double BenchPixels(unsigned char command,unsigned long * gpuData)
+{
+	if (command==0x02)                                    // blk fill
+		return (double)(((gpuData[2]&0x3ff)+15)&~15)*(double)((gpuData[2]>>16)&0x1ff);
+
+	if (command==0x80)                                    // move image
+		return (double)(gpuData[3]&0xffff)*(double)((gpuData[3]>>16)&0xffff);
+
+	if (command>=0x20 && command<0x40)                    // polys
+	{
+		int iStride=1+((command&0x10)?1:0)+((command&0x04)?1:0);
+		unsigned long * v=gpuData+1;
+		double d=BenchTriArea(BenchX(v[0]),BenchY(v[0]),BenchX(v[iStride]),BenchY(v[iStride]),
+		                      BenchX(v[2*iStride]),BenchY(v[2*iStride]));
+
+		if (command&0x08)                                   // quad: 1,3,2 as well
+			d+=BenchTriArea(BenchX(v[iStride]),BenchY(v[iStride]),BenchX(v[3*iStride]),BenchY(v[3*iStride]),
+			                BenchX(v[2*iStride]),BenchY(v[2*iStride]));
+		return d;
+	}
+
+	if (command>=0x40 && command<0x60)                    // lines: length
+	{
+		int i,iStride=(command&0x10)?2:1;
+		int iMax=(command&0x08)?255:2;                      // poly-line: till the end mark
+		unsigned long * v=gpuData+1;
+		double d=0;
+		long dx,dy;
+
+		for (i=1;i<iMax && i*iStride<254;i++)
+		{
+			if (i>=2 && (v[i*iStride]&0xF000F000)==0x50005000) break;
+			dx=BenchX(v[i*iStride])-BenchX(v[(i-1)*iStride]);
+			dy=BenchY(v[i*iStride])-BenchY(v[(i-1)*iStride]);
+			if (dx<0) dx=-dx;
+			if (dy<0) dy=-dy;
+			d+=((dx>dy)?dx:dy)+1;
+		}
+		return d;
+	}
+
+	if (command>=0x60 && command<0x80)                    // tiles and sprites
+	{
+		long w,h;
+
+		switch (command&0x18)
+		{
+			case 0x00:
+				w=gpuData[(command&0x04)?3:2];
+				h=(w>>16)&0x1ff;
+				w&=0x3ff;
+				break;
+			case 0x08: w=h=1;  break;
+			case 0x10: w=h=8;  break;
+			default:   w=h=16; break;
+		}
+		return BenchRectArea(BenchX(gpuData[1]),BenchY(gpuData[1]),w,h);
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+// fpGPUprimHook: around each prim drawn
+
+static void BenchPrimHook(unsigned char command,unsigned long * gpuData,BOOL bDone)
+{
+	struct timespec t;
+	BenchStat_t * s;
+
+	if (!bDone)
+	{
+		clock_gettime(CLOCK_MONOTONIC,&tsPrim);
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC,&t);
+
+	s=&benchStat[command];
+	s->lCount++;
+	s->dNs+=BenchNs(&tsPrim,&t);
+	s->dPixels+=BenchPixels(command,gpuData);
+}
+
+static void BenchName(unsigned char command,char * pName)
+{
+	if (command>=0x20 && command<0x40)
+		sprintf(pName,"poly%d%s%s%s%s",(command&0x08)?4:3,(command&0x10)?" gouraud":" flat",
+		        (command&0x04)?" tex":"",(command&0x02)?" semi":"",(command&0x01)?" raw":"");
+	else if (command>=0x40 && command<0x60)
+		sprintf(pName,"%s%s%s",(command&0x08)?"polyline":"line",(command&0x10)?" gouraud":" flat",
+		        (command&0x02)?" semi":"");
+	else if (command>=0x60 && command<0x80)
+	{
+		static const char * szSize[4]={"","1x1 ","8x8 ","16x16 "};
+		sprintf(pName,"%s%s%s%s",szSize[(command>>3)&3],(command&0x04)?"sprite":"tile",
+		        (command&0x02)?" semi":"",(command&0x01)?" raw":"");
+	}
+	else if (command==0x02) strcpy(pName,"blk fill");
+	else if (command==0x80) strcpy(pName,"move image");
+	else if (command==0xa0) strcpy(pName,"load image");
+	else if (command==0xc0) strcpy(pName,"store image");
+	else if (command>=0xe1 && command<=0xe6) strcpy(pName,"draw state");
+	else strcpy(pName,"other");
+}
+
+////////////////////////////////////////////////////////////////////////
+// walks the calls once before the replay: a call that is broken or runs
+// past the end of the file cuts the dump there (*plSize: words to replay,
+// *pulFrames: the vsyncs in them)
+
+static BOOL BenchCheckTags(unsigned int * pTags,long * plSize,unsigned long * pulFrames)
+{
+	long l=0,lSize=*plSize;
+	unsigned int tag,n;
+
+	*pulFrames=0;
+	while (l<lSize)
+	{
+		tag=pTags[l];
+		n=DUMP_COUNT(tag);
+
+		switch (DUMP_TYPE(tag))
+		{
+			case DUMP_END:    *plSize=l;return TRUE;
+			case DUMP_DATA:   if (n>4096) n=0xffffffff;   break; // the dumper writes 4096 max
+			case DUMP_STATUS: n=1;                        break;
+			case DUMP_READ:   n=0;                        break;
+			case DUMP_VSYNC:  n=0;(*pulFrames)++;         break;
+			default:          n=0xffffffff;               break;
+		}
+
+		if (n>=(unsigned int)(lSize-l)) break;          // tag + n words have to fit
+		l+=1+n;
+	}
+
+	*plSize=l;
+	return FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////
+// one dump: load it all, replay it lLoops times
+
+static int BenchDump(char * pFile,long lLoops,BOOL bThreads)
+{
+	static unsigned long ulData[4096];
+	DumpHeader_t h;
+	GPUFreeze_t * pF;
+	unsigned int * pTags,* p,* pEnd,tag;
+	struct timespec t0,t1;
+	double dNs=0;
+	long lSize,l;
+	unsigned long ulFrames;
+	void * pExtra;
+	BOOL bState;
+	FILE * f;
+
+	f=fopen(pFile,"rb");
+	if (!f) {printf("%s: can't open\n",pFile);return 1;}
+
+	if (fread(&h,sizeof(h),1,f)!=1 || memcmp(h.szMagic,DUMP_MAGIC,sizeof(DUMP_MAGIC)) ||
+	    h.ulVersion!=DUMP_VERSION || (h.ulVRamHeight!=512 && h.ulVRamHeight!=1024))
+	{
+		printf("%s: no gpu dump\n",pFile);
+		fclose(f);
+		return 1;
+	}
+
+	pF=(GPUFreeze_t *)malloc(sizeof(GPUFreeze_t));
+	pExtra=(h.ulExtraSize<=0x100000)?malloc(h.ulExtraSize+1):NULL;
+	if (!pF || !pExtra ||
+	    fread(pF->psxVRam,1024*2,h.ulVRamHeight,f)!=h.ulVRamHeight ||
+	    (h.ulExtraSize && fread(pExtra,h.ulExtraSize,1,f)!=1))
+	{
+		printf("%s: truncated dump\n",pFile);
+		free(pExtra);
+		free(pF);
+		fclose(f);
+		return 1;
+	}
+	pF->extraDataSize=h.ulExtraSize;
+	pF->extraData=pExtra;
+
+	pTags=NULL;                                           // the calls: all in memory
+	l=ftell(f);
+	if (l>=0 && !fseek(f,0,SEEK_END) && (lSize=ftell(f)-l)>=0 && !fseek(f,l,SEEK_SET))
+		pTags=(unsigned int *)malloc(lSize+sizeof(unsigned int));
+	if (!pTags)
+	{
+		printf("%s: can't read the calls\n",pFile);
+		free(pExtra);
+		free(pF);
+		fclose(f);
+		return 1;
+	}
+	lSize=fread(pTags,1,lSize,f)/sizeof(unsigned int);
+	fclose(f);
+
+	if (!BenchCheckTags(pTags,&lSize,&ulFrames))
+		printf("%s: truncated dump, replaying the first %ld words\n",pFile,lSize);
+	pEnd=pTags+lSize;
+
+	iGPUHeight=h.ulVRamHeight;                            // like the zn interface does
+	iGPUHeightMask=iGPUHeight-1;
+
+	GPUinit();
+	GPUopen(NULL,"gpubench",NULL);
+
+	UseFrameLimit=0;                                      // full speed, every frame
+	UseFrameSkip=0;
+	bSkipNextFrame=FALSE;
+	if (!bThreads)
+	{
+		GPUstopThread();
+		fpGPUprimHook=BenchPrimHook;
+	}
+
+	pF->ulFreezeVersion=1;
+	pExtra=pF->extraData;                                 // our FreezeExtra size
+	pF->extraData=NULL;
+	pF->extraDataSize=0;
+	GPUfreezeEx(1,pF);
+	bState=(pF->extraDataSize==(int)h.ulExtraSize);
+	pF->extraData=pExtra;
+	pF->extraDataSize=h.ulExtraSize;
+
+	pF->ulStatus=h.ulStatus;
+	for (l=0;l<256;l++) pF->ulControl[l]=h.ulControl[l];
+
+	if (!bState)
+		printf("%s: dumped by another build, state not loaded\n",pFile);
+
+	for (l=0;l<lLoops;l++)
+	{
+		if (bState) GPUfreezeEx(0,pF);
+
+		clock_gettime(CLOCK_MONOTONIC,&t0);
+
+		for (p=pTags;p<pEnd;)
+		{
+			unsigned int i,n;
+
+			tag=*p++;
+			n=DUMP_COUNT(tag);
+
+			switch (DUMP_TYPE(tag))
+			{
+				case DUMP_DATA:
+					for (i=0;i<n;i++) ulData[i]=p[i];
+					GPUwriteDataMem(ulData,n);
+					p+=n;
+					break;
+				case DUMP_STATUS:
+					GPUwriteStatus(*p++);
+					break;
+				case DUMP_READ:
+					for (;n;n-=i)
+					{
+						i=(n>4096)?4096:n;
+						GPUreadDataMem(ulData,i);
+					}
+					break;
+				case DUMP_VSYNC:
+					GPUupdateLace();
+					break;
+			}
+		}
+
+		GPUsync();
+		clock_gettime(CLOCK_MONOTONIC,&t1);
+		dNs+=BenchNs(&t0,&t1);
+	}
+
+	fpGPUprimHook=NULL;
+	GPUclose();
+	GPUshutdown();
+
+	printf("%s: %lu frames x %ld: %.2f ms, %.1f fps\n",pFile,ulFrames,lLoops,
+	       dNs/1e6,(dNs>0)?(double)ulFrames*lLoops*1e9/dNs:0);
+
+	free(pTags);
+	free(pF->extraData);
+	free(pF);
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+static void BenchReport(void)
+{
+	double dNs=0,dPixels=0;
+	unsigned long lCount=0;
+	char szName[64];
+	int i;
+
+	printf("\n%-4s %-28s %10s %14s %10s %9s\n","cmd","prim","count","pixels","ns/prim","ns/pixel");
+
+	for (i=0;i<256;i++)
+	{
+		BenchStat_t * s=&benchStat[i];
+
+		if (!s->lCount) continue;
+
+		BenchName((unsigned char)i,szName);
+		printf("0x%02x %-28s %10lu %14.0f %10.1f",i,szName,s->lCount,s->dPixels,s->dNs/s->lCount);
+		if (s->dPixels>0) printf(" %9.2f\n",s->dNs/s->dPixels);
+		else              printf(" %9s\n","-");
+
+		lCount+=s->lCount;
+		dPixels+=s->dPixels;
+		dNs+=s->dNs;
+	}
+
+	if (!lCount) return;
+
+	printf("%-4s %-28s %10lu %14.0f %10.1f %9.2f\n","","all",lCount,dPixels,dNs/lCount,
+	       (dPixels>0)?dNs/dPixels:0);
+}
+
+int main(int argc,char ** argv)
+{
+	long lLoops=1;
+	BOOL bThreads=FALSE;
+	int i,iErr=0,iDumps=0;
+
+	for (i=1;i<argc;i++)
+	{
+		if (!strcmp(argv[i],"-l") && i+1<argc) {lLoops=atol(argv[++i]);continue;}
+		if (!strcmp(argv[i],"-t"))             {bThreads=TRUE;continue;}
+		if (lLoops<1) lLoops=1;
+		iErr|=BenchDump(argv[i],lLoops,bThreads);
+		iDumps++;
+	}
+
+	if (!iDumps)
+	{
+		printf("usage: gpubench [-l loops] [-t] dump...\n");
+		return 1;
+	}
+
+	if (!bThreads) BenchReport();
+
+	return iErr;
+}
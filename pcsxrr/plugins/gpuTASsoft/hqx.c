@@ -0,0 +1,345 @@
+/***************************************************************************
+                          hqx.c  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+//*************************************************************************//
+// History of changes:
+//
+// 2026/10/19
+// - portable C hq2x/hq3x, built from the hq2x.h/hq3x.h case tables and
+//   running in bands on all cpus. They replace the nasm versions, which
+//   kept their state in globals and were 32 bit x86 only
+//
+//*************************************************************************//
+
+#include "stdafx.h"
+
+#include "externals.h"
+#include "draw.h"
+#include "interp.h"
+
+// Same calls as the old asm versions: 16 bit (565) source, 1024 bytes per
+// line on windows and width*2 elsewhere, pitch is the one of the target.
+// The _32 funcs write 32 bit pixels, the _16 ones 565 again.
+
+extern unsigned int LUT16to32[65536];
+
+#ifdef _WINDOWS
+#define HQ_SRCPITCH(w) 512
+#else
+#define HQ_SRCPITCH(w) (w)
+#endif
+
+////////////////////////////////////////////////////////////////////////
+// the 3x3 pixels around src1[0]... clamped at the picture edges
+
+#define HQ_PIXELS(conv)                                      \
+	c[1]=conv(src0[0]);c[4]=conv(src1[0]);c[7]=conv(src2[0]); \
+	if (i>0)                                                  \
+	{                                                         \
+		c[0]=conv(src0[-1]);c[3]=conv(src1[-1]);c[6]=conv(src2[-1]); \
+	}                                                         \
+	else                                                      \
+	{                                                         \
+		c[0]=c[1];c[3]=c[4];c[6]=c[7];                          \
+	}                                                         \
+	if (i<count-1)                                            \
+	{                                                         \
+		c[2]=conv(src0[1]);c[5]=conv(src1[1]);c[8]=conv(src2[1]); \
+	}                                                         \
+	else                                                      \
+	{                                                         \
+		c[2]=c[1];c[5]=c[4];c[8]=c[7];                          \
+	}
+
+#define HQ_MASK(diff)                                        \
+	mask=0;                                                   \
+	if (diff(c[0],c[4])) mask|=1<<0;                          \
+	if (diff(c[1],c[4])) mask|=1<<1;                          \
+	if (diff(c[2],c[4])) mask|=1<<2;                          \
+	if (diff(c[3],c[4])) mask|=1<<3;                          \
+	if (diff(c[5],c[4])) mask|=1<<4;                          \
+	if (diff(c[6],c[4])) mask|=1<<5;                          \
+	if (diff(c[7],c[4])) mask|=1<<6;                          \
+	if (diff(c[8],c[4])) mask|=1<<7;
+
+#define HQ_SAME(p)    (p)
+#define HQ_TO32(p)    LUT16to32[p]
+
+#define IC(p0)        c[p0]
+#define MUR           HQ_DIFF(c[1],c[5])
+#define MDR           HQ_DIFF(c[5],c[7])
+#define MDL           HQ_DIFF(c[7],c[3])
+#define MUL           HQ_DIFF(c[3],c[1])
+
+////////////////////////////////////////////////////////////////////////
+// 16 bit target
+
+#define HQ_DIFF               interp_16_diff
+#define I11(p0,p1)            interp_16_11(c[p0],c[p1])
+#define I31(p0,p1)            interp_16_31(c[p0],c[p1])
+#define I71(p0,p1)            interp_16_71(c[p0],c[p1])
+#define I211(p0,p1,p2)        interp_16_211(c[p0],c[p1],c[p2])
+#define I332(p0,p1,p2)        interp_16_332(c[p0],c[p1],c[p2])
+#define I521(p0,p1,p2)        interp_16_521(c[p0],c[p1],c[p2])
+#define I611(p0,p1,p2)        interp_16_611(c[p0],c[p1],c[p2])
+#define I772(p0,p1,p2)        interp_16_772(c[p0],c[p1],c[p2])
+#define I1411(p0,p1,p2)       interp_16_1411(c[p0],c[p1],c[p2])
+
+static void hq2x_16_def(unsigned short * dst0,unsigned short * dst1,
+                        const unsigned short * src0,const unsigned short * src1,const unsigned short * src2,
+                        int count)
+{
+	unsigned short c[9];
+	unsigned char mask;
+	int i;
+
+	for (i=0;i<count;i++)
+	{
+		HQ_PIXELS(HQ_SAME)
+		HQ_MASK(interp_16_diff)
+
+#define P0 dst0[0]
+#define P1 dst0[1]
+#define P2 dst1[0]
+#define P3 dst1[1]
+		switch (mask)
+		{
+#include "hq2x.h"
+		}
+#undef P0
+#undef P1
+#undef P2
+#undef P3
+
+		src0++;src1++;src2++;
+		dst0+=2;dst1+=2;
+	}
+}
+
+static void hq3x_16_def(unsigned short * dst0,unsigned short * dst1,unsigned short * dst2,
+                        const unsigned short * src0,const unsigned short * src1,const unsigned short * src2,
+                        int count)
+{
+	unsigned short c[9];
+	unsigned char mask;
+	int i;
+
+	for (i=0;i<count;i++)
+	{
+		HQ_PIXELS(HQ_SAME)
+		HQ_MASK(interp_16_diff)
+
+#define P0 dst0[0]
+#define P1 dst0[1]
+#define P2 dst0[2]
+#define P3 dst1[0]
+#define P4 dst1[1]
+#define P5 dst1[2]
+#define P6 dst2[0]
+#define P7 dst2[1]
+#define P8 dst2[2]
+		switch (mask)
+		{
+#include "hq3x.h"
+		}
+#undef P0
+#undef P1
+#undef P2
+#undef P3
+#undef P4
+#undef P5
+#undef P6
+#undef P7
+#undef P8
+
+		src0++;src1++;src2++;
+		dst0+=3;dst1+=3;dst2+=3;
+	}
+}
+
+#undef HQ_DIFF
+#undef I11
+#undef I31
+#undef I71
+#undef I211
+#undef I332
+#undef I521
+#undef I611
+#undef I772
+#undef I1411
+
+////////////////////////////////////////////////////////////////////////
+// 32 bit target
+
+#define HQ_DIFF               interp_32_diff
+#define I11(p0,p1)            interp_32_11(c[p0],c[p1])
+#define I31(p0,p1)            interp_32_31(c[p0],c[p1])
+#define I71(p0,p1)            interp_32_71(c[p0],c[p1])
+#define I211(p0,p1,p2)        interp_32_211(c[p0],c[p1],c[p2])
+#define I332(p0,p1,p2)        interp_32_332(c[p0],c[p1],c[p2])
+#define I521(p0,p1,p2)        interp_32_521(c[p0],c[p1],c[p2])
+#define I611(p0,p1,p2)        interp_32_611(c[p0],c[p1],c[p2])
+#define I772(p0,p1,p2)        interp_32_772(c[p0],c[p1],c[p2])
+#define I1411(p0,p1,p2)       interp_32_1411(c[p0],c[p1],c[p2])
+
+static void hq2x_32_def(unsigned int * dst0,unsigned int * dst1,
+                        const unsigned short * src0,const unsigned short * src1,const unsigned short * src2,
+                        int count)
+{
+	unsigned int c[9];
+	unsigned char mask;
+	int i;
+
+	for (i=0;i<count;i++)
+	{
+		HQ_PIXELS(HQ_TO32)
+		HQ_MASK(interp_32_diff)
+
+#define P0 dst0[0]
+#define P1 dst0[1]
+#define P2 dst1[0]
+#define P3 dst1[1]
+		switch (mask)
+		{
+#include "hq2x.h"
+		}
+#undef P0
+#undef P1
+#undef P2
+#undef P3
+
+		src0++;src1++;src2++;
+		dst0+=2;dst1+=2;
+	}
+}
+
+static void hq3x_32_def(unsigned int * dst0,unsigned int * dst1,unsigned int * dst2,
+                        const unsigned short * src0,const unsigned short * src1,const unsigned short * src2,
+                        int count)
+{
+	unsigned int c[9];
+	unsigned char mask;
+	int i;
+
+	for (i=0;i<count;i++)
+	{
+		HQ_PIXELS(HQ_TO32)
+		HQ_MASK(interp_32_diff)
+
+#define P0 dst0[0]
+#define P1 dst0[1]
+#define P2 dst0[2]
+#define P3 dst1[0]
+#define P4 dst1[1]
+#define P5 dst1[2]
+#define P6 dst2[0]
+#define P7 dst2[1]
+#define P8 dst2[2]
+		switch (mask)
+		{
+#include "hq3x.h"
+		}
+#undef P0
+#undef P1
+#undef P2
+#undef P3
+#undef P4
+#undef P5
+#undef P6
+#undef P7
+#undef P8
+
+		src0++;src1++;src2++;
+		dst0+=3;dst1+=3;dst2+=3;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// rows y0..y1 of the picture
+
+#define HQ_ROWS                                              \
+	const int srcpitch=HQ_SRCPITCH(width);                    \
+	const unsigned short * src1=(const unsigned short *)srcPtr+y0*srcpitch; \
+	const unsigned short * src0=(y0>0)?src1-srcpitch:src1;    \
+	const unsigned short * src2=(y0<height-1)?src1+srcpitch:src1;
+
+static void hq2x_16_band(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height,int y0,int y1)
+{
+	for (;y0<y1;y0++)
+	{
+		HQ_ROWS
+		unsigned char * d=dstPtr+y0*2*pitch;
+
+		hq2x_16_def((unsigned short *)d,(unsigned short *)(d+pitch),src0,src1,src2,width);
+	}
+}
+
+static void hq3x_16_band(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height,int y0,int y1)
+{
+	for (;y0<y1;y0++)
+	{
+		HQ_ROWS
+		unsigned char * d=dstPtr+y0*3*pitch;
+
+		hq3x_16_def((unsigned short *)d,(unsigned short *)(d+pitch),(unsigned short *)(d+2*pitch),src0,src1,src2,width);
+	}
+}
+
+static void hq2x_32_band(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height,int y0,int y1)
+{
+	for (;y0<y1;y0++)
+	{
+		HQ_ROWS
+		unsigned char * d=dstPtr+y0*2*pitch;
+
+		hq2x_32_def((unsigned int *)d,(unsigned int *)(d+pitch),src0,src1,src2,width);
+	}
+}
+
+static void hq3x_32_band(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height,int y0,int y1)
+{
+	for (;y0<y1;y0++)
+	{
+		HQ_ROWS
+		unsigned char * d=dstPtr+y0*3*pitch;
+
+		hq3x_32_def((unsigned int *)d,(unsigned int *)(d+pitch),(unsigned int *)(d+2*pitch),src0,src1,src2,width);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void hq2x_16(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height)
+{
+	interp_set(16);
+	ScaleBands(hq2x_16_band,srcPtr,pitch,dstPtr,width,height);
+}
+
+void hq3x_16(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height)
+{
+	interp_set(16);
+	ScaleBands(hq3x_16_band,srcPtr,pitch,dstPtr,width,height);
+}
+
+void hq2x_32(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height)
+{
+	ScaleBands(hq2x_32_band,srcPtr,pitch,dstPtr,width,height);
+}
+
+void hq3x_32(unsigned char * srcPtr,DWORD pitch,unsigned char * dstPtr,int width,int height)
+{
+	ScaleBands(hq3x_32_band,srcPtr,pitch,dstPtr,width,height);
+}
@@ -49,7 +49,9 @@
 
 #include "stdafx.h"
 #include <stdio.h>
+#ifdef _WINDOWS
 #include <direct.h>
+#endif
 
 #define _IN_KEY
 
@@ -264,6 +266,7 @@ void GPUkeypressed(int keycode)
 
 	if (keystate[SDLK_INSERT])
 	{
+		GPUsync();                                          // queued prims use the old fixes
 		if (iUseFixes)
 		{
 			iUseFixes=0;
@@ -307,6 +310,7 @@ void GPUkeypressed(int keycode)
 		break;
 
 	case VK_INSERT:
+		GPUsync();                                          // queued prims use the old fixes
 		if (iUseFixes)
 		{
 			iUseFixes=0;
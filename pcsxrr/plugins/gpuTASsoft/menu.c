@@ -65,6 +65,7 @@
 #include "draw.h"
 #include "menu.h"
 #include "gpu.h"
+#include "vdump.h"
 
 unsigned long dwCoreFlags=0;
 char cCurrentFrame[14];
@@ -372,7 +373,10 @@ void BuildDispMenu(int iInc)
 	szMenuBuf[(iMPos+1)*5]='<';                           // set arrow
 
 #ifdef _WINDOWS
-	if (RECORD_RECORDING)
+	if (RECORD_RECORDING || bVDump)
+#else
+	if (bVDump)
+#endif
 	{
 		szMenuBuf[27]  = ' ';
 		szMenuBuf[28]  = ' ';
@@ -383,6 +387,7 @@ void BuildDispMenu(int iInc)
 		szMenuBuf[33]  = 0;
 	}
 
+#ifdef _WINDOWS
 	if (DX.DDSScreenPic) ShowTextGpuPic();
 #endif
 }
@@ -473,6 +478,7 @@ void SwitchDispMenu(int iStep)                         // SWITCH DISP MENU
 		break;
 		//////////////////////////////////////////////////////
 	case 3:                                             // special fixes
+		GPUsync();                                        // queued prims use the old fixes
 		if (iUseFixes)
 		{
 			iUseFixes=0;
@@ -94,15 +94,15 @@
 // globals
 ////////////////////////////////////////////////////////////////////////
 
-BOOL           bUsingTWin=FALSE; //!
-TWin_t         TWin;
-unsigned long  clutid;                                 // global clut
-unsigned short usMirror=0;                             // sprite mirror //!
-int            iDither=0;
-long           drawX; //!
-long           drawY; //!
-long           drawW; //!
-long           drawH; //!
+GPU_TLS BOOL   bUsingTWin=FALSE; //!
+GPU_TLS TWin_t TWin;
+GPU_TLS unsigned long  clutid;                         // global clut
+GPU_TLS unsigned short usMirror=0;                     // sprite mirror //!
+GPU_TLS int    iDither=0;
+GPU_TLS long   drawX; //!
+GPU_TLS long   drawY; //!
+GPU_TLS long   drawW; //!
+GPU_TLS long   drawH; //!
 unsigned long  dwCfgFixes;
 unsigned long  dwActFixes=0;
 unsigned long  dwEmuFixes=0;
@@ -146,7 +146,6 @@ __inline void UpdateGlobalTP(unsigned short gdata)
 			GlobalTextTP = (gdata >> 9) & 0x3;
 			if (GlobalTextTP==3) GlobalTextTP=2;
 			usMirror =0;
-			lGPUstatusRet = (lGPUstatusRet & 0xffffe000 ) | (gdata & 0x1fff );
 
 			// tekken dithering? right now only if dithering is forced by user
 			if (iUseDither==2) iDither=2;
@@ -178,11 +177,61 @@ __inline void UpdateGlobalTP(unsigned short gdata)
 	if (GlobalTextTP==3) GlobalTextTP=2;                  // seen in Wild9 :(
 
 	GlobalTextABR = (gdata >> 5) & 0x3;                   // blend mode
+}
+
+////////////////////////////////////////////////////////////////////////
+// status/info register side of the prims... always done by the caller
+// at dispatch time, so the regs stay exact while the gpu thread draws
+////////////////////////////////////////////////////////////////////////
+
+static __inline void StatusGlobalTP(unsigned short gdata)
+{
+	if (iGPUHeight==1024 && dwGPUVersion==2)
+	{
+		lGPUstatusRet = (lGPUstatusRet & 0xffffe000 ) | (gdata & 0x1fff );
+		return;
+	}
 
 	lGPUstatusRet&=~0x07ff;                               // Clear the necessary bits
 	lGPUstatusRet|=(gdata & 0x07ff);                      // set the necessary bits
 }
 
+void primStatusUpdate(unsigned char command, unsigned long *gpuData)
+{
+	unsigned long gdata = gpuData[0];
+
+	switch (command)
+	{
+	case 0x24: case 0x25: case 0x26: case 0x27:           // tex poly ft3/ft4
+	case 0x2c: case 0x2d: case 0x2e: case 0x2f:
+		StatusGlobalTP((unsigned short)(gpuData[4]>>16));
+		break;
+	case 0x34: case 0x35: case 0x36: case 0x37:           // tex poly gt3/gt4
+	case 0x3c: case 0x3d: case 0x3e: case 0x3f:
+		StatusGlobalTP((unsigned short)(gpuData[5]>>16));
+		break;
+	case 0xe1:                                            // texture page
+		StatusGlobalTP((unsigned short)gdata);
+		break;
+	case 0xe2:                                            // texture window
+		lGPUInfoVals[INFO_TW]=gdata&0xFFFFF;
+		break;
+	case 0xe3:                                            // draw area start
+		lGPUInfoVals[INFO_DRAWSTART]=(dwGPUVersion==2) ? (gdata&0x3FFFFF) : (gdata&0xFFFFF);
+		break;
+	case 0xe4:                                            // draw area end
+		lGPUInfoVals[INFO_DRAWEND]=(dwGPUVersion==2) ? (gdata&0x3FFFFF) : (gdata&0xFFFFF);
+		break;
+	case 0xe5:                                            // draw offset
+		lGPUInfoVals[INFO_DRAWOFF]=(dwGPUVersion==2) ? (gdata&0x7FFFFF) : (gdata&0x3FFFFF);
+		break;
+	case 0xe6:                                            // mask bits
+		lGPUstatusRet&=~0x1800;                             // Clear the necessary bits
+		lGPUstatusRet|=((gdata & 0x03) << 11);              // Set the necessary bits
+		break;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////
 
 __inline void SetRenderMode(unsigned long DrawAttributes)
@@ -258,10 +307,10 @@ void AdjustCoord1()
 	lx0=(short)(((int)lx0<<SIGNSHIFT)>>SIGNSHIFT);
 	ly0=(short)(((int)ly0<<SIGNSHIFT)>>SIGNSHIFT);
 
-	if (lx0<-512 && PSXDisplay.DrawOffset.x<=-512)
+	if (lx0<-512 && DrawOffset.x<=-512)
 		lx0+=2048;
 
-	if (ly0<-512 && PSXDisplay.DrawOffset.y<=-512)
+	if (ly0<-512 && DrawOffset.y<=-512)
 		ly0+=2048;
 }
 
@@ -435,9 +484,6 @@ void cmdSTP(unsigned char * baseAddr)
 {
 	unsigned long gdata = ((unsigned long*)baseAddr)[0];
 
-	lGPUstatusRet&=~0x1800;                                   // Clear the necessary bits
-	lGPUstatusRet|=((gdata & 0x03) << 11);                    // Set the necessary bits
-
 	if (gdata&1)
 	{
 		sSetMask=0x8000;
@@ -475,8 +521,6 @@ void cmdTextureWindow(unsigned char *baseAddr)
 
 	unsigned long YAlign,XAlign;
 
-	lGPUInfoVals[INFO_TW]=gdata&0xFFFFF;
-
 	if (gdata & 0x020)
 		TWin.Position.y1 = 8;    // xxxx1
 	else if (gdata & 0x040)
@@ -544,13 +588,11 @@ void cmdDrawAreaStart(unsigned char * baseAddr)
 
 	if (dwGPUVersion==2)
 	{
-		lGPUInfoVals[INFO_DRAWSTART]=gdata&0x3FFFFF;
 		drawY  = (gdata>>12)&0x3ff;
 		if (drawY>=1024) drawY=1023;                        // some security
 	}
 	else
 	{
-		lGPUInfoVals[INFO_DRAWSTART]=gdata&0xFFFFF;
 		drawY  = (gdata>>10)&0x3ff;
 		if (drawY>=512) drawY=511;                          // some security
 	}
@@ -568,13 +610,11 @@ void cmdDrawAreaEnd(unsigned char * baseAddr)
 
 	if (dwGPUVersion==2)
 	{
-		lGPUInfoVals[INFO_DRAWEND]=gdata&0x3FFFFF;
 		drawH  = (gdata>>12)&0x3ff;
 		if (drawH>=1024) drawH=1023;                        // some security
 	}
 	else
 	{
-		lGPUInfoVals[INFO_DRAWEND]=gdata&0xFFFFF;
 		drawH  = (gdata>>10)&0x3ff;
 		if (drawH>=512) drawH=511;                          // some security
 	}
@@ -588,21 +628,19 @@ void cmdDrawOffset(unsigned char * baseAddr)
 {
 	unsigned long gdata = ((unsigned long*)baseAddr)[0];
 
-	PSXDisplay.DrawOffset.x = (short)(gdata & 0x7ff);
+	DrawOffset.x = (short)(gdata & 0x7ff);
 
 	if (dwGPUVersion==2)
 	{
-		lGPUInfoVals[INFO_DRAWOFF]=gdata&0x7FFFFF;
-		PSXDisplay.DrawOffset.y = (short)((gdata>>12) & 0x7ff);
+		DrawOffset.y = (short)((gdata>>12) & 0x7ff);
 	}
 	else
 	{
-		lGPUInfoVals[INFO_DRAWOFF]=gdata&0x3FFFFF;
-		PSXDisplay.DrawOffset.y = (short)((gdata>>11) & 0x7ff);
+		DrawOffset.y = (short)((gdata>>11) & 0x7ff);
 	}
 
-	PSXDisplay.DrawOffset.y=(short)(((int)PSXDisplay.DrawOffset.y<<21)>>21);
-	PSXDisplay.DrawOffset.x=(short)(((int)PSXDisplay.DrawOffset.x<<21)>>21);
+	DrawOffset.y=(short)(((int)DrawOffset.y<<21)>>21);
+	DrawOffset.x=(short)(((int)DrawOffset.x<<21)>>21);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -620,6 +658,8 @@ void primLoadImage(unsigned char * baseAddr)
 
 	DataWriteMode = DR_VRAMTRANSFER;
 
+	TexCacheDirty(VRAMWrite.x,VRAMWrite.y,VRAMWrite.x+VRAMWrite.Width-1,VRAMWrite.y+VRAMWrite.Height-1);
+
 	VRAMWrite.ImagePtr = psxVuw + (VRAMWrite.y<<10) + VRAMWrite.x;
 	VRAMWrite.RowsRemaining = VRAMWrite.Width;
 	VRAMWrite.ColsRemaining = VRAMWrite.Height;
@@ -672,8 +712,7 @@ void primBlkFill(unsigned char * baseAddr)
 	sH+=sY;
 
 	FillSoftwareArea(sX, sY, sW, sH, BGR24to16(gpuData[0]));
-
-	bDoVSyncUpdate=TRUE;
+	TexCacheDirty(sX, sY, sW-1, sH-1);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -711,6 +750,8 @@ void primMoveImage(unsigned char * baseAddr)
 
 	if (iGPUHeight==1024 && sgpuData[7]>1024) return;
 
+	TexCacheDirty(imageX1,imageY1,imageX1+imageSX-1,imageY1+imageSY-1);
+
 	if ((imageY0+imageSY)>iGPUHeight ||
 	    (imageX0+imageSX)>1024       ||
 	    (imageY1+imageSY)>iGPUHeight ||
@@ -722,8 +763,6 @@ void primMoveImage(unsigned char * baseAddr)
 				psxVuw [(1024*((imageY1+j)&iGPUHeightMask))+((imageX1+i)&0x3ff)]=
 				  psxVuw[(1024*((imageY0+j)&iGPUHeightMask))+((imageX0+i)&0x3ff)];
 
-		bDoVSyncUpdate=TRUE;
-
 		return;
 	}
 
@@ -777,8 +816,6 @@ void primMoveImage(unsigned char * baseAddr)
 	    updateDisplay();
 	  }
 	*/
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -801,18 +838,16 @@ void primTileS(unsigned char * baseAddr)
 	if (!(dwActFixes&8)) AdjustCoord1();
 
 // x and y of start
-	ly2 = ly3 = ly0+sH +PSXDisplay.DrawOffset.y;
-	ly0 = ly1 = ly0    +PSXDisplay.DrawOffset.y;
-	lx1 = lx2 = lx0+sW +PSXDisplay.DrawOffset.x;
-	lx0 = lx3 = lx0    +PSXDisplay.DrawOffset.x;
+	ly2 = ly3 = ly0+sH +DrawOffset.y;
+	ly0 = ly1 = ly0    +DrawOffset.y;
+	lx1 = lx2 = lx0+sW +DrawOffset.x;
+	lx0 = lx3 = lx0    +DrawOffset.x;
 
 	DrawSemiTrans = (SEMITRANSBIT(gpuData[0])) ? TRUE : FALSE;
 
 	if (!(iTileCheat && sH==32 && gpuData[0]==0x60ffffff)) // special cheat for certain ZiNc games
 		FillSoftwareAreaTrans(lx0,ly0,lx2,ly2,
 		                      BGR24to16(gpuData[0]));
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -832,17 +867,15 @@ void primTile1(unsigned char * baseAddr)
 	if (!(dwActFixes&8)) AdjustCoord1();
 
 // x and y of start
-	ly2 = ly3 = ly0+sH +PSXDisplay.DrawOffset.y;
-	ly0 = ly1 = ly0    +PSXDisplay.DrawOffset.y;
-	lx1 = lx2 = lx0+sW +PSXDisplay.DrawOffset.x;
-	lx0 = lx3 = lx0    +PSXDisplay.DrawOffset.x;
+	ly2 = ly3 = ly0+sH +DrawOffset.y;
+	ly0 = ly1 = ly0    +DrawOffset.y;
+	lx1 = lx2 = lx0+sW +DrawOffset.x;
+	lx0 = lx3 = lx0    +DrawOffset.x;
 
 	DrawSemiTrans = (SEMITRANSBIT(gpuData[0])) ? TRUE : FALSE;
 
 	FillSoftwareAreaTrans(lx0,ly0,lx2,ly2,
 	                      BGR24to16(gpuData[0]));         // Takes Start and Offset
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -862,17 +895,15 @@ void primTile8(unsigned char * baseAddr)
 	if (!(dwActFixes&8)) AdjustCoord1();
 
 // x and y of start
-	ly2 = ly3 = ly0+sH +PSXDisplay.DrawOffset.y;
-	ly0 = ly1 = ly0    +PSXDisplay.DrawOffset.y;
-	lx1 = lx2 = lx0+sW +PSXDisplay.DrawOffset.x;
-	lx0 = lx3 = lx0    +PSXDisplay.DrawOffset.x;
+	ly2 = ly3 = ly0+sH +DrawOffset.y;
+	ly0 = ly1 = ly0    +DrawOffset.y;
+	lx1 = lx2 = lx0+sW +DrawOffset.x;
+	lx0 = lx3 = lx0    +DrawOffset.x;
 
 	DrawSemiTrans = (SEMITRANSBIT(gpuData[0])) ? TRUE : FALSE;
 
 	FillSoftwareAreaTrans(lx0,ly0,lx2,ly2,
 	                      BGR24to16(gpuData[0]));         // Takes Start and Offset
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -892,17 +923,15 @@ void primTile16(unsigned char * baseAddr)
 	if (!(dwActFixes&8)) AdjustCoord1();
 
 // x and y of start
-	ly2 = ly3 = ly0+sH +PSXDisplay.DrawOffset.y;
-	ly0 = ly1 = ly0    +PSXDisplay.DrawOffset.y;
-	lx1 = lx2 = lx0+sW +PSXDisplay.DrawOffset.x;
-	lx0 = lx3 = lx0    +PSXDisplay.DrawOffset.x;
+	ly2 = ly3 = ly0+sH +DrawOffset.y;
+	ly0 = ly1 = ly0    +DrawOffset.y;
+	lx1 = lx2 = lx0+sW +DrawOffset.x;
+	lx0 = lx3 = lx0    +DrawOffset.x;
 
 	DrawSemiTrans = (SEMITRANSBIT(gpuData[0])) ? TRUE : FALSE;
 
 	FillSoftwareAreaTrans(lx0,ly0,lx2,ly2,
 	                      BGR24to16(gpuData[0]));         // Takes Start and Offset
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -927,8 +956,6 @@ void primSprt8(unsigned char * baseAddr)
 		else           DrawSoftwareSprite(baseAddr,8,8,
 			                                  baseAddr[8],
 			                                  baseAddr[9]);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -953,8 +980,6 @@ void primSprt16(unsigned char * baseAddr)
 		else           DrawSoftwareSprite(baseAddr,16,16,
 			                                  baseAddr[8],
 			                                  baseAddr[9]);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1101,8 +1126,6 @@ void primSprtS(unsigned char * baseAddr)
 			}
 
 		}
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1133,8 +1156,6 @@ void primPolyF4(unsigned char *baseAddr)
 	DrawSemiTrans = (SEMITRANSBIT(gpuData[0])) ? TRUE : FALSE;
 
 	drawPoly4F(gpuData[0]);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1165,8 +1186,6 @@ void primPolyG4(unsigned char * baseAddr)
 	DrawSemiTrans = (SEMITRANSBIT(gpuData[0])) ? TRUE : FALSE;
 
 	drawPoly4G(gpuData[0], gpuData[2], gpuData[4], gpuData[6]);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1198,8 +1217,6 @@ void primPolyFT3(unsigned char * baseAddr)
 	SetRenderMode(gpuData[0]);
 
 	drawPoly3FT(baseAddr);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1234,8 +1251,6 @@ void primPolyFT4(unsigned char * baseAddr)
 	SetRenderMode(gpuData[0]);
 
 	drawPoly4FT(baseAddr);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1274,8 +1289,6 @@ void primPolyGT3(unsigned char *baseAddr)
 	}
 
 	drawPoly3GT(baseAddr);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1304,8 +1317,6 @@ void primPolyG3(unsigned char *baseAddr)
 	DrawSemiTrans = (SEMITRANSBIT(gpuData[0])) ? TRUE : FALSE;
 
 	drawPoly3G(gpuData[0], gpuData[2], gpuData[4]);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1347,8 +1358,6 @@ void primPolyGT4(unsigned char *baseAddr)
 	}
 
 	drawPoly4GT(baseAddr);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1377,8 +1386,6 @@ void primPolyF3(unsigned char *baseAddr)
 	SetRenderMode(gpuData[0]);
 
 	drawPoly3F(gpuData[0]);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1466,8 +1473,6 @@ void primLineGEx(unsigned char *baseAddr)
 		i++;
 		if (i>iMax) break;
 	}
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1499,8 +1504,6 @@ void primLineG2(unsigned char *baseAddr)
 	DrawSemiTrans = (SEMITRANSBIT(gpuData[0])) ? TRUE : FALSE;
 	offsetPSX2();
 	DrawSoftwareLineShade(gpuData[0],gpuData[2]);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1574,8 +1577,6 @@ void primLineFEx(unsigned char *baseAddr)
 		i++;
 		if (i>iMax) break;
 	}
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1608,8 +1609,6 @@ void primLineF2(unsigned char *baseAddr)
 	SetRenderMode(gpuData[0]);
 
 	DrawSoftwareLineFlat(gpuData[0]);
-
-	bDoVSyncUpdate=TRUE;
 }
 
 ////////////////////////////////////////////////////////////////////////
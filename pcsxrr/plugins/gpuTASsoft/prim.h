@@ -29,5 +29,6 @@
 
 void UploadScreen (long Position);
 void PrepareFullScreenUpload (long Position);
+void primStatusUpdate(unsigned char command, unsigned long *gpuData);
 
 #endif // _PRIMDRAW_H_
@@ -81,6 +81,8 @@
 #include "gpu.h"
 #include "prim.h"
 #include "menu.h"
+#include "../../emuthread.h"
+#include "../../emusimd.h"
 
 ////////////////////////////////////////////////////////////////////////////////////
 // "NO EDGE BUFFER" POLY VERSION... FUNCS BASED ON FATMAP.TXT FROM MRI / Doomsday
@@ -134,6 +136,8 @@
 
 #define XPSXCOL(r,g,b) ((g&0x7c00)|(b&0x3e0)|(r&0x1f))
 
+#define SPAN_SEMI    (DrawSemiTrans?((GlobalTextABR>2)?4:(GlobalTextABR+1)):0)
+
 //#ifdef _WINDOWS
 //#pragma warning (disable:4244)
 //#pragma warning (disable:4761)
@@ -143,14 +147,14 @@
 // soft globals
 ////////////////////////////////////////////////////////////////////////////////////
 
-short g_m1=255,g_m2=255,g_m3=255;
-short DrawSemiTrans=FALSE;
-short Ymin;
-short Ymax;
+GPU_TLS short g_m1=255,g_m2=255,g_m3=255;
+GPU_TLS short DrawSemiTrans=FALSE;
+GPU_TLS short Ymin;
+GPU_TLS short Ymax;
 
-short          ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;        // global psx vertex coords
-long           GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP; //!
-long           GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
+GPU_TLS short  ly0,lx0,ly1,lx1,ly2,lx2,ly3,lx3;        // global psx vertex coords
+GPU_TLS long   GlobalTextAddrX,GlobalTextAddrY,GlobalTextTP; //!
+GPU_TLS long   GlobalTextREST,GlobalTextABR,GlobalTextPAGE;
 
 ////////////////////////////////////////////////////////////////////////
 // POLYGON OFFSET FUNCS
@@ -161,10 +165,10 @@ void offsetPSXLine(void)
 	short x0,x1,y0,y1,dx,dy;
 	float px,py;
 
-	x0 = lx0+1+PSXDisplay.DrawOffset.x;
-	x1 = lx1+1+PSXDisplay.DrawOffset.x;
-	y0 = ly0+1+PSXDisplay.DrawOffset.y;
-	y1 = ly1+1+PSXDisplay.DrawOffset.y;
+	x0 = lx0+1+DrawOffset.x;
+	x1 = lx1+1+DrawOffset.x;
+	y0 = ly0+1+DrawOffset.y;
+	y1 = ly1+1+DrawOffset.y;
 
 	dx=x1-x0;
 	dy=y1-y0;
@@ -223,32 +227,32 @@ void offsetPSXLine(void)
 
 void offsetPSX2(void)
 {
-	lx0 += PSXDisplay.DrawOffset.x;
-	ly0 += PSXDisplay.DrawOffset.y;
-	lx1 += PSXDisplay.DrawOffset.x;
-	ly1 += PSXDisplay.DrawOffset.y;
+	lx0 += DrawOffset.x;
+	ly0 += DrawOffset.y;
+	lx1 += DrawOffset.x;
+	ly1 += DrawOffset.y;
 }
 
 void offsetPSX3(void)
 {
-	lx0 += PSXDisplay.DrawOffset.x;
-	ly0 += PSXDisplay.DrawOffset.y;
-	lx1 += PSXDisplay.DrawOffset.x;
-	ly1 += PSXDisplay.DrawOffset.y;
-	lx2 += PSXDisplay.DrawOffset.x;
-	ly2 += PSXDisplay.DrawOffset.y;
+	lx0 += DrawOffset.x;
+	ly0 += DrawOffset.y;
+	lx1 += DrawOffset.x;
+	ly1 += DrawOffset.y;
+	lx2 += DrawOffset.x;
+	ly2 += DrawOffset.y;
 }
 
 void offsetPSX4(void)
 {
-	lx0 += PSXDisplay.DrawOffset.x;
-	ly0 += PSXDisplay.DrawOffset.y;
-	lx1 += PSXDisplay.DrawOffset.x;
-	ly1 += PSXDisplay.DrawOffset.y;
-	lx2 += PSXDisplay.DrawOffset.x;
-	ly2 += PSXDisplay.DrawOffset.y;
-	lx3 += PSXDisplay.DrawOffset.x;
-	ly3 += PSXDisplay.DrawOffset.y;
+	lx0 += DrawOffset.x;
+	ly0 += DrawOffset.y;
+	lx1 += DrawOffset.x;
+	ly1 += DrawOffset.y;
+	lx2 += DrawOffset.x;
+	ly2 += DrawOffset.y;
+	lx3 += DrawOffset.x;
+	ly3 += DrawOffset.y;
 }
 
 /////////////////////////////////////////////////////////////////
@@ -523,20 +527,23 @@ __inline void GetShadeTransCol32(unsigned long * pdest,unsigned long color)
 
 ////////////////////////////////////////////////////////////////////////
 
-__inline void GetTextureTransColG(unsigned short * pdest,unsigned short color)
+// blend ops below take the semi trans mode (0 = off, 1+abr) and the mask
+// check as arguments; the span kernels pass constants so both fold away
+
+static __inline void TexTransColG(unsigned short * pdest,unsigned short color,int st,int mk)
 {
 	long r,g,b;
 	unsigned short l;
 
 	if (color==0) return;
 
-	if (bCheckMask && *pdest&0x8000) return;
+	if (mk && *pdest&0x8000) return;
 
 	l=sSetMask|(color&0x8000);
 
-	if (DrawSemiTrans && (color&0x8000))
+	if (st && (color&0x8000))
 	{
-		if (GlobalTextABR==0)
+		if (st==1)
 		{
 			unsigned short d;
 			d     =((*pdest)&0x7bde)>>1;
@@ -552,14 +559,14 @@ __inline void GetTextureTransColG(unsigned short * pdest,unsigned short color)
 			*/
 		}
 		else
-			if (GlobalTextABR==1)
+			if (st==2)
 			{
 				r=(XCOL1(*pdest))+((((XCOL1(color)))* g_m1)>>7);
 				b=(XCOL2(*pdest))+((((XCOL2(color)))* g_m2)>>7);
 				g=(XCOL3(*pdest))+((((XCOL3(color)))* g_m3)>>7);
 			}
 			else
-				if (GlobalTextABR==2)
+				if (st==3)
 				{
 					r=(XCOL1(*pdest))-((((XCOL1(color)))* g_m1)>>7);
 					b=(XCOL2(*pdest))-((((XCOL2(color)))* g_m2)>>7);
@@ -597,6 +604,13 @@ __inline void GetTextureTransColG(unsigned short * pdest,unsigned short color)
 
 ////////////////////////////////////////////////////////////////////////
 
+__inline void GetTextureTransColG(unsigned short * pdest,unsigned short color)
+{
+	TexTransColG(pdest,color,SPAN_SEMI,bCheckMask);
+}
+
+////////////////////////////////////////////////////////////////////////
+
 __inline void GetTextureTransColG_S(unsigned short * pdest,unsigned short color)
 {
 	long r,g,b;
@@ -693,7 +707,7 @@ __inline void GetTextureTransColG_SPR(unsigned short * pdest,unsigned short colo
 
 ////////////////////////////////////////////////////////////////////////
 
-__inline void GetTextureTransColG32(unsigned long * pdest,unsigned long color)
+static __inline void TexTransColG32(unsigned long * pdest,unsigned long color,int st,int mk)
 {
 	long r,g,b,l;
 
@@ -701,23 +715,23 @@ __inline void GetTextureTransColG32(unsigned long * pdest,unsigned long color)
 
 	l=lSetMask|(color&0x80008000);
 
-	if (DrawSemiTrans && (color&0x80008000))
+	if (st && (color&0x80008000))
 	{
-		if (GlobalTextABR==0)
+		if (st==1)
 		{
 			r=((((X32TCOL1(*pdest))+((X32COL1(color)) * g_m1))&0xFF00FF00)>>8);
 			b=((((X32TCOL2(*pdest))+((X32COL2(color)) * g_m2))&0xFF00FF00)>>8);
 			g=((((X32TCOL3(*pdest))+((X32COL3(color)) * g_m3))&0xFF00FF00)>>8);
 		}
 		else
-			if (GlobalTextABR==1)
+			if (st==2)
 			{
 				r=(X32COL1(*pdest))+(((((X32COL1(color)))* g_m1)&0xFF80FF80)>>7);
 				b=(X32COL2(*pdest))+(((((X32COL2(color)))* g_m2)&0xFF80FF80)>>7);
 				g=(X32COL3(*pdest))+(((((X32COL3(color)))* g_m3)&0xFF80FF80)>>7);
 			}
 			else
-				if (GlobalTextABR==2)
+				if (st==3)
 				{
 					long t;
 					r=(((((X32COL1(color)))* g_m1)&0xFF80FF80)>>7);
@@ -782,7 +796,7 @@ __inline void GetTextureTransColG32(unsigned long * pdest,unsigned long color)
 	if (g&0x7FE00000) g=0x1f0000|(g&0xFFFF);
 	if (g&0x7FE0)     g=0x1f    |(g&0xFFFF0000);
 
-	if (bCheckMask)
+	if (mk)
 	{
 		unsigned long ma=*pdest;
 
@@ -811,6 +825,13 @@ __inline void GetTextureTransColG32(unsigned long * pdest,unsigned long color)
 
 ////////////////////////////////////////////////////////////////////////
 
+__inline void GetTextureTransColG32(unsigned long * pdest,unsigned long color)
+{
+	TexTransColG32(pdest,color,SPAN_SEMI,bCheckMask);
+}
+
+////////////////////////////////////////////////////////////////////////
+
 __inline void GetTextureTransColG32_S(unsigned long * pdest,unsigned long color)
 {
 	long r,g,b;
@@ -960,39 +981,39 @@ __inline void GetTextureTransColG32_SPR(unsigned long * pdest,unsigned long colo
 
 ////////////////////////////////////////////////////////////////////////
 
-__inline void GetTextureTransColGX_Dither(unsigned short * pdest,unsigned short color,long m1,long m2,long m3)
+static __inline void TexTransColGX_Dither(unsigned short * pdest,unsigned short color,long m1,long m2,long m3,int st,int mk)
 {
 	long r,g,b;
 
 	if (color==0) return;
 
-	if (bCheckMask && *pdest&0x8000) return;
+	if (mk && *pdest&0x8000) return;
 
 	m1=(((XCOL1D(color)))*m1)>>4;
 	m2=(((XCOL2D(color)))*m2)>>4;
 	m3=(((XCOL3D(color)))*m3)>>4;
 
-	if (DrawSemiTrans && (color&0x8000))
+	if (st && (color&0x8000))
 	{
 		r=((XCOL1D(*pdest))<<3);
 		b=((XCOL2D(*pdest))<<3);
 		g=((XCOL3D(*pdest))<<3);
 
-		if (GlobalTextABR==0)
+		if (st==1)
 		{
 			r=(r>>1)+(m1>>1);
 			b=(b>>1)+(m2>>1);
 			g=(g>>1)+(m3>>1);
 		}
 		else
-			if (GlobalTextABR==1)
+			if (st==2)
 			{
 				r+=m1;
 				b+=m2;
 				g+=m3;
 			}
 			else
-				if (GlobalTextABR==2)
+				if (st==3)
 				{
 					r-=m1;
 					b-=m2;
@@ -1031,20 +1052,27 @@ __inline void GetTextureTransColGX_Dither(unsigned short * pdest,unsigned short
 
 ////////////////////////////////////////////////////////////////////////
 
-__inline void GetTextureTransColGX(unsigned short * pdest,unsigned short color,short m1,short m2,short m3)
+__inline void GetTextureTransColGX_Dither(unsigned short * pdest,unsigned short color,long m1,long m2,long m3)
+{
+	TexTransColGX_Dither(pdest,color,m1,m2,m3,SPAN_SEMI,bCheckMask);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+static __inline void TexTransColGX(unsigned short * pdest,unsigned short color,short m1,short m2,short m3,int st,int mk)
 {
 	long r,g,b;
 	unsigned short l;
 
 	if (color==0) return;
 
-	if (bCheckMask && *pdest&0x8000) return;
+	if (mk && *pdest&0x8000) return;
 
 	l=sSetMask|(color&0x8000);
 
-	if (DrawSemiTrans && (color&0x8000))
+	if (st && (color&0x8000))
 	{
-		if (GlobalTextABR==0)
+		if (st==1)
 		{
 			unsigned short d;
 			d     =((*pdest)&0x7bde)>>1;
@@ -1059,14 +1087,14 @@ __inline void GetTextureTransColGX(unsigned short * pdest,unsigned short color,s
 			*/
 		}
 		else
-			if (GlobalTextABR==1)
+			if (st==2)
 			{
 				r=(XCOL1(*pdest))+((((XCOL1(color)))* m1)>>7);
 				b=(XCOL2(*pdest))+((((XCOL2(color)))* m2)>>7);
 				g=(XCOL3(*pdest))+((((XCOL3(color)))* m3)>>7);
 			}
 			else
-				if (GlobalTextABR==2)
+				if (st==3)
 				{
 					r=(XCOL1(*pdest))-((((XCOL1(color)))* m1)>>7);
 					b=(XCOL2(*pdest))-((((XCOL2(color)))* m2)>>7);
@@ -1104,6 +1132,13 @@ __inline void GetTextureTransColGX(unsigned short * pdest,unsigned short color,s
 
 ////////////////////////////////////////////////////////////////////////
 
+__inline void GetTextureTransColGX(unsigned short * pdest,unsigned short color,short m1,short m2,short m3)
+{
+	TexTransColGX(pdest,color,m1,m2,m3,SPAN_SEMI,bCheckMask);
+}
+
+////////////////////////////////////////////////////////////////////////
+
 __inline void GetTextureTransColGX_S(unsigned short * pdest,unsigned short color,short m1,short m2,short m3)
 {
 	long r,g,b;
@@ -1154,6 +1189,210 @@ __inline void GetTextureTransColGX32_S(unsigned long * pdest,unsigned long color
 	*pdest=(X32PSXCOL(r,g,b))|lSetMask|(color&0x80008000);
 }
 
+////////////////////////////////////////////////////////////////////////
+// SSE2 SPANS
+////////////////////////////////////////////////////////////////////////
+
+// eight pixel versions of the blend ops above, bit exact with the scalar
+// two pixel (*32) paths; no channel ever leaves its 16 bit lane there
+
+#ifdef ENABLE_SSE2
+
+#define SSE_COL1(v)  _mm_and_si128(v,_mm_set1_epi16(0x1f))
+#define SSE_COL2(v)  _mm_and_si128(_mm_srli_epi16(v,5),_mm_set1_epi16(0x1f))
+#define SSE_COL3(v)  _mm_srli_epi16(_mm_slli_epi16(v,1),11)
+#define SSE_PSXCOL(c1,c2,c3) _mm_or_si128(_mm_or_si128(c1,_mm_slli_epi16(c2,5)),_mm_slli_epi16(c3,10))
+#define SSE_SELECT(k,a,b)    _mm_or_si128(_mm_and_si128(k,a),_mm_andnot_si128(k,b))
+
+static __inline __m128i SSEShadeBlend(__m128i d,__m128i c,int st)
+{
+	__m128i d1,d2,d3,c1,c2,c3,m;
+
+	if (st==1)
+	{
+		m=_mm_set1_epi16(0x7bde);
+		return _mm_add_epi16(_mm_srli_epi16(_mm_and_si128(d,m),1),
+		                     _mm_srli_epi16(_mm_and_si128(c,m),1));
+	}
+
+	d1=SSE_COL1(d);d2=SSE_COL2(d);d3=SSE_COL3(d);
+	c1=SSE_COL1(c);c2=SSE_COL2(c);c3=SSE_COL3(c);
+
+	if (st==3)
+		return SSE_PSXCOL(_mm_subs_epu16(d1,c1),_mm_subs_epu16(d2,c2),_mm_subs_epu16(d3,c3));
+
+	if (st==4)
+	{
+#ifdef HALFBRIGHTMODE3
+		m=_mm_set1_epi16(0x1c);
+		c1=_mm_srli_epi16(_mm_and_si128(c1,m),2);
+		c2=_mm_srli_epi16(_mm_and_si128(c2,m),2);
+		c3=_mm_srli_epi16(_mm_and_si128(c3,m),2);
+#else
+		m=_mm_set1_epi16(0x1e);
+		c1=_mm_srli_epi16(_mm_and_si128(c1,m),1);
+		c2=_mm_srli_epi16(_mm_and_si128(c2,m),1);
+		c3=_mm_srli_epi16(_mm_and_si128(c3,m),1);
+#endif
+	}
+
+	m=_mm_set1_epi16(0x1f);
+	return SSE_PSXCOL(_mm_min_epi16(_mm_add_epi16(d1,c1),m),
+	                  _mm_min_epi16(_mm_add_epi16(d2,c2),m),
+	                  _mm_min_epi16(_mm_add_epi16(d3,c3),m));
+}
+
+// GetShadeTransCol on eight pixels, c may differ per pixel
+
+static __inline void SSEShadeStore(unsigned short * pdest,__m128i c,int st,int mk,__m128i sm)
+{
+	__m128i d=_mm_loadu_si128((__m128i *)pdest),v;
+
+	v=st?SSEShadeBlend(d,c,st):c;
+	v=_mm_or_si128(v,sm);
+	if (mk) v=SSE_SELECT(_mm_srai_epi16(d,15),d,v);
+	_mm_storeu_si128((__m128i *)pdest,v);
+}
+
+// TexTransColG32 on eight texels, m1..m3 hold g_m1..g_m3
+
+static __inline __m128i SSETexBlend(__m128i d,__m128i t,int st,int mk,__m128i m1,__m128i m2,__m128i m3,__m128i sm)
+{
+	__m128i t1=SSE_COL1(t),t2=SSE_COL2(t),t3=SSE_COL3(t);
+	__m128i c1,c2,c3,k,mx=_mm_set1_epi16(0x1f);
+
+	c1=_mm_srli_epi16(_mm_mullo_epi16(t1,m1),7);
+	c2=_mm_srli_epi16(_mm_mullo_epi16(t2,m2),7);
+	c3=_mm_srli_epi16(_mm_mullo_epi16(t3,m3),7);
+
+	if (st)
+	{
+		__m128i d1=SSE_COL1(d),d2=SSE_COL2(d),d3=SSE_COL3(d),s1,s2,s3;
+
+		if (st==1)
+		{
+			s1=_mm_srli_epi16(_mm_add_epi16(_mm_slli_epi16(d1,7),_mm_mullo_epi16(t1,m1)),8);
+			s2=_mm_srli_epi16(_mm_add_epi16(_mm_slli_epi16(d2,7),_mm_mullo_epi16(t2,m2)),8);
+			s3=_mm_srli_epi16(_mm_add_epi16(_mm_slli_epi16(d3,7),_mm_mullo_epi16(t3,m3)),8);
+		}
+		else if (st==2)
+		{
+			s1=_mm_add_epi16(d1,c1);
+			s2=_mm_add_epi16(d2,c2);
+			s3=_mm_add_epi16(d3,c3);
+		}
+		else if (st==3)
+		{
+			s1=_mm_subs_epu16(d1,c1);
+			s2=_mm_subs_epu16(d2,c2);
+			s3=_mm_subs_epu16(d3,c3);
+		}
+		else
+		{
+#ifdef HALFBRIGHTMODE3
+			k=_mm_set1_epi16(0x1c);
+			s1=_mm_add_epi16(d1,_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(_mm_and_si128(t1,k),2),m1),7));
+			s2=_mm_add_epi16(d2,_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(_mm_and_si128(t2,k),2),m2),7));
+			s3=_mm_add_epi16(d3,_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(_mm_and_si128(t3,k),2),m3),7));
+#else
+			k=_mm_set1_epi16(0x1e);
+			s1=_mm_add_epi16(d1,_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(_mm_and_si128(t1,k),1),m1),7));
+			s2=_mm_add_epi16(d2,_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(_mm_and_si128(t2,k),1),m2),7));
+			s3=_mm_add_epi16(d3,_mm_srli_epi16(_mm_mullo_epi16(_mm_srli_epi16(_mm_and_si128(t3,k),1),m3),7));
+#endif
+		}
+
+		k=_mm_srai_epi16(t,15);                           // semi trans only where the texel says so
+		c1=SSE_SELECT(k,s1,c1);
+		c2=SSE_SELECT(k,s2,c2);
+		c3=SSE_SELECT(k,s3,c3);
+	}
+
+	c1=_mm_min_epi16(c1,mx);
+	c2=_mm_min_epi16(c2,mx);
+	c3=_mm_min_epi16(c3,mx);
+
+	k=_mm_cmpeq_epi16(t,_mm_setzero_si128());             // texel 0: keep dest
+	if (mk) k=_mm_or_si128(k,_mm_srai_epi16(d,15));
+
+	return SSE_SELECT(k,d,_mm_or_si128(_mm_or_si128(SSE_PSXCOL(c1,c2,c3),sm),
+	                                   _mm_and_si128(t,_mm_set1_epi16((short)0x8000))));
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+// flat and gouraud shaded spans with semi trans / mask check
+
+void ShadeSpan(unsigned short * pdest,int n,unsigned short color)
+{
+	unsigned long lcolor=lSetMask|(((unsigned long)(color))<<16)|color;
+	int j=0;
+
+#ifdef ENABLE_SSE2
+	int st=SPAN_SEMI,mk=bCheckMask?1:0;
+	__m128i c=_mm_set1_epi16((short)color),sm=_mm_set1_epi16((short)sSetMask);
+
+	for (;j<=n-8;j+=8)
+		SSEShadeStore(&pdest[j],c,st,mk,sm);
+#endif
+
+	for (;j<n-1;j+=2)
+		GetShadeTransCol32((unsigned long *)&pdest[j],lcolor);
+	if (j==n-1)
+		GetShadeTransCol(&pdest[j],color);
+}
+
+void GouraudSpan(unsigned short * pdest,int n,long cR1,long cG1,long cB1,long difR,long difG,long difB)
+{
+	int j=0;
+
+#ifdef ENABLE_SSE2
+	if (n>=8)
+	{
+		int st=SPAN_SEMI,mk=bCheckMask?1:0;
+		__m128i sm=_mm_set1_epi16((short)sSetMask);
+		__m128i rA=_mm_set_epi32(cR1+3*difR,cR1+2*difR,cR1+difR,cR1),rB,rD=_mm_set1_epi32(difR<<2);
+		__m128i gA=_mm_set_epi32(cG1+3*difG,cG1+2*difG,cG1+difG,cG1),gB,gD=_mm_set1_epi32(difG<<2);
+		__m128i bA=_mm_set_epi32(cB1+3*difB,cB1+2*difB,cB1+difB,cB1),bB,bD=_mm_set1_epi32(difB<<2);
+		__m128i mR=_mm_set1_epi32(0x7c00),mG=_mm_set1_epi32(0x03e0),mB=_mm_set1_epi32(0x001f);
+
+		rB=_mm_add_epi32(rA,rD);rD=_mm_slli_epi32(rD,1);
+		gB=_mm_add_epi32(gA,gD);gD=_mm_slli_epi32(gD,1);
+		bB=_mm_add_epi32(bA,bD);bD=_mm_slli_epi32(bD,1);
+
+		for (;j<=n-8;j+=8)
+		{
+			__m128i cA=_mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srai_epi32(rA,9),mR),
+			                                     _mm_and_si128(_mm_srai_epi32(gA,14),mG)),
+			                        _mm_and_si128(_mm_srai_epi32(bA,19),mB));
+			__m128i cB=_mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srai_epi32(rB,9),mR),
+			                                     _mm_and_si128(_mm_srai_epi32(gB,14),mG)),
+			                        _mm_and_si128(_mm_srai_epi32(bB,19),mB));
+
+			SSEShadeStore(&pdest[j],_mm_packs_epi32(cA,cB),st,mk,sm);
+
+			rA=_mm_add_epi32(rA,rD);rB=_mm_add_epi32(rB,rD);
+			gA=_mm_add_epi32(gA,gD);gB=_mm_add_epi32(gB,gD);
+			bA=_mm_add_epi32(bA,bD);bB=_mm_add_epi32(bB,bD);
+		}
+
+		cR1+=j*difR;
+		cG1+=j*difG;
+		cB1+=j*difB;
+	}
+#endif
+
+	for (;j<n;j++)
+	{
+		GetShadeTransCol(&pdest[j],(unsigned short)(((cR1 >> 9)&0x7c00)|((cG1 >> 14)&0x03e0)|((cB1 >> 19)&0x001f)));
+		cR1+=difR;
+		cG1+=difG;
+		cB1+=difB;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////
 // FILL FUNCS
 ////////////////////////////////////////////////////////////////////////
@@ -1206,18 +1445,10 @@ void FillSoftwareAreaTrans(short x0,short y0,short x1, // FILL AREA TRANS
 		else iCheat=1;
 	}
 
-	if (dx&1)                                             // slow fill
+	if ((dx&1) || bCheckMask || DrawSemiTrans)            // blended fill
 	{
-		unsigned short *DSTPtr;
-		unsigned short LineOffset;
-		DSTPtr = psxVuw + (1024*y0) + x0;
-		LineOffset = 1024 - dx;
 		for (i=0;i<dy;i++)
-		{
-			for (j=0;j<dx;j++)
-				GetShadeTransCol(DSTPtr++,col);
-			DSTPtr += LineOffset;
-		}
+			ShadeSpan(psxVuw + (1024*(y0+i)) + x0,dx,col);
 	}
 	else                                                  // fast fill
 	{
@@ -1228,22 +1459,10 @@ void FillSoftwareAreaTrans(short x0,short y0,short x1, // FILL AREA TRANS
 		DSTPtr = (unsigned long *)(psxVuw + (1024*y0) + x0);
 		LineOffset = 512 - dx;
 
-		if (!bCheckMask && !DrawSemiTrans)
-		{
-			for (i=0;i<dy;i++)
-			{
-				for (j=0;j<dx;j++) *DSTPtr++=lcol;
-				DSTPtr += LineOffset;
-			}
-		}
-		else
+		for (i=0;i<dy;i++)
 		{
-			for (i=0;i<dy;i++)
-			{
-				for (j=0;j<dx;j++)
-					GetShadeTransCol32(DSTPtr++,lcol);
-				DSTPtr += LineOffset;
-			}
+			for (j=0;j<dx;j++) *DSTPtr++=lcol;
+			DSTPtr += LineOffset;
 		}
 	}
 }
@@ -1313,16 +1532,16 @@ typedef struct SOFTVTAG
 	long R,G,B;
 } soft_vertex;
 
-static soft_vertex vtx[4];
-static soft_vertex * left_array[4], * right_array[4];
-static int left_section, right_section;
-static int left_section_height, right_section_height;
-static int left_x, delta_left_x, right_x, delta_right_x;
-static int left_u, delta_left_u, left_v, delta_left_v;
-static int right_u, delta_right_u, right_v, delta_right_v;
-static int left_R, delta_left_R, right_R, delta_right_R;
-static int left_G, delta_left_G, right_G, delta_right_G;
-static int left_B, delta_left_B, right_B, delta_right_B;
+static GPU_TLS soft_vertex vtx[4];
+static GPU_TLS soft_vertex * left_array[4], * right_array[4];
+static GPU_TLS int left_section, right_section;
+static GPU_TLS int left_section_height, right_section_height;
+static GPU_TLS int left_x, delta_left_x, right_x, delta_right_x;
+static GPU_TLS int left_u, delta_left_u, left_v, delta_left_v;
+static GPU_TLS int right_u, delta_right_u, right_v, delta_right_v;
+static GPU_TLS int left_R, delta_left_R, right_R, delta_right_R;
+static GPU_TLS int left_G, delta_left_G, right_G, delta_right_G;
+static GPU_TLS int left_B, delta_left_B, right_B, delta_right_B;
 
 #ifdef __i386__
 
@@ -3047,12 +3266,7 @@ __inline void drawPoly3Fi(short x1,short y1,short x2,short y2,short x3,short y3,
 		xmax=(right_x >> 16)-1;
 		if (drawW<xmax) xmax=drawW;
 
-		for (j=xmin;j<xmax;j+=2)
-		{
-			GetShadeTransCol32((unsigned long *)&psxVuw[(i<<10)+j],lcolor);
-		}
-		if (j==xmax)
-			GetShadeTransCol(&psxVuw[(i<<10)+j],color);
+		ShadeSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,color);
 
 		if (NextRow_F()) return;
 	}
@@ -3132,154 +3346,467 @@ void drawPoly4F(long rgb)
 		xmax=(right_x >> 16)-1;
 		if (drawW<xmax) xmax=drawW;
 
-		for (j=xmin;j<xmax;j+=2)
-		{
-			GetShadeTransCol32((unsigned long *)&psxVuw[(i<<10)+j],lcolor);
-		}
-		if (j==xmax) GetShadeTransCol(&psxVuw[(i<<10)+j],color);
+		ShadeSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,color);
 
 		if (NextRow_F4()) return;
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////
-// POLY 3/4 F-SHADED TEX PAL 4
+// SPAN KERNELS
 ////////////////////////////////////////////////////////////////////////
 
-void drawPoly3TEx4(short x1, short y1, short x2, short y2, short x3, short y3, short tx1, short ty1, short tx2, short ty2, short tx3, short ty3,short clX, short clY)
+// one textured span loop per texel fetch / semi trans / mask / dither
+// combination, picked once per primitive by SelectSpanFT/GT
+
+#define SPAN_TEX4     0
+#define SPAN_TEX4_TW  1
+#define SPAN_TEX8     2
+#define SPAN_TEX8_TW  3
+#define SPAN_TEX15    4                                // YAdjust is the texel base here
+#define SPAN_TEX15_TW 5
+#define SPAN_TEXC     6                                // decoded texels from the cache
+
+////////////////////////////////////////////////////////////////////////
+// TEXTURE CACHE
+////////////////////////////////////////////////////////////////////////
+
+// 4/8 bit textures get expanded through their clut into 256x256 16 bit
+// texels per (page, clut, depth), row by row when a span needs them.
+// Every vram write bumps the generation of the 64x64 tiles it hits, an
+// entry is stale when the sum over its page and clut tiles has moved.
+// Each drawing thread has its own entries, the generations are shared
+// (and used by the display and freezes as well, see VramStamp()), so
+// they only get bumped atomically: a lost bump would keep a stale row.
+
+#define TEXCACHE_ENTRIES 8
+#define TEXCACHE_SHIFT   6
+#define TEXCACHE_TILES   ((1024>>TEXCACHE_SHIFT)*(1024>>TEXCACHE_SHIFT))
+
+typedef struct SOFTTEXCACHETAG
 {
-	int i,j,xmin,xmax,ymin,ymax;
-	long difX, difY,difX2, difY2;
-	long posX,posY,YAdjust,XAdjust;
-	long clutP;
-	short tC1,tC2;
+	long           key;                            // page/clut/depth, -1: free
+	unsigned long  stamp;                          // tile generations it got decoded at
+	unsigned long  used;
+	long           YAdjust,clutP;
+	unsigned char  row[256];                       // row decoded?
+	unsigned short tex[256*256];
+} soft_texcache;
+
+static volatile long texTileGen[TEXCACHE_TILES];
+static GPU_TLS soft_texcache * texCache=NULL;
+static GPU_TLS soft_texcache * texCacheCur=NULL;  // the one of the current prim
+static GPU_TLS unsigned long   texCacheTick=0;
+
+void TexCacheDirty(long x0,long y0,long x1,long y1)
+{
+	long tx,ty;
 
-	if (x1>drawW && x2>drawW && x3>drawW) return;
-	if (y1>drawH && y2>drawH && y3>drawH) return;
-	if (x1<drawX && x2<drawX && x3<drawX) return;
-	if (y1<drawY && y2<drawY && y3<drawY) return;
-	if (drawY>=drawH) return;
-	if (drawX>=drawW) return;
+	if (x1<x0 || y1<y0) return;
+	if (x1>1023 || y1>=iGPUHeight)                     // ran over the edge: it wrapped
+	{
+		x0=y0=0;x1=1023;y1=iGPUHeight-1;
+	}
+	if (x0<0) x0=0;
+	if (y0<0) y0=0;
 
-	if (!SetupSections_FT(x1,y1,x2,y2,x3,y3,tx1,ty1,tx2,ty2,tx3,ty3)) return;
+	for (ty=y0>>TEXCACHE_SHIFT;ty<=(y1>>TEXCACHE_SHIFT);ty++)
+		for (tx=x0>>TEXCACHE_SHIFT;tx<=(x1>>TEXCACHE_SHIFT);tx++)
+			emuAtomicInc(&texTileGen[(ty<<(10-TEXCACHE_SHIFT))+tx]);
+}
 
-	ymax=Ymax;
+void TexCacheFree(void)
+{
+	free(texCache);
+	texCache=texCacheCur=NULL;
+}
 
-	for (ymin=Ymin;ymin<drawY;ymin++)
-		if (NextRow_FT()) return;
+// sum of the tile generations over a vram rect: it moves whenever
+// something got written in there
 
-	clutP=(clY<<10)+clX;
+unsigned long VramStamp(long x0,long y0,long x1,long y1)
+{
+	unsigned long stamp=0;
+	long tx,ty;
 
-	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
+	if (x1>1023 || y1>=iGPUHeight)                     // runs over the edge: all
+	{
+		x0=y0=0;x1=1023;y1=iGPUHeight-1;
+	}
+	if (x0<0) x0=0;
+	if (y0<0) y0=0;
 
-	difX=delta_right_u;
-	difX2=difX<<1;
-	difY=delta_right_v;
-	difY2=difY<<1;
+	for (ty=y0>>TEXCACHE_SHIFT;ty<=(y1>>TEXCACHE_SHIFT);ty++)
+		for (tx=x0>>TEXCACHE_SHIFT;tx<=(x1>>TEXCACHE_SHIFT);tx++)
+			stamp+=(unsigned long)texTileGen[(ty<<(10-TEXCACHE_SHIFT))+tx];
+	return stamp;
+}
 
-#ifdef FASTSOLID
+// copy a whole vram image in (freeze load)... only the tiles which
+// really differ count as written, so after loading a state close to
+// the current one most cached textures and the shown frame stay valid
 
-	if (!bCheckMask && !DrawSemiTrans)
+void VramLoad(const unsigned short * pSrc)
+{
+	long tx,ty,y,o;
+
+	for (ty=0;ty<(iGPUHeight>>TEXCACHE_SHIFT);ty++)
 	{
-		for (i=ymin;i<=ymax;i++)
+		for (tx=0;tx<(1024>>TEXCACHE_SHIFT);tx++)
 		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16)-1; //!!!!!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
+			o=(ty<<(10+TEXCACHE_SHIFT))+(tx<<TEXCACHE_SHIFT);
 
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
+			for (y=0;y<(1<<TEXCACHE_SHIFT);y++,o+=1024)
+				if (memcmp(psxVuw+o,pSrc+o,2<<TEXCACHE_SHIFT)) break;
+			if (y==(1<<TEXCACHE_SHIFT)) continue;             // same tile
 
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
+			for (;y<(1<<TEXCACHE_SHIFT);y++,o+=1024)           // rows above are equal
+				memcpy(psxVuw+o,pSrc+o,2<<TEXCACHE_SHIFT);
 
-				for (j=xmin;j<xmax;j+=2)
-				{
-					XAdjust=(posX>>16);
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					XAdjust=((posX+difX)>>16);
-					tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-					             (XAdjust>>1)];
-					tC2=(tC2>>((XAdjust&1)<<2))&0xf;
+			emuAtomicInc(&texTileGen[(ty<<(10-TEXCACHE_SHIFT))+tx]);
+		}
+	}
+}
 
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        psxVuw[clutP+tC1]|
-					                        ((long)psxVuw[clutP+tC2])<<16);
+static void TexCacheUse(int tex,long clX,long clY)
+{
+	long tw=(tex==SPAN_TEX8)?128:64,cw=(tex==SPAN_TEX8)?256:16;
+	long key;
+	unsigned long stamp;
+	soft_texcache * pC,* pOld;
+	int i;
 
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-				{
-					XAdjust=(posX>>16);
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+
-					             (XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-				}
-			}
-			if (NextRow_FT())
-			{
-				return;
-			}
-		}
-		return;
+	texCacheCur=NULL;
+
+	if (GlobalTextAddrX+tw>1024 || GlobalTextAddrY+256>iGPUHeight || clX+cw>1024) return;
+
+	if (drawX<GlobalTextAddrX+tw && drawW>=GlobalTextAddrX &&  // drawing into our own
+	    drawY<GlobalTextAddrY+256 && drawH>=GlobalTextAddrY) return; // texture or clut: no cache
+	if (drawX<clX+cw && drawW>=clX && drawY<=clY && drawH>=clY) return;
+
+	if (!texCache)
+	{
+		texCache=(soft_texcache *)malloc(TEXCACHE_ENTRIES*sizeof(soft_texcache));
+		if (!texCache) return;
+		for (i=0;i<TEXCACHE_ENTRIES;i++) {texCache[i].key=-1;texCache[i].used=0;}
 	}
 
-#endif
+	key=(GlobalTextAddrY<<21)|(clY<<11)|((clX>>4)<<5)|((GlobalTextAddrX>>6)<<1)|(tex==SPAN_TEX8);
+	stamp=VramStamp(GlobalTextAddrX,GlobalTextAddrY,GlobalTextAddrX+tw-1,GlobalTextAddrY+255)+
+	      VramStamp(clX,clY,clX+cw-1,clY);
 
-	for (i=ymin;i<=ymax;i++)
+	pC=pOld=texCache;
+	for (i=0;i<TEXCACHE_ENTRIES;i++,pC++)
 	{
-		xmin=(left_x >> 16);
-		xmax=(right_x >> 16)-1; //!!!!!!!!!!!!!!!!!!
-		if (drawW<xmax) xmax=drawW;
+		if (pC->key==key) break;
+		if (pC->used<pOld->used) pOld=pC;
+	}
 
-		if (xmax>=xmin)
-		{
-			posX=left_u;
-			posY=left_v;
+	if (i==TEXCACHE_ENTRIES || pC->stamp!=stamp)
+	{
+		if (i==TEXCACHE_ENTRIES) pC=pOld;
+		pC->key=key;
+		pC->stamp=stamp;
+		pC->YAdjust=(GlobalTextAddrY<<11)+(GlobalTextAddrX<<1);
+		pC->clutP=(clY<<10)+clX;
+		memset(pC->row,0,sizeof(pC->row));
+	}
 
-			if (xmin<drawX)
+	pC->used=++texCacheTick;
+	texCacheCur=pC;
+}
+
+static void TexCacheRow(soft_texcache * pC,long v)
+{
+	unsigned short * pT=&pC->tex[v<<8];
+	unsigned short * pL=&psxVuw[pC->clutP];
+	unsigned char  * pS=&psxVub[(v<<11)+pC->YAdjust];
+	int u;
+
+	if (pC->key&1)
+		for (u=0;u<256;u++) pT[u]=pL[pS[u]];
+	else
+	{
+		for (u=0;u<256;u+=2,pS++)
+		{
+			pT[u]  =pL[*pS&0xf];
+			pT[u+1]=pL[*pS>>4];
+		}
+	}
+	pC->row[v]=1;
+}
+
+// texels for a whole span, if it stays inside the page
+
+static __inline const unsigned short * TexCacheSpan(int n,long posX,long posY,long difX,long difY)
+{
+	soft_texcache * pC=texCacheCur;
+	long u0,u1,v0,v1,v;
+
+	if (!pC) return NULL;
+	if (difX>=(1<<20) || difX<=-(1<<20) || difY>=(1<<20) || difY<=-(1<<20)) return NULL;
+
+	u0=posX>>16;v0=posY>>16;
+	if (u0<0 || u0>255 || v0<0 || v0>255) return NULL;
+	u1=(posX+(n-1)*difX)>>16;v1=(posY+(n-1)*difY)>>16;
+	if (u1<0 || u1>255 || v1<0 || v1>255) return NULL;
+
+	if (v0>v1) {v=v0;v0=v1;v1=v;}
+	for (v=v0;v<=v1;v++)
+		if (!pC->row[v]) TexCacheRow(pC,v);
+
+	return pC->tex;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+typedef void (*soft_span_ft)(unsigned short * pdest,int n,long posX,long posY,long difX,long difY,long YAdjust,long clutP);
+typedef void (*soft_span_gt)(unsigned short * pdest,int n,long posX,long posY,long difX,long difY,long cR1,long cG1,long cB1,long difR,long difG,long difB,long YAdjust,long clutP);
+
+static __inline unsigned short SpanTexel(int tex,long posX,long posY,long YAdjust,long clutP,const unsigned short * pc,int twx,int twy)
+{
+	long XAdjust;
+	unsigned char tC;
+
+	switch (tex)
+	{
+		case SPAN_TEX4:
+			XAdjust=(posX>>16);
+			tC=psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
+			return psxVuw[clutP+((tC>>((XAdjust&1)<<2))&0xf)];
+		case SPAN_TEX4_TW:
+			XAdjust=(posX>>16)%twx;
+			tC=psxVub[(((posY>>16)%twy)<<11)+YAdjust+(XAdjust>>1)];
+			return psxVuw[clutP+((tC>>((XAdjust&1)<<2))&0xf)];
+		case SPAN_TEX8:
+			return psxVuw[clutP+psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)]];
+		case SPAN_TEX8_TW:
+			return psxVuw[clutP+psxVub[(((posY>>16)%twy)<<11)+YAdjust+((posX>>16)%twx)]];
+		case SPAN_TEX15:
+			return psxVuw[((posY>>16)<<10)+(posX>>16)+YAdjust];
+		case SPAN_TEXC:
+			return pc[((posY>>16)<<8)+(posX>>16)];
+		default:
+			return psxVuw[(((posY>>16)%twy)<<10)+((posX>>16)%twx)+YAdjust];
+	}
+}
+
+// does a span draw over its own texels or clut? then texels must be
+// read pairwise, right after the pixels before them got written
+
+static __inline int SpanSelfRead(unsigned short * pdest,int n,long YAdjust,long clutP,int tex)
+{
+	long d=pdest-psxVuw,tx,ty,tw;
+
+	if (tex==SPAN_TEXC) return 0;                      // the cache is never drawn over
+
+	if (tex>=SPAN_TEX15)
+	{
+		ty=YAdjust>>10;tx=YAdjust&1023;tw=256;
+	}
+	else
+	{
+		ty=YAdjust>>11;tx=(YAdjust&2047)>>1;tw=(tex<=SPAN_TEX4_TW)?64:128;
+		if (d<clutP+((tex<=SPAN_TEX4_TW)?16:256) && d+n>clutP) return 1;
+	}
+
+	if (tx+tw>1024) return 1;
+	return (d>>10)>=ty && (d>>10)<ty+256 && (d&1023)<tx+tw && (d&1023)+n>tx;
+}
+
+static __inline void SpanFT(unsigned short * pdest,int n,long posX,long posY,long difX,long difY,long YAdjust,long clutP,
+                            const unsigned short * pc,int tex,int st,int mk)
+{
+	long difX2=difX<<1,difY2=difY<<1;
+	int  twx=TWin.Position.x1,twy=TWin.Position.y1;
+	int  j=0;
+
+#ifdef ENABLE_SSE2
+	if (n>=8 && !SpanSelfRead(pdest,n,YAdjust,clutP,tex))
+	{
+		__m128i m1=_mm_set1_epi16(g_m1),m2=_mm_set1_epi16(g_m2),m3=_mm_set1_epi16(g_m3);
+		__m128i sm=_mm_set1_epi16((short)sSetMask),d;
+		unsigned short tx[8];
+		int k;
+
+		for (;j+8<=(n&~1);j+=8)
+		{
+			for (k=0;k<8;k++)
 			{
-				j=drawX-xmin;
-				xmin=drawX;
-				posX+=j*difX;
-				posY+=j*difY;
+				tx[k]=SpanTexel(tex,posX,posY,YAdjust,clutP,pc,twx,twy);
+				posX+=difX;
+				posY+=difY;
 			}
+			d=_mm_loadu_si128((__m128i *)&pdest[j]);
+			_mm_storeu_si128((__m128i *)&pdest[j],
+			                 SSETexBlend(d,_mm_loadu_si128((__m128i *)tx),st,mk,m1,m2,m3,sm));
+		}
+	}
+#endif
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				XAdjust=(posX>>16);
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				XAdjust=((posX+difX)>>16);
-				tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-				             (XAdjust>>1)];
-				tC2=(tC2>>((XAdjust&1)<<2))&0xf;
+	for (;j<n-1;j+=2)
+	{
+		TexTransColG32((unsigned long *)&pdest[j],
+		               SpanTexel(tex,posX,posY,YAdjust,clutP,pc,twx,twy)|
+		               ((long)SpanTexel(tex,posX+difX,posY+difY,YAdjust,clutP,pc,twx,twy))<<16,st,mk);
+		posX+=difX2;
+		posY+=difY2;
+	}
+	if (j==n-1)
+		TexTransColG(&pdest[j],SpanTexel(tex,posX,posY,YAdjust,clutP,pc,twx,twy),st,mk);
+}
 
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      psxVuw[clutP+tC1]|
-				                      ((long)psxVuw[clutP+tC2])<<16);
+static __inline void SpanGT(unsigned short * pdest,int n,long posX,long posY,long difX,long difY,long cR1,long cG1,long cB1,long difR,long difG,long difB,long YAdjust,long clutP,
+                            const unsigned short * pc,int tex,int st,int mk,int dt)
+{
+	int  twx=TWin.Position.x1,twy=TWin.Position.y1;
+	int  j;
 
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
+#ifdef FASTSOLID
+
+	if (!st && !mk && !dt)                              // opaque: two pixels at once
+	{
+		for (j=0;j<n-1;j+=2)
+		{
+			GetTextureTransColGX32_S((unsigned long *)&pdest[j],
+			                         SpanTexel(tex,posX,posY,YAdjust,clutP,pc,twx,twy)|
+			                         ((long)SpanTexel(tex,posX+difX,posY+difY,YAdjust,clutP,pc,twx,twy))<<16,
+			                         (cB1>>16)|((cB1+difB)&0xff0000),
+			                         (cG1>>16)|((cG1+difG)&0xff0000),
+			                         (cR1>>16)|((cR1+difR)&0xff0000));
+			posX+=difX<<1;
+			posY+=difY<<1;
+			cR1+=difR<<1;
+			cG1+=difG<<1;
+			cB1+=difB<<1;
+		}
+		if (j==n-1)
+			GetTextureTransColGX_S(&pdest[j],SpanTexel(tex,posX,posY,YAdjust,clutP,pc,twx,twy),
+			                       (cB1>>16),(cG1>>16),(cR1>>16));
+		return;
+	}
+
+#endif
+
+	for (j=0;j<n;j++)
+	{
+		if (dt)
+			TexTransColGX_Dither(&pdest[j],SpanTexel(tex,posX,posY,YAdjust,clutP,pc,twx,twy),
+			                     (cB1>>16),(cG1>>16),(cR1>>16),st,mk);
+		else
+			TexTransColGX(&pdest[j],SpanTexel(tex,posX,posY,YAdjust,clutP,pc,twx,twy),
+			              (cB1>>16),(cG1>>16),(cR1>>16),st,mk);
+		posX+=difX;
+		posY+=difY;
+		cR1+=difR;
+		cG1+=difG;
+		cB1+=difB;
+	}
+}
+
+#define SPAN_FT(t,s,m) \
+static void SpanFT_##t##_##s##_##m(unsigned short * pdest,int n,long posX,long posY,long difX,long difY,long YAdjust,long clutP) \
+{ const unsigned short * pc=(t==SPAN_TEX4 || t==SPAN_TEX8)?TexCacheSpan(n,posX,posY,difX,difY):NULL; \
+  if (pc) SpanFT(pdest,n,posX,posY,difX,difY,YAdjust,clutP,pc,SPAN_TEXC,s,m); \
+  else    SpanFT(pdest,n,posX,posY,difX,difY,YAdjust,clutP,NULL,t,s,m); }
+
+#define SPAN_GT(t,s,m,d) \
+static void SpanGT_##t##_##s##_##m##_##d(unsigned short * pdest,int n,long posX,long posY,long difX,long difY,long cR1,long cG1,long cB1,long difR,long difG,long difB,long YAdjust,long clutP) \
+{ const unsigned short * pc=(t==SPAN_TEX4 || t==SPAN_TEX8)?TexCacheSpan(n,posX,posY,difX,difY):NULL; \
+  if (pc) SpanGT(pdest,n,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,clutP,pc,SPAN_TEXC,s,m,d); \
+  else    SpanGT(pdest,n,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,clutP,NULL,t,s,m,d); }
+
+#define SPAN_FT_M(t,s)   SPAN_FT(t,s,0) SPAN_FT(t,s,1)
+#define SPAN_FT_S(t)     SPAN_FT_M(t,0) SPAN_FT_M(t,1) SPAN_FT_M(t,2) SPAN_FT_M(t,3) SPAN_FT_M(t,4)
+#define SPAN_GT_D(t,s,m) SPAN_GT(t,s,m,0) SPAN_GT(t,s,m,1)
+#define SPAN_GT_M(t,s)   SPAN_GT_D(t,s,0) SPAN_GT_D(t,s,1)
+#define SPAN_GT_S(t)     SPAN_GT_M(t,0) SPAN_GT_M(t,1) SPAN_GT_M(t,2) SPAN_GT_M(t,3) SPAN_GT_M(t,4)
+
+SPAN_FT_S(0) SPAN_FT_S(1) SPAN_FT_S(2) SPAN_FT_S(3) SPAN_FT_S(4) SPAN_FT_S(5)
+SPAN_GT_S(0) SPAN_GT_S(1) SPAN_GT_S(2) SPAN_GT_S(3) SPAN_GT_S(4) SPAN_GT_S(5)
+
+#define SPAN_FT_ROW(t,s)   {SpanFT_##t##_##s##_0,SpanFT_##t##_##s##_1}
+#define SPAN_FT_TAB(t)     {SPAN_FT_ROW(t,0),SPAN_FT_ROW(t,1),SPAN_FT_ROW(t,2),SPAN_FT_ROW(t,3),SPAN_FT_ROW(t,4)}
+#define SPAN_GT_ROW(t,s,m) {SpanGT_##t##_##s##_##m##_0,SpanGT_##t##_##s##_##m##_1}
+#define SPAN_GT_MSK(t,s)   {SPAN_GT_ROW(t,s,0),SPAN_GT_ROW(t,s,1)}
+#define SPAN_GT_TAB(t)     {SPAN_GT_MSK(t,0),SPAN_GT_MSK(t,1),SPAN_GT_MSK(t,2),SPAN_GT_MSK(t,3),SPAN_GT_MSK(t,4)}
+
+static const soft_span_ft spanFT[6][5][2]=
+{
+	SPAN_FT_TAB(0),SPAN_FT_TAB(1),SPAN_FT_TAB(2),SPAN_FT_TAB(3),SPAN_FT_TAB(4),SPAN_FT_TAB(5)
+};
+
+static const soft_span_gt spanGT[6][5][2][2]=
+{
+	SPAN_GT_TAB(0),SPAN_GT_TAB(1),SPAN_GT_TAB(2),SPAN_GT_TAB(3),SPAN_GT_TAB(4),SPAN_GT_TAB(5)
+};
+
+__inline soft_span_ft SelectSpanFT(int tex)
+{
+	return spanFT[tex][SPAN_SEMI][bCheckMask?1:0];
+}
+
+__inline soft_span_gt SelectSpanGT(int tex)
+{
+	return spanGT[tex][SPAN_SEMI][bCheckMask?1:0][iDither?1:0];
+}
+
+////////////////////////////////////////////////////////////////////////
+// POLY 3/4 F-SHADED TEX PAL 4
+////////////////////////////////////////////////////////////////////////
+
+void drawPoly3TEx4(short x1, short y1, short x2, short y2, short x3, short y3, short tx1, short ty1, short tx2, short ty2, short tx3, short ty3,short clX, short clY)
+{
+	int i,j,xmin,xmax,ymin,ymax;
+	long difX, difY;
+	long posX,posY,YAdjust;
+	long clutP;
+	soft_span_ft pSpan;
+
+	if (x1>drawW && x2>drawW && x3>drawW) return;
+	if (y1>drawH && y2>drawH && y3>drawH) return;
+	if (x1<drawX && x2<drawX && x3<drawX) return;
+	if (y1<drawY && y2<drawY && y3<drawY) return;
+	if (drawY>=drawH) return;
+	if (drawX>=drawW) return;
+
+	if (!SetupSections_FT(x1,y1,x2,y2,x3,y3,tx1,ty1,tx2,ty2,tx3,ty3)) return;
+
+	ymax=Ymax;
+
+	for (ymin=Ymin;ymin<drawY;ymin++)
+		if (NextRow_FT()) return;
+
+	clutP=(clY<<10)+clX;
+
+	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
+
+	difX=delta_right_u;
+	difY=delta_right_v;
+
+	pSpan=SelectSpanFT(SPAN_TEX4);
+	TexCacheUse(SPAN_TEX4,clX,clY);
+
+	for (i=ymin;i<=ymax;i++)
+	{
+		xmin=(left_x >> 16);
+		xmax=(right_x >> 16)-1; //!!!!!!!!!!!!!!!!!!
+		if (drawW<xmax) xmax=drawW;
+
+		if (xmax>=xmin)
+		{
+			posX=left_u;
+			posY=left_v;
+
+			if (xmin<drawX)
 			{
-				XAdjust=(posX>>16);
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+
-				             (XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				GetTextureTransColG(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
+				j=drawX-xmin;
+				xmin=drawX;
+				posX+=j*difX;
+				posY+=j*difY;
 			}
+
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,clutP);
 		}
 		if (NextRow_FT())
 		{
@@ -3461,10 +3988,10 @@ void drawPoly3TEx4_IL(short x1, short y1, short x2, short y2, short x3, short y3
 void drawPoly3TEx4_TW(short x1, short y1, short x2, short y2, short x3, short y3, short tx1, short ty1, short tx2, short ty2, short tx3, short ty3,short clX, short clY)
 {
 	int i,j,xmin,xmax,ymin,ymax;
-	long difX, difY,difX2, difY2;
-	long posX,posY,YAdjust,XAdjust;
+	long difX, difY;
+	long posX,posY,YAdjust;
 	long clutP;
-	short tC1,tC2;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -3486,71 +4013,9 @@ void drawPoly3TEx4_TW(short x1, short y1, short x2, short y2, short x3, short y3
 	YAdjust+=(TWin.Position.y0<<11)+(TWin.Position.x0>>1);
 
 	difX=delta_right_u;
-	difX2=difX<<1;
 	difY=delta_right_v;
-	difY2=difY<<1;
 
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);//-1; //!!!!!!!!!!!!!!!!
-			if (xmax>xmin) xmax--;
-
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					XAdjust=(posX>>16)%TWin.Position.x1;
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					XAdjust=((posX+difX)>>16)%TWin.Position.x1;
-					tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        psxVuw[clutP+tC1]|
-					                        ((long)psxVuw[clutP+tC2])<<16);
-
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-				{
-					XAdjust=(posX>>16)%TWin.Position.x1;
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-				}
-			}
-			if (NextRow_FT())
-			{
-				return;
-			}
-		}
-		return;
-	}
-
-#endif
+	pSpan=SelectSpanFT(SPAN_TEX4_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -3571,32 +4036,7 @@ void drawPoly3TEx4_TW(short x1, short y1, short x2, short y2, short x3, short y3
 				posY+=j*difY;
 			}
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				XAdjust=(posX>>16)%TWin.Position.x1;
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				XAdjust=((posX+difX)>>16)%TWin.Position.x1;
-				tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(XAdjust>>1)];
-				tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      psxVuw[clutP+tC1]|
-				                      ((long)psxVuw[clutP+tC2])<<16);
-
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-			{
-				XAdjust=(posX>>16)%TWin.Position.x1;
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				GetTextureTransColG(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,clutP);
 		}
 		if (NextRow_FT())
 		{
@@ -3627,91 +4067,30 @@ void drawPoly4TEx4(short x1, short y1, short x2, short y2, short x3, short y3, s
 {
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
-	long difX, difY, difX2, difY2;
-	long posX,posY,YAdjust,clutP,XAdjust;
-	short tC1,tC2;
+	long difX, difY;
+	long posX,posY,YAdjust,clutP;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
 	if (x1<drawX && x2<drawX && x3<drawX && x4<drawX) return;
-	if (y1<drawY && y2<drawY && y3<drawY && y4<drawY) return;
-	if (drawY>=drawH) return;
-	if (drawX>=drawW) return;
-
-	if (!SetupSections_FT4(x1,y1,x2,y2,x3,y3,x4,y4,tx1,ty1,tx2,ty2,tx3,ty3,tx4,ty4)) return;
-
-	ymax=Ymax;
-
-	for (ymin=Ymin;ymin<drawY;ymin++)
-		if (NextRow_FT4()) return;
-
-	clutP=(clY<<10)+clX;
-
-	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					XAdjust=(posX>>16);
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					XAdjust=((posX+difX)>>16);
-					tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-					             (XAdjust>>1)];
-					tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        psxVuw[clutP+tC1]|
-					                        ((long)psxVuw[clutP+tC2])<<16);
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-				{
-					XAdjust=(posX>>16);
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+
-					             (XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-				}
+	if (y1<drawY && y2<drawY && y3<drawY && y4<drawY) return;
+	if (drawY>=drawH) return;
+	if (drawX>=drawW) return;
 
-			}
-			if (NextRow_FT4()) return;
-		}
-		return;
-	}
+	if (!SetupSections_FT4(x1,y1,x2,y2,x3,y3,x4,y4,tx1,ty1,tx2,ty2,tx3,ty3,tx4,ty4)) return;
 
-#endif
+	ymax=Ymax;
+
+	for (ymin=Ymin;ymin<drawY;ymin++)
+		if (NextRow_FT4()) return;
+
+	clutP=(clY<<10)+clX;
+
+	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
+
+	pSpan=SelectSpanFT(SPAN_TEX4);
+	TexCacheUse(SPAN_TEX4,clX,clY);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -3727,8 +4106,6 @@ void drawPoly4TEx4(short x1, short y1, short x2, short y2, short x3, short y3, s
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			if (xmin<drawX)
 			{
@@ -3740,30 +4117,7 @@ void drawPoly4TEx4(short x1, short y1, short x2, short y2, short x3, short y3, s
 			xmax--;
 			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				XAdjust=(posX>>16);
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				XAdjust=((posX+difX)>>16);
-				tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-				             (XAdjust>>1)];
-				tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      psxVuw[clutP+tC1]|
-				                      ((long)psxVuw[clutP+tC2])<<16);
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-			{
-				XAdjust=(posX>>16);
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+
-				             (XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				GetTextureTransColG(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,clutP);
 		}
 		if (NextRow_FT4()) return;
 	}
@@ -3946,9 +4300,9 @@ void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, short y3
 {
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
-	long difX, difY, difX2, difY2;
-	long posX,posY,YAdjust,clutP,XAdjust;
-	short tC1,tC2;
+	long difX, difY;
+	long posX,posY,YAdjust,clutP;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -3969,69 +4323,7 @@ void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, short y3
 	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
 	YAdjust+=(TWin.Position.y0<<11)+(TWin.Position.x0>>1);
 
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					XAdjust=(posX>>16)%TWin.Position.x1;
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					XAdjust=((posX+difX)>>16)%TWin.Position.x1;
-					tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        psxVuw[clutP+tC1]|
-					                        ((long)psxVuw[clutP+tC2])<<16);
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-				{
-					XAdjust=(posX>>16)%TWin.Position.x1;
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-				}
-			}
-			if (NextRow_FT4()) return;
-		}
-		return;
-	}
-
-#endif
+	pSpan=SelectSpanFT(SPAN_TEX4_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -4047,8 +4339,6 @@ void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, short y3
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			if (xmin<drawX)
 			{
@@ -4060,31 +4350,7 @@ void drawPoly4TEx4_TW(short x1, short y1, short x2, short y2, short x3, short y3
 			xmax--;
 			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				XAdjust=(posX>>16)%TWin.Position.x1;
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				XAdjust=((posX+difX)>>16)%TWin.Position.x1;
-				tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(XAdjust>>1)];
-				tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      psxVuw[clutP+tC1]|
-				                      ((long)psxVuw[clutP+tC2])<<16);
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-			{
-				XAdjust=(posX>>16)%TWin.Position.x1;
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				GetTextureTransColG(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,clutP);
 		}
 		if (NextRow_FT4()) return;
 	}
@@ -4246,9 +4512,9 @@ void drawPoly4TEx4_TW_S(short x1, short y1, short x2, short y2, short x3, short
 void drawPoly3TEx8(short x1, short y1, short x2, short y2, short x3, short y3, short tx1, short ty1, short tx2, short ty2, short tx3, short ty3,short clX, short clY)
 {
 	int i,j,xmin,xmax,ymin,ymax;
-	long difX, difY,difX2, difY2;
+	long difX, difY;
 	long posX,posY,YAdjust,clutP;
-	short tC1,tC2;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -4269,60 +4535,10 @@ void drawPoly3TEx8(short x1, short y1, short x2, short y2, short x3, short y3, s
 	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
 
 	difX=delta_right_u;
-	difX2=difX<<1;
 	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16)-1; //!!!!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-					tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-					             ((posX+difX)>>16)];
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        psxVuw[clutP+tC1]|
-					                        ((long)psxVuw[clutP+tC2])<<16);
-					posX+=difX2;
-					posY+=difY2;
-				}
-
-				if (j==xmax)
-				{
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-				}
-			}
-			if (NextRow_FT())
-			{
-				return;
-			}
-		}
-		return;
-	}
 
-#endif
+	pSpan=SelectSpanFT(SPAN_TEX8);
+	TexCacheUse(SPAN_TEX8,clX,clY);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -4343,23 +4559,7 @@ void drawPoly3TEx8(short x1, short y1, short x2, short y2, short x3, short y3, s
 				posY+=j*difY;
 			}
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-				tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-				             ((posX+difX)>>16)];
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      psxVuw[clutP+tC1]|
-				                      ((long)psxVuw[clutP+tC2])<<16);
-				posX+=difX2;
-				posY+=difY2;
-			}
-
-			if (j==xmax)
-			{
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-				GetTextureTransColG(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,clutP);
 
 		}
 		if (NextRow_FT())
@@ -4536,9 +4736,9 @@ void drawPoly3TEx8_IL(short x1, short y1, short x2, short y2, short x3, short y3
 void drawPoly3TEx8_TW(short x1, short y1, short x2, short y2, short x3, short y3, short tx1, short ty1, short tx2, short ty2, short tx3, short ty3,short clX, short clY)
 {
 	int i,j,xmin,xmax,ymin,ymax;
-	long difX, difY,difX2, difY2;
+	long difX, difY;
 	long posX,posY,YAdjust,clutP;
-	short tC1,tC2;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -4557,67 +4757,12 @@ void drawPoly3TEx8_TW(short x1, short y1, short x2, short y2, short x3, short y3
 	clutP=(clY<<10)+clX;
 
 	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
-	YAdjust+=(TWin.Position.y0<<11)+(TWin.Position.x0);
-
-	difX=delta_right_u;
-	difX2=difX<<1;
-	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);//-1; //!!!!!!!!!!!!!!!!
-			if (xmax>xmin) xmax--;
-
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+((posX>>16)%TWin.Position.x1)];
-					tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(((posX+difX)>>16)%TWin.Position.x1)];
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        psxVuw[clutP+tC1]|
-					                        ((long)psxVuw[clutP+tC2])<<16);
-					posX+=difX2;
-					posY+=difY2;
-				}
-
-				if (j==xmax)
-				{
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+((posX>>16)%TWin.Position.x1)];
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-				}
-			}
-			if (NextRow_FT())
-			{
-				return;
-			}
-		}
-		return;
-	}
+	YAdjust+=(TWin.Position.y0<<11)+(TWin.Position.x0);
 
-#endif
+	difX=delta_right_u;
+	difY=delta_right_v;
+
+	pSpan=SelectSpanFT(SPAN_TEX8_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -4638,25 +4783,7 @@ void drawPoly3TEx8_TW(short x1, short y1, short x2, short y2, short x3, short y3
 				posY+=j*difY;
 			}
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+((posX>>16)%TWin.Position.x1)];
-				tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(((posX+difX)>>16)%TWin.Position.x1)];
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      psxVuw[clutP+tC1]|
-				                      ((long)psxVuw[clutP+tC2])<<16);
-				posX+=difX2;
-				posY+=difY2;
-			}
-
-			if (j==xmax)
-			{
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+((posX>>16)%TWin.Position.x1)];
-				GetTextureTransColG(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,clutP);
 
 		}
 		if (NextRow_FT())
@@ -4689,9 +4816,9 @@ void drawPoly4TEx8(short x1, short y1, short x2, short y2, short x3, short y3, s
 {
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
-	long difX, difY, difX2, difY2;
+	long difX, difY;
 	long posX,posY,YAdjust,clutP;
-	short tC1,tC2;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -4711,60 +4838,8 @@ void drawPoly4TEx8(short x1, short y1, short x2, short y2, short x3, short y3, s
 
 	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
 
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-					tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-					             ((posX+difX)>>16)];
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        psxVuw[clutP+tC1]|
-					                        ((long)psxVuw[clutP+tC2])<<16);
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-				{
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-				}
-			}
-			if (NextRow_FT4()) return;
-		}
-		return;
-	}
-
-#endif
+	pSpan=SelectSpanFT(SPAN_TEX8);
+	TexCacheUse(SPAN_TEX8,clX,clY);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -4780,8 +4855,6 @@ void drawPoly4TEx8(short x1, short y1, short x2, short y2, short x3, short y3, s
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			if (xmin<drawX)
 			{
@@ -4793,22 +4866,7 @@ void drawPoly4TEx8(short x1, short y1, short x2, short y2, short x3, short y3, s
 			xmax--;
 			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-				tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-				             ((posX+difX)>>16)];
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      psxVuw[clutP+tC1]|
-				                      ((long)psxVuw[clutP+tC2])<<16);
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-			{
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-				GetTextureTransColG(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,clutP);
 		}
 		if (NextRow_FT4()) return;
 	}
@@ -4983,9 +5041,9 @@ void drawPoly4TEx8_TW(short x1, short y1, short x2, short y2, short x3, short y3
 {
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
-	long difX, difY, difX2, difY2;
+	long difX, difY;
 	long posX,posY,YAdjust,clutP;
-	short tC1,tC2;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -5006,63 +5064,7 @@ void drawPoly4TEx8_TW(short x1, short y1, short x2, short y2, short x3, short y3
 	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
 	YAdjust+=(TWin.Position.y0<<11)+(TWin.Position.x0);
 
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+((posX>>16)%TWin.Position.x1)];
-					tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(((posX+difX)>>16)%TWin.Position.x1)];
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        psxVuw[clutP+tC1]|
-					                        ((long)psxVuw[clutP+tC2])<<16);
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-				{
-					tC1 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+((posX>>16)%TWin.Position.x1)];
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-				}
-			}
-			if (NextRow_FT4()) return;
-		}
-		return;
-	}
-
-#endif
-
+	pSpan=SelectSpanFT(SPAN_TEX8_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -5078,8 +5080,6 @@ void drawPoly4TEx8_TW(short x1, short y1, short x2, short y2, short x3, short y3
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			if (xmin<drawX)
 			{
@@ -5091,24 +5091,7 @@ void drawPoly4TEx8_TW(short x1, short y1, short x2, short y2, short x3, short y3
 			xmax--;
 			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+((posX>>16)%TWin.Position.x1)];
-				tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(((posX+difX)>>16)%TWin.Position.x1)];
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      psxVuw[clutP+tC1]|
-				                      ((long)psxVuw[clutP+tC2])<<16);
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-			{
-				tC1 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+((posX>>16)%TWin.Position.x1)];
-				GetTextureTransColG(&psxVuw[(i<<10)+j],psxVuw[clutP+tC1]);
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,clutP);
 		}
 		if (NextRow_FT4()) return;
 	}
@@ -5258,8 +5241,9 @@ void drawPoly4TEx8_TW_S(short x1, short y1, short x2, short y2, short x3, short
 void drawPoly3TD(short x1, short y1, short x2, short y2, short x3, short y3, short tx1, short ty1, short tx2, short ty2, short tx3, short ty3)
 {
 	int i,j,xmin,xmax,ymin,ymax;
-	long difX, difY,difX2, difY2;
-	long posX,posY;
+	long difX, difY;
+	long posX,posY,YAdjust;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -5276,55 +5260,11 @@ void drawPoly3TD(short x1, short y1, short x2, short y2, short x3, short y3, sho
 		if (NextRow_FT()) return;
 
 	difX=delta_right_u;
-	difX2=difX<<1;
 	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16)-1; //!!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        (((long)psxVuw[((((posY+difY)>>16)+GlobalTextAddrY)<<10)+((posX+difX)>>16)+GlobalTextAddrX])<<16)|
-					                        psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+((posX)>>16)+GlobalTextAddrX]);
 
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],
-					                      psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]);
-			}
-			if (NextRow_FT())
-			{
-				return;
-			}
-		}
-		return;
-	}
+	YAdjust=(GlobalTextAddrY<<10)+GlobalTextAddrX;
 
-#endif
+	pSpan=SelectSpanFT(SPAN_TEX15);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -5345,18 +5285,7 @@ void drawPoly3TD(short x1, short y1, short x2, short y2, short x3, short y3, sho
 				posY+=j*difY;
 			}
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      (((long)psxVuw[((((posY+difY)>>16)+GlobalTextAddrY)<<10)+((posX+difX)>>16)+GlobalTextAddrX])<<16)|
-				                      psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+((posX)>>16)+GlobalTextAddrX]);
-
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-				GetTextureTransColG(&psxVuw[(i<<10)+j],
-				                    psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]);
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,0);
 		}
 		if (NextRow_FT())
 		{
@@ -5370,8 +5299,9 @@ void drawPoly3TD(short x1, short y1, short x2, short y2, short x3, short y3, sho
 void drawPoly3TD_TW(short x1, short y1, short x2, short y2, short x3, short y3, short tx1, short ty1, short tx2, short ty2, short tx3, short ty3)
 {
 	int i,j,xmin,xmax,ymin,ymax;
-	long difX, difY,difX2, difY2;
-	long posX,posY;
+	long difX, difY;
+	long posX,posY,YAdjust;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -5387,59 +5317,12 @@ void drawPoly3TD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 	for (ymin=Ymin;ymin<drawY;ymin++)
 		if (NextRow_FT()) return;
 
-	difX=delta_right_u;
-	difX2=difX<<1;
-	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16)-1; //!!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        (((long)psxVuw[(((((posY+difY)>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                                       (((posX+difX)>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0])<<16)|
-					                        psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                               (((posX)>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0]);
+	difX=delta_right_u;
+	difY=delta_right_v;
 
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],
-					                      psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                             ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0]);
-			}
-			if (NextRow_FT())
-			{
-				return;
-			}
-		}
-		return;
-	}
+	YAdjust=((GlobalTextAddrY+TWin.Position.y0)<<10)+GlobalTextAddrX+TWin.Position.x0;
 
-#endif
+	pSpan=SelectSpanFT(SPAN_TEX15_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -5460,21 +5343,7 @@ void drawPoly3TD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 				posY+=j*difY;
 			}
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      (((long)psxVuw[(((((posY+difY)>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-				                                     (((posX+difX)>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0])<<16)|
-				                      psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-				                             (((posX)>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0]);
-
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-				GetTextureTransColG(&psxVuw[(i<<10)+j],
-				                    psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-				                           ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0]);
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,0);
 		}
 		if (NextRow_FT())
 		{
@@ -5504,8 +5373,9 @@ void drawPoly4TD(short x1, short y1, short x2, short y2, short x3, short y3, sho
 {
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
-	long difX, difY, difX2, difY2;
-	long posX,posY;
+	long difX, difY;
+	long posX,posY,YAdjust;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -5521,56 +5391,9 @@ void drawPoly4TD(short x1, short y1, short x2, short y2, short x3, short y3, sho
 	for (ymin=Ymin;ymin<drawY;ymin++)
 		if (NextRow_FT4()) return;
 
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        (((long)psxVuw[((((posY+difY)>>16)+GlobalTextAddrY)<<10)+((posX+difX)>>16)+GlobalTextAddrX])<<16)|
-					                        psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+((posX)>>16)+GlobalTextAddrX]);
-
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],
-					                      psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]);
-			}
-			if (NextRow_FT4()) return;
-		}
-		return;
-	}
+	YAdjust=(GlobalTextAddrY<<10)+GlobalTextAddrX;
 
-#endif
+	pSpan=SelectSpanFT(SPAN_TEX15);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -5586,8 +5409,6 @@ void drawPoly4TD(short x1, short y1, short x2, short y2, short x3, short y3, sho
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			if (xmin<drawX)
 			{
@@ -5599,18 +5420,7 @@ void drawPoly4TD(short x1, short y1, short x2, short y2, short x3, short y3, sho
 			xmax--;
 			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      (((long)psxVuw[((((posY+difY)>>16)+GlobalTextAddrY)<<10)+((posX+difX)>>16)+GlobalTextAddrX])<<16)|
-				                      psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+((posX)>>16)+GlobalTextAddrX]);
-
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-				GetTextureTransColG(&psxVuw[(i<<10)+j],
-				                    psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX]);
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,0);
 		}
 		if (NextRow_FT4()) return;
 	}
@@ -5622,8 +5432,9 @@ void drawPoly4TD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 {
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
-	long difX, difY, difX2, difY2;
-	long posX,posY;
+	long difX, difY;
+	long posX,posY,YAdjust;
+	soft_span_ft pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -5639,59 +5450,9 @@ void drawPoly4TD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 	for (ymin=Ymin;ymin<drawY;ymin++)
 		if (NextRow_FT4()) return;
 
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					GetTextureTransColG32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                        (((long)psxVuw[(((((posY+difY)>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                                       (((posX+difX)>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0])<<16)|
-					                        psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY)<<10)+TWin.Position.y0+
-					                               ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0]);
-
-					posX+=difX2;
-					posY+=difY2;
-				}
-				if (j==xmax)
-					GetTextureTransColG_S(&psxVuw[(i<<10)+j],
-					                      psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                             ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0]);
-			}
-			if (NextRow_FT4()) return;
-		}
-		return;
-	}
+	YAdjust=((GlobalTextAddrY+TWin.Position.y0)<<10)+GlobalTextAddrX+TWin.Position.x0;
 
-#endif
+	pSpan=SelectSpanFT(SPAN_TEX15_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -5707,8 +5468,6 @@ void drawPoly4TD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			if (xmin<drawX)
 			{
@@ -5720,21 +5479,7 @@ void drawPoly4TD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 			xmax--;
 			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<xmax;j+=2)
-			{
-				GetTextureTransColG32((unsigned long *)&psxVuw[(i<<10)+j],
-				                      (((long)psxVuw[(((((posY+difY)>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-				                                     (((posX+difX)>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0])<<16)|
-				                      psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-				                             ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0]);
-
-				posX+=difX2;
-				posY+=difY2;
-			}
-			if (j==xmax)
-				GetTextureTransColG(&psxVuw[(i<<10)+j],
-				                    psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-				                           ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0]);
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,YAdjust,0);
 		}
 		if (NextRow_FT4()) return;
 	}
@@ -5995,14 +5740,7 @@ __inline void drawPoly3Gi(short x1,short y1,short x2,short y2,short x3,short y3,
 					cB1+=j*difB;
 				}
 
-				for (j=xmin;j<=xmax;j++)
-				{
-					GetShadeTransCol(&psxVuw[(i<<10)+j],((cR1 >> 9)&0x7c00)|((cG1 >> 14)&0x03e0)|((cB1 >> 19)&0x001f));
-
-					cR1+=difR;
-					cG1+=difG;
-					cB1+=difB;
-				}
+				GouraudSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,cR1,cG1,cB1,difR,difG,difB);
 			}
 			if (NextRow_G()) return;
 		}
@@ -6033,112 +5771,39 @@ void drawPoly4G(long rgb1, long rgb2, long rgb3, long rgb4)
 void drawPoly3TGEx4(short x1, short y1, short x2, short y2, short x3, short y3, short tx1, short ty1, short tx2, short ty2, short tx3, short ty3, short clX, short clY,long col1, long col2, long col3)
 {
 	int i,j,xmin,xmax,ymin,ymax;
-	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY,difX2, difY2;
-	long posX,posY,YAdjust,clutP,XAdjust;
-	short tC1,tC2;
-
-	if (x1>drawW && x2>drawW && x3>drawW) return;
-	if (y1>drawH && y2>drawH && y3>drawH) return;
-	if (x1<drawX && x2<drawX && x3<drawX) return;
-	if (y1<drawY && y2<drawY && y3<drawY) return;
-	if (drawY>=drawH) return;
-	if (drawX>=drawW) return;
-
-	if (!SetupSections_GT(x1,y1,x2,y2,x3,y3,tx1,ty1,tx2,ty2,tx3,ty3,col1,col2,col3)) return;
-
-	ymax=Ymax;
-
-	for (ymin=Ymin;ymin<drawY;ymin++)
-		if (NextRow_GT()) return;
-
-	clutP=(clY<<10)+clX;
-
-	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
-
-	difR=delta_right_R;
-	difG=delta_right_G;
-	difB=delta_right_B;
-	difR2=difR<<1;
-	difG2=difG<<1;
-	difB2=difB<<1;
-
-	difX=delta_right_u;
-	difX2=difX<<1;
-	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=((left_x) >> 16);
-			xmax=((right_x) >> 16)-1; //!!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					XAdjust=(posX>>16);
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					XAdjust=((posX+difX)>>16);
-					tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-					             (XAdjust>>1)];
-					tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         psxVuw[clutP+tC1]|
-					                         ((long)psxVuw[clutP+tC2])<<16,
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-				{
-					XAdjust=(posX>>16);
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[clutP+tC1],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-				}
-			}
-			if (NextRow_GT())
-			{
-				return;
-			}
-		}
-		return;
-	}
+	long cR1,cG1,cB1;
+	long difR,difB,difG;
+	long difX, difY;
+	long posX,posY,YAdjust,clutP;
+	soft_span_gt pSpan;
 
-#endif
+	if (x1>drawW && x2>drawW && x3>drawW) return;
+	if (y1>drawH && y2>drawH && y3>drawH) return;
+	if (x1<drawX && x2<drawX && x3<drawX) return;
+	if (y1<drawY && y2<drawY && y3<drawY) return;
+	if (drawY>=drawH) return;
+	if (drawX>=drawW) return;
+
+	if (!SetupSections_GT(x1,y1,x2,y2,x3,y3,tx1,ty1,tx2,ty2,tx3,ty3,col1,col2,col3)) return;
+
+	ymax=Ymax;
+
+	for (ymin=Ymin;ymin<drawY;ymin++)
+		if (NextRow_GT()) return;
+
+	clutP=(clY<<10)+clX;
+
+	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
+
+	difR=delta_right_R;
+	difG=delta_right_G;
+	difB=delta_right_B;
+
+	difX=delta_right_u;
+	difY=delta_right_v;
+
+	pSpan=SelectSpanGT(SPAN_TEX4);
+	TexCacheUse(SPAN_TEX4,clX,clY);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -6165,25 +5830,7 @@ void drawPoly3TGEx4(short x1, short y1, short x2, short y2, short x3, short y3,
 				cB1+=j*difB;
 			}
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				XAdjust=(posX>>16);
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				if (iDither)
-					GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-					                            psxVuw[clutP+tC1],
-					                            (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[clutP+tC1],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,clutP);
 		}
 		if (NextRow_GT())
 		{
@@ -6380,10 +6027,10 @@ void drawPoly3TGEx4_TW(short x1, short y1, short x2, short y2, short x3, short y
 {
 	int i,j,xmin,xmax,ymin,ymax;
 	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY,difX2, difY2;
-	long posX,posY,YAdjust,clutP,XAdjust;
-	short tC1,tC2;
+	long difR,difB,difG;
+	long difX, difY;
+	long posX,posY,YAdjust,clutP;
+	soft_span_gt pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -6407,86 +6054,11 @@ void drawPoly3TGEx4_TW(short x1, short y1, short x2, short y2, short x3, short y
 	difR=delta_right_R;
 	difG=delta_right_G;
 	difB=delta_right_B;
-	difR2=difR<<1;
-	difG2=difG<<1;
-	difB2=difB<<1;
 
 	difX=delta_right_u;
-	difX2=difX<<1;
 	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=((left_x) >> 16);
-			xmax=((right_x) >> 16)-1; //!!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					XAdjust=(posX>>16)%TWin.Position.x1;
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					XAdjust=((posX+difX)>>16)%TWin.Position.x1;
-					tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         psxVuw[clutP+tC1]|
-					                         ((long)psxVuw[clutP+tC2])<<16,
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-				{
-					XAdjust=(posX>>16)%TWin.Position.x1;
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[clutP+tC1],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-				}
-			}
-			if (NextRow_GT())
-			{
-				return;
-			}
-		}
-		return;
-	}
 
-#endif
+	pSpan=SelectSpanGT(SPAN_TEX4_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -6513,26 +6085,7 @@ void drawPoly3TGEx4_TW(short x1, short y1, short x2, short y2, short x3, short y
 				cB1+=j*difB;
 			}
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				XAdjust=(posX>>16)%TWin.Position.x1;
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+(XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				if (iDither)
-					GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-					                            psxVuw[clutP+tC1],
-					                            (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[clutP+tC1],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,clutP);
 		}
 		if (NextRow_GT())
 		{
@@ -6592,10 +6145,10 @@ void drawPoly4TGEx4(short x1, short y1, short x2, short y2, short x3, short y3,
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
 	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY, difX2, difY2;
-	long posX,posY,YAdjust,clutP,XAdjust;
-	short tC1,tC2;
+	long difR,difB,difG;
+	long difX, difY;
+	long posX,posY,YAdjust,clutP;
+	soft_span_gt pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -6616,90 +6169,8 @@ void drawPoly4TGEx4(short x1, short y1, short x2, short y2, short x3, short y3,
 	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
 
 
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-				difR=(right_R-cR1)/num;
-				difG=(right_G-cG1)/num;
-				difB=(right_B-cB1)/num;
-				difR2=difR<<1;
-				difG2=difG<<1;
-				difB2=difB<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					XAdjust=(posX>>16);
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-					XAdjust=((posX+difX)>>16);
-					tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-					             (XAdjust>>1)];
-					tC2=(tC2>>((XAdjust&1)<<2))&0xf;
-
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         psxVuw[clutP+tC1]|
-					                         ((long)psxVuw[clutP+tC2])<<16,
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-				{
-					XAdjust=(posX>>16);
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+
-					             (XAdjust>>1)];
-					tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[clutP+tC1],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-				}
-			}
-			if (NextRow_GT4()) return;
-		}
-		return;
-	}
-
-#endif
+	pSpan=SelectSpanGT(SPAN_TEX4);
+	TexCacheUse(SPAN_TEX4,clX,clY);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -6715,8 +6186,6 @@ void drawPoly4TGEx4(short x1, short y1, short x2, short y2, short x3, short y3,
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			cR1=left_R;
 			cG1=left_G;
@@ -6724,43 +6193,21 @@ void drawPoly4TGEx4(short x1, short y1, short x2, short y2, short x3, short y3,
 			difR=(right_R-cR1)/num;
 			difG=(right_G-cG1)/num;
 			difB=(right_B-cB1)/num;
-			difR2=difR<<1;
-			difG2=difG<<1;
-			difB2=difB<<1;
-
-			if (xmin<drawX)
-			{
-				j=drawX-xmin;
-				xmin=drawX;
-				posX+=j*difX;
-				posY+=j*difY;
-				cR1+=j*difR;
-				cG1+=j*difG;
-				cB1+=j*difB;
-			}
-			xmax--;
-			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				XAdjust=(posX>>16);
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+
-				             (XAdjust>>1)];
-				tC1=(tC1>>((XAdjust&1)<<2))&0xf;
-				if (iDither)
-					GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-					                            psxVuw[clutP+tC1],
-					                            (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[clutP+tC1],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
+			if (xmin<drawX)
+			{
+				j=drawX-xmin;
+				xmin=drawX;
+				posX+=j*difX;
+				posY+=j*difY;
+				cR1+=j*difR;
+				cG1+=j*difG;
+				cB1+=j*difB;
 			}
+			xmax--;
+			if (drawW<xmax) xmax=drawW;
+
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,clutP);
 		}
 		if (NextRow_GT4()) return;
 	}
@@ -6792,10 +6239,10 @@ void drawPoly3TGEx8(short x1, short y1, short x2, short y2, short x3, short y3,
 {
 	int i,j,xmin,xmax,ymin,ymax;
 	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY,difX2, difY2;
+	long difR,difB,difG;
+	long difX, difY;
 	long posX,posY,YAdjust,clutP;
-	short tC1,tC2;
+	soft_span_gt pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -6818,77 +6265,11 @@ void drawPoly3TGEx8(short x1, short y1, short x2, short y2, short x3, short y3,
 	difR=delta_right_R;
 	difG=delta_right_G;
 	difB=delta_right_B;
-	difR2=difR<<1;
-	difG2=difG<<1;
-	difB2=difB<<1;
 	difX=delta_right_u;
-	difX2=difX<<1;
 	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16)-1; // !!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+((posX>>16))];
-					tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-					             (((posX+difX)>>16))];
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         psxVuw[clutP+tC1]|
-					                         ((long)psxVuw[clutP+tC2])<<16,
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-				{
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+((posX>>16))];
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[clutP+tC1],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-				}
-			}
-			if (NextRow_GT())
-			{
-				return;
-			}
-		}
-		return;
-	}
 
-#endif
+	pSpan=SelectSpanGT(SPAN_TEX8);
+	TexCacheUse(SPAN_TEX8,clX,clY);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -6915,23 +6296,7 @@ void drawPoly3TGEx8(short x1, short y1, short x2, short y2, short x3, short y3,
 				cB1+=j*difB;
 			}
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+((posX>>16))];
-				if (iDither)
-					GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-					                            psxVuw[clutP+tC1],
-					                            (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[clutP+tC1],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,clutP);
 		}
 		if (NextRow_GT())
 		{
@@ -7123,10 +6488,10 @@ void drawPoly3TGEx8_TW(short x1, short y1, short x2, short y2, short x3, short y
 {
 	int i,j,xmin,xmax,ymin,ymax;
 	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY,difX2, difY2;
+	long difR,difB,difG;
+	long difX, difY;
 	long posX,posY,YAdjust,clutP;
-	short tC1,tC2;
+	soft_span_gt pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -7150,80 +6515,10 @@ void drawPoly3TGEx8_TW(short x1, short y1, short x2, short y2, short x3, short y
 	difR=delta_right_R;
 	difG=delta_right_G;
 	difB=delta_right_B;
-	difR2=difR<<1;
-	difG2=difG<<1;
-	difB2=difB<<1;
 	difX=delta_right_u;
-	difX2=difX<<1;
 	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16)-1; // !!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+((posX>>16)%TWin.Position.x1)];
-					tC2 = psxVub[((((posY+difY)>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+(((posX+difX)>>16)%TWin.Position.x1)];
-
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         psxVuw[clutP+tC1]|
-					                         ((long)psxVuw[clutP+tC2])<<16,
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-				{
-					tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-					             YAdjust+((posX>>16)%TWin.Position.x1)];
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[clutP+tC1],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-				}
-			}
-			if (NextRow_GT())
-			{
-				return;
-			}
-		}
-		return;
-	}
 
-#endif
+	pSpan=SelectSpanGT(SPAN_TEX8_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -7250,24 +6545,7 @@ void drawPoly3TGEx8_TW(short x1, short y1, short x2, short y2, short x3, short y
 				cB1+=j*difB;
 			}
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				tC1 = psxVub[(((posY>>16)%TWin.Position.y1)<<11)+
-				             YAdjust+((posX>>16)%TWin.Position.x1)];
-				if (iDither)
-					GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-					                            psxVuw[clutP+tC1],
-					                            (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[clutP+tC1],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,clutP);
 		}
 		if (NextRow_GT())
 		{
@@ -7322,10 +6600,10 @@ void drawPoly4TGEx8(short x1, short y1, short x2, short y2, short x3, short y3,
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
 	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY, difX2, difY2;
+	long difR,difB,difG;
+	long difX, difY;
 	long posX,posY,YAdjust,clutP;
-	short tC1,tC2;
+	soft_span_gt pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -7343,84 +6621,10 @@ void drawPoly4TGEx8(short x1, short y1, short x2, short y2, short x3, short y3,
 
 	clutP=(clY<<10)+clX;
 
-	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-				difR=(right_R-cR1)/num;
-				difG=(right_G-cG1)/num;
-				difB=(right_B-cB1)/num;
-				difR2=difR<<1;
-				difG2=difG<<1;
-				difB2=difB<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-					tC2 = psxVub[(((posY+difY)>>5)&0xFFFFF800)+YAdjust+
-					             ((posX+difX)>>16)];
-
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         psxVuw[clutP+tC1]|
-					                         ((long)psxVuw[clutP+tC2])<<16,
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-				{
-					tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[clutP+tC1],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-				}
-			}
-			if (NextRow_GT4()) return;
-		}
-		return;
-	}
-
-#endif
+	YAdjust=((GlobalTextAddrY)<<11)+(GlobalTextAddrX<<1);
+
+	pSpan=SelectSpanGT(SPAN_TEX8);
+	TexCacheUse(SPAN_TEX8,clX,clY);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -7436,8 +6640,6 @@ void drawPoly4TGEx8(short x1, short y1, short x2, short y2, short x3, short y3,
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			cR1=left_R;
 			cG1=left_G;
@@ -7445,9 +6647,6 @@ void drawPoly4TGEx8(short x1, short y1, short x2, short y2, short x3, short y3,
 			difR=(right_R-cR1)/num;
 			difG=(right_G-cG1)/num;
 			difB=(right_B-cB1)/num;
-			difR2=difR<<1;
-			difG2=difG<<1;
-			difB2=difB<<1;
 
 			if (xmin<drawX)
 			{
@@ -7462,23 +6661,7 @@ void drawPoly4TGEx8(short x1, short y1, short x2, short y2, short x3, short y3,
 			xmax--;
 			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				tC1 = psxVub[((posY>>5)&0xFFFFF800)+YAdjust+(posX>>16)];
-				if (iDither)
-					GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-					                            psxVuw[clutP+tC1],
-					                            (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[clutP+tC1],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,clutP);
 		}
 		if (NextRow_GT4()) return;
 	}
@@ -7509,9 +6692,10 @@ void drawPoly3TGD(short x1, short y1, short x2, short y2, short x3, short y3, sh
 {
 	int i,j,xmin,xmax,ymin,ymax;
 	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY,difX2, difY2;
-	long posX,posY;
+	long difR,difB,difG;
+	long difX, difY;
+	long posX,posY,YAdjust;
+	soft_span_gt pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -7530,71 +6714,12 @@ void drawPoly3TGD(short x1, short y1, short x2, short y2, short x3, short y3, sh
 	difR=delta_right_R;
 	difG=delta_right_G;
 	difB=delta_right_B;
-	difR2=difR<<1;
-	difG2=difG<<1;
-	difB2=difB<<1;
 	difX=delta_right_u;
-	difX2=difX<<1;
 	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16)-1; //!!!!!!!!!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
 
-				for (j=xmin;j<xmax;j+=2)
-				{
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         (((long)psxVuw[((((posY+difY)>>16)+GlobalTextAddrY)<<10)+((posX+difX)>>16)+GlobalTextAddrX])<<16)|
-					                         psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+((posX)>>16)+GlobalTextAddrX],
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-			}
-			if (NextRow_GT())
-			{
-				return;
-			}
-		}
-		return;
-	}
+	YAdjust=(GlobalTextAddrY<<10)+GlobalTextAddrX;
 
-#endif
+	pSpan=SelectSpanGT(SPAN_TEX15);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -7621,22 +6746,7 @@ void drawPoly3TGD(short x1, short y1, short x2, short y2, short x3, short y3, sh
 				cB1+=j*difB;
 			}
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				if (iDither)
-					GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-					                            psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX],
-					                            (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,0);
 		}
 		if (NextRow_GT())
 		{
@@ -7651,9 +6761,10 @@ void drawPoly3TGD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 {
 	int i,j,xmin,xmax,ymin,ymax;
 	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY,difX2, difY2;
-	long posX,posY;
+	long difR,difB,difG;
+	long difX, difY;
+	long posX,posY,YAdjust;
+	soft_span_gt pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH) return;
@@ -7672,74 +6783,12 @@ void drawPoly3TGD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 	difR=delta_right_R;
 	difG=delta_right_G;
 	difB=delta_right_B;
-	difR2=difR<<1;
-	difG2=difG<<1;
-	difB2=difB<<1;
 	difX=delta_right_u;
-	difX2=difX<<1;
 	difY=delta_right_v;
-	difY2=difY<<1;
-
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16)-1; //!!!!!!!!!!!!!!!!!!!!
-			if (drawW<xmax) xmax=drawW;
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
 
-				for (j=xmin;j<xmax;j+=2)
-				{
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         (((long)psxVuw[(((((posY+difY)>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                                        (((posX+difX)>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0])<<16)|
-					                         psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                                (((posX)>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0],
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                              ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-			}
-			if (NextRow_GT())
-			{
-				return;
-			}
-		}
-		return;
-	}
+	YAdjust=((GlobalTextAddrY+TWin.Position.y0)<<10)+GlobalTextAddrX+TWin.Position.x0;
 
-#endif
+	pSpan=SelectSpanGT(SPAN_TEX15_TW);
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -7766,24 +6815,7 @@ void drawPoly3TGD_TW(short x1, short y1, short x2, short y2, short x3, short y3,
 				cB1+=j*difB;
 			}
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				if (iDither)
-					GetTextureTransColGX_Dither(&psxVuw[(i<<10)+j],
-					                            psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                                   ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0],
-					                            (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[((((posY>>16)%TWin.Position.y1)+GlobalTextAddrY+TWin.Position.y0)<<10)+
-					                            ((posX>>16)%TWin.Position.x1)+GlobalTextAddrX+TWin.Position.x0],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,0);
 		}
 		if (NextRow_GT())
 		{
@@ -7815,9 +6847,10 @@ void drawPoly4TGD(short x1, short y1, short x2, short y2, short x3, short y3, sh
 	long num;
 	long i,j,xmin,xmax,ymin,ymax;
 	long cR1,cG1,cB1;
-	long difR,difB,difG,difR2,difB2,difG2;
-	long difX, difY, difX2, difY2;
-	long posX,posY;
+	long difR,difB,difG;
+	long difX, difY;
+	long posX,posY,YAdjust;
+	soft_span_gt pSpan;
 
 	if (x1>drawW && x2>drawW && x3>drawW && x4>drawW) return;
 	if (y1>drawH && y2>drawH && y3>drawH && y4>drawH) return;
@@ -7833,75 +6866,11 @@ void drawPoly4TGD(short x1, short y1, short x2, short y2, short x3, short y3, sh
 	for (ymin=Ymin;ymin<drawY;ymin++)
 		if (NextRow_GT4()) return;
 
-#ifdef FASTSOLID
-
-	if (!bCheckMask && !DrawSemiTrans && !iDither)
-	{
-		for (i=ymin;i<=ymax;i++)
-		{
-			xmin=(left_x >> 16);
-			xmax=(right_x >> 16);
-
-			if (xmax>=xmin)
-			{
-				posX=left_u;
-				posY=left_v;
-
-				num=(xmax-xmin);
-				if (num==0) num=1;
-				difX=(right_u-posX)/num;
-				difY=(right_v-posY)/num;
-				difX2=difX<<1;
-				difY2=difY<<1;
-
-				cR1=left_R;
-				cG1=left_G;
-				cB1=left_B;
-				difR=(right_R-cR1)/num;
-				difG=(right_G-cG1)/num;
-				difB=(right_B-cB1)/num;
-				difR2=difR<<1;
-				difG2=difG<<1;
-				difB2=difB<<1;
-
-				if (xmin<drawX)
-				{
-					j=drawX-xmin;
-					xmin=drawX;
-					posX+=j*difX;
-					posY+=j*difY;
-					cR1+=j*difR;
-					cG1+=j*difG;
-					cB1+=j*difB;
-				}
-				xmax--;
-				if (drawW<xmax) xmax=drawW;
-
-				for (j=xmin;j<xmax;j+=2)
-				{
-					GetTextureTransColGX32_S((unsigned long *)&psxVuw[(i<<10)+j],
-					                         (((long)psxVuw[((((posY+difY)>>16)+GlobalTextAddrY)<<10)+((posX+difX)>>16)+GlobalTextAddrX])<<16)|
-					                         psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+((posX)>>16)+GlobalTextAddrX],
-					                         (cB1>>16)|((cB1+difB)&0xff0000),
-					                         (cG1>>16)|((cG1+difG)&0xff0000),
-					                         (cR1>>16)|((cR1+difR)&0xff0000));
-					posX+=difX2;
-					posY+=difY2;
-					cR1+=difR2;
-					cG1+=difG2;
-					cB1+=difB2;
-				}
-				if (j==xmax)
-					GetTextureTransColGX_S(&psxVuw[(i<<10)+j],
-					                       psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX],
-					                       (cB1>>16),(cG1>>16),(cR1>>16));
-			}
-			if (NextRow_GT4()) return;
-		}
-		return;
-	}
+	YAdjust=(GlobalTextAddrY<<10)+GlobalTextAddrX;
 
-#endif
+	// the 15 bit gouraud quad never dithered (both iDither branches of the
+	// old loop used GetTextureTransColGX), keep it that way for old movies
+	pSpan=spanGT[SPAN_TEX15][SPAN_SEMI][bCheckMask?1:0][0];
 
 	for (i=ymin;i<=ymax;i++)
 	{
@@ -7917,8 +6886,6 @@ void drawPoly4TGD(short x1, short y1, short x2, short y2, short x3, short y3, sh
 			if (num==0) num=1;
 			difX=(right_u-posX)/num;
 			difY=(right_v-posY)/num;
-			difX2=difX<<1;
-			difY2=difY<<1;
 
 			cR1=left_R;
 			cG1=left_G;
@@ -7926,9 +6893,6 @@ void drawPoly4TGD(short x1, short y1, short x2, short y2, short x3, short y3, sh
 			difR=(right_R-cR1)/num;
 			difG=(right_G-cG1)/num;
 			difB=(right_B-cB1)/num;
-			difR2=difR<<1;
-			difG2=difG<<1;
-			difB2=difB<<1;
 
 			if (xmin<drawX)
 			{
@@ -7943,22 +6907,7 @@ void drawPoly4TGD(short x1, short y1, short x2, short y2, short x3, short y3, sh
 			xmax--;
 			if (drawW<xmax) xmax=drawW;
 
-			for (j=xmin;j<=xmax;j++)
-			{
-				if (iDither)
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				else
-					GetTextureTransColGX(&psxVuw[(i<<10)+j],
-					                     psxVuw[(((posY>>16)+GlobalTextAddrY)<<10)+(posX>>16)+GlobalTextAddrX],
-					                     (cB1>>16),(cG1>>16),(cR1>>16));
-				posX+=difX;
-				posY+=difY;
-				cR1+=difR;
-				cG1+=difG;
-				cB1+=difB;
-			}
+			pSpan(&psxVuw[(i<<10)+xmin],xmax-xmin+1,posX,posY,difX,difY,cR1,cG1,cB1,difR,difG,difB,YAdjust,0);
 		}
 		if (NextRow_GT4()) return;
 	}
@@ -8322,9 +7271,9 @@ void DrawSoftwareSpriteTWin(unsigned char * baseAddr,long w,long h)
 	sx0=lx0;
 	sy0=ly0;
 
-	sx0=sx3=sx0+PSXDisplay.DrawOffset.x;
+	sx0=sx3=sx0+DrawOffset.x;
 	sx1=sx2=sx0+w;
-	sy0=sy1=sy0+PSXDisplay.DrawOffset.y;
+	sy0=sy1=sy0+DrawOffset.y;
 	sy2=sy3=sy0+h;
 
 	tx0=tx3=gpuData[2]&0xff;
@@ -8369,8 +7318,8 @@ void DrawSoftwareSpriteMirror(unsigned char * baseAddr,long w,long h)
 	textY0 = ((gpuData[2]>>8) & 0x000000ff) + GlobalTextAddrY;
 	textX0 = (gpuData[2] & 0x000000ff);
 
-	sprtX+=PSXDisplay.DrawOffset.x;
-	sprtY+=PSXDisplay.DrawOffset.y;
+	sprtX+=DrawOffset.x;
+	sprtY+=DrawOffset.y;
 
 // while (sprtX>1023)             sprtX-=1024;
 // while (sprtY>MAXYLINESMIN1)    sprtY-=MAXYLINES;
@@ -8467,8 +7416,8 @@ void DrawSoftwareSprite_IL(unsigned char * baseAddr,short w,short h,long tx,long
 	sprtH = h;
 	sprtW = w;
 
-	sprtX+=PSXDisplay.DrawOffset.x;
-	sprtY+=PSXDisplay.DrawOffset.y;
+	sprtX+=DrawOffset.x;
+	sprtY+=DrawOffset.y;
 
 	if (sprtX>drawW) return;
 	if (sprtY>drawH) return;
@@ -8522,8 +7471,8 @@ void DrawSoftwareSprite(unsigned char * baseAddr,short w,short h,long tx,long ty
 	textY0 =ty+ GlobalTextAddrY;
 	textX0 =tx;
 
-	sprtX+=PSXDisplay.DrawOffset.x;
-	sprtY+=PSXDisplay.DrawOffset.y;
+	sprtX+=DrawOffset.x;
+	sprtY+=DrawOffset.y;
 
 //while (sprtX>1023)             sprtX-=1024;
 //while (sprtY>MAXYLINESMIN1)    sprtY-=MAXYLINES;
@@ -9040,7 +7989,7 @@ void VertLineShade(int x, int y0, int y1, unsigned long rgb0, unsigned long rgb1
 
 void HorzLineShade(int y, int x0, int x1, unsigned long rgb0, unsigned long rgb1)
 {
-	int x, dx;
+	int dx;
 	unsigned long r0, g0, b0, r1, g1, b1;
 	long dr, dg, db;
 
@@ -9077,13 +8026,7 @@ void HorzLineShade(int y, int x0, int x1, unsigned long rgb0, unsigned long rgb1
 	if (x1 > drawW)
 		x1 = drawW;
 
-	for (x = x0; x <= x1; x++)
-	{
-		GetShadeTransCol(&psxVuw[(y<<10)+x],(unsigned short)(((r0 >> 9)&0x7c00)|((g0 >> 14)&0x03e0)|((b0 >> 19)&0x001f)));
-		r0+=dr;
-		g0+=dg;
-		b0+=db;
-	}
+	GouraudSpan(&psxVuw[(y<<10)+x0],x1-x0+1,r0,g0,b0,dr,dg,db);
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -9238,16 +8181,13 @@ void VertLineFlat(int x, int y0, int y1, unsigned short colour)
 
 void HorzLineFlat(int y, int x0, int x1, unsigned short colour)
 {
-	int x;
-
 	if (x0 < drawX)
 		x0 = drawX;
 
 	if (x1 > drawW)
 		x1 = drawW;
 
-	for (x = x0; x <= x1; x++)
-		GetShadeTransCol(&psxVuw[(y<<10)+x], colour);
+	ShadeSpan(&psxVuw[(y<<10)+x0], x1-x0+1, colour);
 }
 
 ///////////////////////////////////////////////////////////////////////
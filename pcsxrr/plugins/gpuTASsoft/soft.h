@@ -50,5 +50,9 @@ void DrawSoftwareSpriteTWin(unsigned char * baseAddr,long w,long h);
 void DrawSoftwareSpriteMirror(unsigned char * baseAddr,long w,long h);
 void DrawSoftwareLineShade(long rgb0, long rgb1);
 void DrawSoftwareLineFlat(long rgb);
+void TexCacheDirty(long x0,long y0,long x1,long y1);
+void TexCacheFree(void);
+unsigned long VramStamp(long x0,long y0,long x1,long y1);
+void VramLoad(const unsigned short * pSrc);
 
 #endif // _GPU_SOFT_H_
@@ -76,6 +76,19 @@ typedef DWORD EXECUTION_STATE;
 #endif
 #else
 
+#ifdef _HEADLESS 	//no display at all
+
+#define __inline inline
+#define CALLBACK
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <math.h>
+
+#else
+
 #ifndef _SDL
 #define __X11_C_
 //X11 render
@@ -107,3 +120,11 @@ typedef DWORD EXECUTION_STATE;
 
 #endif
 
+#endif
+
+// gpu words, pixel pairs (the *32 blend helpers) and the psemu interface
+// all live in longs here, which have to be 32 bit
+
+#if defined(__LP64__) || defined(_LP64)
+#error "the soft gpu needs 32 bit longs, build it with -m32 (CPU = i386)"
+#endif
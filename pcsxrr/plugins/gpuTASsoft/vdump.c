@@ -0,0 +1,635 @@
+/***************************************************************************
+                          vdump.c  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+//*************************************************************************//
+// History of changes:
+//
+// 2026/10/19
+// - avi mode: raw video plus the sound the core passes in each vsync,
+//   every frame tagged with its movie frame and the cpu cycles it took
+//
+// 2026/10/19
+// - portable video dump (y4m/raw rgb), frames are converted and written
+//   by a writer thread, the emu thread only copies the display area
+//
+//*************************************************************************//
+
+#ifndef _WINDOWS
+#define _FILE_OFFSET_BITS 64                           // dumps get big fast
+#endif
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "externals.h"
+#include "gpu.h"
+#include "vdump.h"
+#include "../../emuthread.h"
+
+////////////////////////////////////////////////////////////////////////
+
+typedef struct VDUMPFRAMETAG
+{
+	long             x;                                  // display size
+	long             y;
+	long             RGB24;
+	long             Disabled;
+	unsigned short * pVRam;                              // y lines of 1024 shorts, from the display pos
+	unsigned long    ulFrame;                            // avi: movie frame and the cpu cycles
+	unsigned long    ulCycles;                           // it took
+	short *          pAudio;                             // avi: the sound of this frame
+	long             lSamples;
+	long             lAudioSize;                         // samples pAudio can hold
+} VDumpFrame_t;
+
+BOOL                bVDump=FALSE;
+BOOL                bVDumpAudio=FALSE;                 // avi: frames come from GPUavDumpFrame
+
+static FILE *       fVDump=NULL;
+static int          iVDumpFormat;
+static int          iVDumpW,iVDumpH;                   // the size of the dumped frames
+static VDumpFrame_t vdFrame[VDUMP_SLOTS];
+static int          vdHead,vdTail,vdCount;             // head: emu thread, tail: writer thread
+static unsigned char * vdRGB=NULL;                     // writer thread buffers
+static unsigned char * vdYUV=NULL;
+static unsigned char vdExpand[32];                     // 5 -> 8 bit
+
+static emuThread    vdThread;
+static emuMutex     vdMutex;
+static emuEvent     vdDataEvent;                       // frame queued
+static emuEvent     vdSpaceEvent;                      // frame written
+static volatile BOOL bVDumpQuit;
+static volatile BOOL bVDumpError;
+
+#ifdef _MSC_VER
+#define VDumpSeekCur(off) _fseeki64(fVDump,(__int64)(off),SEEK_CUR)
+#elif defined(__MINGW32__)
+#define VDumpSeekCur(off) fseeko64(fVDump,(long long)(off),SEEK_CUR)
+#else
+#define VDumpSeekCur(off) fseeko(fVDump,(off_t)(off),SEEK_CUR)
+#endif
+
+////////////////////////////////////////////////////////////////////////
+// avi: 'RIFF AVI ' with the headers, then 'RIFF AVIX' parts of up to
+// 1 GB (opendml style, but without indexes: players have to read it in
+// order, like ffmpeg does). Per frame: a JUNK chunk with the tag,
+// '00db' bgr24 bottom-up, '01wb' 44100 hz 16 bit stereo pcm
+
+#define AVI_RIFF_MAX  0x40000000
+
+static int          iVDumpFps;
+static unsigned char aviHdr[1024];
+static int          iAviHdr;
+static int          iAviTotalPos,iAviVLenPos,iAviALenPos,iAviDmlhPos;
+static int          iAviMoviPos;                       // movi size, from the riff start
+static unsigned long ulAviRiffBytes;                   // written in the current riff
+static unsigned long ulAviFrames;
+static unsigned long ulAviSamples;
+
+static void AviSet32(unsigned char * p,unsigned long v)
+{
+	p[0]=(unsigned char)v;p[1]=(unsigned char)(v>>8);
+	p[2]=(unsigned char)(v>>16);p[3]=(unsigned char)(v>>24);
+}
+
+static void AviHdr32(unsigned long v) {AviSet32(aviHdr+iAviHdr,v);iAviHdr+=4;}
+static void AviHdr16(unsigned short v) {aviHdr[iAviHdr]=(unsigned char)v;aviHdr[iAviHdr+1]=(unsigned char)(v>>8);iAviHdr+=2;}
+static void AviHdrId(const char * id) {memcpy(aviHdr+iAviHdr,id,4);iAviHdr+=4;}
+
+static int AviHdrChunk(const char * id,const char * type)
+{
+	int pos;
+	AviHdrId(id);
+	pos=iAviHdr;
+	AviHdr32(0);                                          // size: see AviHdrEnd
+	if (type) AviHdrId(type);
+	return pos;
+}
+
+static void AviHdrEnd(int pos)
+{
+	AviSet32(aviHdr+pos,iAviHdr-pos-4);
+}
+
+static BOOL AviWrite(void * p,unsigned long size)
+{
+	ulAviRiffBytes+=size;
+	return fwrite(p,size,1,fVDump)==1;
+}
+
+static BOOL AviChunk(const char * id,unsigned long size)
+{
+	unsigned char h[8];
+	memcpy(h,id,4);
+	AviSet32(h+4,size);
+	return AviWrite(h,8);
+}
+
+static BOOL AviStartRiff(void)                         // the AVIX ones
+{
+	iAviHdr=0;
+	AviHdrChunk("RIFF","AVIX");
+	iAviMoviPos=AviHdrChunk("LIST","movi");
+	ulAviRiffBytes=0;
+	return AviWrite(aviHdr,iAviHdr);
+}
+
+static BOOL AviEndRiff(void)                           // patch the riff and movi sizes
+{
+	unsigned char b[4];
+	unsigned long ulEnd=ulAviRiffBytes;
+
+	if (VDumpSeekCur(-(long)ulEnd+4)) return FALSE;
+	AviSet32(b,ulEnd-8);
+	fwrite(b,4,1,fVDump);
+	if (VDumpSeekCur(iAviMoviPos-8)) return FALSE;
+	AviSet32(b,ulEnd-iAviMoviPos-4);
+	fwrite(b,4,1,fVDump);
+	return VDumpSeekCur(ulEnd-iAviMoviPos-4)==0;
+}
+
+static BOOL AviStart(void)
+{
+	int list,strl,chunk;
+	unsigned long ulVideo=iVDumpW*iVDumpH*3;
+
+	iAviHdr=0;
+	AviHdrChunk("RIFF","AVI ");
+	list=AviHdrChunk("LIST","hdrl");
+
+	chunk=AviHdrChunk("avih",NULL);                       // main header
+	AviHdr32(1000000/iVDumpFps);
+	AviHdr32(ulVideo*iVDumpFps+44100*4);
+	AviHdr32(0);
+	AviHdr32(0x100);                                      // interleaved
+	iAviTotalPos=iAviHdr;
+	AviHdr32(0);                                          // frames: patched on stop
+	AviHdr32(0);
+	AviHdr32(2);                                          // streams
+	AviHdr32(ulVideo);
+	AviHdr32(iVDumpW);
+	AviHdr32(iVDumpH);
+	AviHdr32(0);AviHdr32(0);AviHdr32(0);AviHdr32(0);
+	AviHdrEnd(chunk);
+
+	strl=AviHdrChunk("LIST","strl");                      // video
+	chunk=AviHdrChunk("strh",NULL);
+	AviHdrId("vids");
+	AviHdr32(0);                                          // uncompressed
+	AviHdr32(0);
+	AviHdr16(0);AviHdr16(0);
+	AviHdr32(0);
+	AviHdr32(1);                                          // scale
+	AviHdr32(iVDumpFps);                                  // rate
+	AviHdr32(0);
+	iAviVLenPos=iAviHdr;
+	AviHdr32(0);                                          // length: patched on stop
+	AviHdr32(ulVideo);
+	AviHdr32(0xffffffff);
+	AviHdr32(0);
+	AviHdr16(0);AviHdr16(0);AviHdr16((unsigned short)iVDumpW);AviHdr16((unsigned short)iVDumpH);
+	AviHdrEnd(chunk);
+	chunk=AviHdrChunk("strf",NULL);                       // bitmapinfoheader
+	AviHdr32(40);
+	AviHdr32(iVDumpW);
+	AviHdr32(iVDumpH);                                    // positive: bottom-up
+	AviHdr16(1);
+	AviHdr16(24);
+	AviHdr32(0);                                          // BI_RGB
+	AviHdr32(ulVideo);
+	AviHdr32(0);AviHdr32(0);AviHdr32(0);AviHdr32(0);
+	AviHdrEnd(chunk);
+	AviHdrEnd(strl);
+
+	strl=AviHdrChunk("LIST","strl");                      // audio
+	chunk=AviHdrChunk("strh",NULL);
+	AviHdrId("auds");
+	AviHdr32(0);
+	AviHdr32(0);
+	AviHdr16(0);AviHdr16(0);
+	AviHdr32(0);
+	AviHdr32(4);                                          // scale: block align
+	AviHdr32(44100*4);                                    // rate: bytes per sec
+	AviHdr32(0);
+	iAviALenPos=iAviHdr;
+	AviHdr32(0);                                          // length in samples: patched on stop
+	AviHdr32(44100*4/iVDumpFps*2);
+	AviHdr32(0xffffffff);
+	AviHdr32(4);
+	AviHdr16(0);AviHdr16(0);AviHdr16(0);AviHdr16(0);
+	AviHdrEnd(chunk);
+	chunk=AviHdrChunk("strf",NULL);                       // waveformat
+	AviHdr16(1);                                          // pcm
+	AviHdr16(2);
+	AviHdr32(44100);
+	AviHdr32(44100*4);
+	AviHdr16(4);
+	AviHdr16(16);
+	AviHdrEnd(chunk);
+	AviHdrEnd(strl);
+
+	strl=AviHdrChunk("LIST","odml");                      // the real frame count
+	chunk=AviHdrChunk("dmlh",NULL);
+	iAviDmlhPos=iAviHdr;
+	memset(aviHdr+iAviHdr,0,248);
+	iAviHdr+=248;
+	AviHdrEnd(chunk);
+	AviHdrEnd(strl);
+
+	AviHdrEnd(list);
+
+	iAviMoviPos=AviHdrChunk("LIST","movi");
+
+	ulAviRiffBytes=0;
+	ulAviFrames=0;
+	ulAviSamples=0;
+
+	return AviWrite(aviHdr,iAviHdr);
+}
+
+static BOOL AviStop(void)
+{
+	unsigned char b[4];
+
+	if (!AviEndRiff()) return FALSE;
+
+	AviSet32(b,ulAviFrames);                              // all in the first kbyte
+	fseek(fVDump,iAviTotalPos,SEEK_SET);fwrite(b,4,1,fVDump);
+	fseek(fVDump,iAviVLenPos,SEEK_SET); fwrite(b,4,1,fVDump);
+	fseek(fVDump,iAviDmlhPos,SEEK_SET); fwrite(b,4,1,fVDump);
+	AviSet32(b,ulAviSamples);
+	fseek(fVDump,iAviALenPos,SEEK_SET); fwrite(b,4,1,fVDump);
+	return TRUE;
+}
+
+static BOOL VDumpWriteAvi(VDumpFrame_t * f)
+{
+	unsigned long ulVideo=iVDumpW*iVDumpH*3;
+	unsigned long ulAudio=f->lSamples*4;
+	unsigned char t[12];
+	unsigned char * s,* d=vdYUV;
+	int x,y;
+
+	if (ulAviRiffBytes+20+8+ulVideo+8+ulAudio>AVI_RIFF_MAX)
+	{
+		if (!AviEndRiff() || !AviStartRiff()) return FALSE;
+	}
+
+	memcpy(t,"PSXF",4);                                   // the tag
+	AviSet32(t+4,f->ulFrame);
+	AviSet32(t+8,f->ulCycles);
+	if (!AviChunk("JUNK",12) || !AviWrite(t,12)) return FALSE;
+
+	for (y=iVDumpH-1;y>=0;y--)                            // rgb top-down -> bgr bottom-up
+	{
+		s=vdRGB+y*iVDumpW*3;
+		for (x=0;x<iVDumpW;x++,s+=3,d+=3)
+		{
+			d[0]=s[2];d[1]=s[1];d[2]=s[0];
+		}
+	}
+	if (!AviChunk("00db",ulVideo) || !AviWrite(vdYUV,ulVideo)) return FALSE;
+
+	if (ulAudio)
+	{
+		if (!AviChunk("01wb",ulAudio) || !AviWrite(f->pAudio,ulAudio)) return FALSE;
+	}
+
+	ulAviFrames++;
+	ulAviSamples+=f->lSamples;
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////
+// writer thread: scale the display area to the dump size (like the avi
+// recording does), and write it as rgb or yuv
+
+static void VDumpConvert(VDumpFrame_t * f)
+{
+	unsigned char * d=vdRGB;
+	long x,y,cx,cy,ax,ay;
+
+	if (f->Disabled || f->x<=0 || f->y<=0)
+	{
+		memset(vdRGB,0,iVDumpW*iVDumpH*3);
+		return;
+	}
+
+	ax=(f->x<<16)/iVDumpW;
+	ay=(f->y<<16)/iVDumpH;
+
+	for (y=0,cy=0;y<iVDumpH;y++,cy+=ay)
+	{
+		unsigned short * src=f->pVRam+((cy>>16)<<10);
+
+		if (f->RGB24)
+		{
+			unsigned char * srcc=(unsigned char *)src;
+#ifdef _WINDOWS
+			int r=iFPSEInterface?2:0;                        // fpse mdec is bgr
+#else
+			int r=0;
+#endif
+
+			for (x=0,cx=0;x<iVDumpW;x++,cx+=ax)
+			{
+				unsigned char * s=srcc+(cx>>16)*3;
+				d[0]=s[r];d[1]=s[1];d[2]=s[2-r];
+				d+=3;
+			}
+		}
+		else
+		{
+			for (x=0,cx=0;x<iVDumpW;x++,cx+=ax)
+			{
+				unsigned short c=src[cx>>16];
+				d[0]=vdExpand[c&0x1f];
+				d[1]=vdExpand[(c>>5)&0x1f];
+				d[2]=vdExpand[(c>>10)&0x1f];
+				d+=3;
+			}
+		}
+	}
+}
+
+static BOOL VDumpWriteY4M(void)
+{
+	int i,n=iVDumpW*iVDumpH;
+	unsigned char * s=vdRGB;
+	unsigned char * pY=vdYUV,* pU=vdYUV+n,* pV=vdYUV+2*n;
+
+	for (i=0;i<n;i++,s+=3)                                // bt.601, studio range
+	{
+		int r=s[0],g=s[1],b=s[2];
+		pY[i]=(unsigned char)((( 66*r+129*g+ 25*b+128)>>8)+ 16);
+		pU[i]=(unsigned char)(((-38*r- 74*g+112*b+128)>>8)+128);
+		pV[i]=(unsigned char)(((112*r- 94*g- 18*b+128)>>8)+128);
+	}
+
+	if (fputs("FRAME\n",fVDump)<0) return FALSE;
+	return fwrite(vdYUV,n*3,1,fVDump)==1;
+}
+
+static void VDumpThreadFunc(void * arg)
+{
+	VDumpFrame_t * f;
+	BOOL bOK;
+
+	for (;;)
+	{
+		emuMutexLock(&vdMutex);
+		while (vdCount==0 && !bVDumpQuit)
+		{
+			emuMutexUnlock(&vdMutex);
+			emuEventWait(&vdDataEvent);
+			emuMutexLock(&vdMutex);
+		}
+		if (vdCount==0)                                     // quit, and all frames are out
+		{
+			emuMutexUnlock(&vdMutex);
+			break;
+		}
+		emuMutexUnlock(&vdMutex);
+
+		f=&vdFrame[vdTail];
+
+		if (!bVDumpError)                                   // on errors just drain the queue
+		{
+			VDumpConvert(f);
+			if (iVDumpFormat==VDUMP_Y4M)      bOK=VDumpWriteY4M();
+			else if (iVDumpFormat==VDUMP_AVI) bOK=VDumpWriteAvi(f);
+			else bOK=fwrite(vdRGB,iVDumpW*iVDumpH*3,1,fVDump)==1;
+			if (!bOK) bVDumpError=TRUE;
+		}
+
+		emuMutexLock(&vdMutex);
+		vdTail=(vdTail+1)%VDUMP_SLOTS;
+		vdCount--;
+		emuMutexUnlock(&vdMutex);
+		emuEventSet(&vdSpaceEvent);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// by file extension: .y4m, .raw/.rgb (rgb24)
+
+int VDUMP_FileFormat(char * pFile)
+{
+	char * p=strrchr(pFile,'.');
+	char szExt[8];
+	int i;
+
+	if (!p || strlen(p)>=sizeof(szExt)) return VDUMP_NONE;
+
+	for (i=0;p[i];i++) szExt[i]=(char)tolower((unsigned char)p[i]);
+	szExt[i]=0;
+
+	if (!strcmp(szExt,".y4m")) return VDUMP_Y4M;
+	if (!strcmp(szExt,".raw") || !strcmp(szExt,".rgb")) return VDUMP_RAW;
+	return VDUMP_NONE;
+}
+
+////////////////////////////////////////////////////////////////////////
+// start: the frame size is fixed for the whole dump, the psx display
+// modes get scaled to 640x480 (ntsc) or 640x512 (pal). lFps>0: an avi
+// with sound, fed by VDUMP_WriteFrame calls from the core
+
+BOOL VDUMP_Start(char * pFile,long lFps)
+{
+	int i;
+
+	VDUMP_Stop();
+
+	iVDumpFormat=VDUMP_FileFormat(pFile);
+	if (iVDumpFormat==VDUMP_NONE) iVDumpFormat=VDUMP_Y4M;
+	if (lFps>0) iVDumpFormat=VDUMP_AVI;
+	iVDumpFps=(lFps>0)?lFps:(PSXDisplay.PAL?50:60);
+
+	iVDumpW=640;
+	iVDumpH=PSXDisplay.PAL?512:480;
+
+	for (i=0;i<32;i++) vdExpand[i]=(unsigned char)((i<<3)|(i>>2));
+
+	vdRGB=(unsigned char *)malloc(iVDumpW*iVDumpH*3);
+	vdYUV=(unsigned char *)malloc(iVDumpW*iVDumpH*3);
+	for (i=0;i<VDUMP_SLOTS;i++)
+		vdFrame[i].pVRam=(unsigned short *)malloc(1024*512*2);
+
+	for (i=0;i<VDUMP_SLOTS;i++)
+		if (!vdFrame[i].pVRam) break;
+
+	if (vdRGB && vdYUV && i==VDUMP_SLOTS)
+		fVDump=fopen(pFile,"wb");
+
+	if (!fVDump)
+	{
+		VDUMP_Stop();
+		return FALSE;
+	}
+
+	setvbuf(fVDump,NULL,_IOFBF,1024*1024);
+
+	if (iVDumpFormat==VDUMP_Y4M)
+		fprintf(fVDump,"YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n",
+		        iVDumpW,iVDumpH,iVDumpFps);
+
+	if (iVDumpFormat==VDUMP_AVI && !AviStart())
+	{
+		VDUMP_Stop();
+		return FALSE;
+	}
+
+	vdHead=vdTail=vdCount=0;
+	bVDumpQuit=FALSE;
+	bVDumpError=FALSE;
+
+	emuMutexInit(&vdMutex);
+	emuEventInit(&vdDataEvent);
+	emuEventInit(&vdSpaceEvent);
+
+	if (emuThreadCreate(&vdThread,VDumpThreadFunc,NULL)!=0)
+	{
+		emuEventDestroy(&vdSpaceEvent);
+		emuEventDestroy(&vdDataEvent);
+		emuMutexDestroy(&vdMutex);
+		VDUMP_Stop();
+		return FALSE;
+	}
+
+	bVDumpAudio=(iVDumpFormat==VDUMP_AVI);
+	bVDump=TRUE;
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////////////////
+// stop: the writer gets all queued frames out first
+
+void VDUMP_Stop(void)
+{
+	int i;
+
+	if (bVDump)
+	{
+		bVDump=FALSE;
+
+		emuMutexLock(&vdMutex);
+		bVDumpQuit=TRUE;
+		emuMutexUnlock(&vdMutex);
+		emuEventSet(&vdDataEvent);
+		emuThreadJoin(&vdThread);
+
+		emuEventDestroy(&vdSpaceEvent);
+		emuEventDestroy(&vdDataEvent);
+		emuMutexDestroy(&vdMutex);
+
+		if (iVDumpFormat==VDUMP_AVI && !bVDumpError) AviStop();
+	}
+
+	bVDumpAudio=FALSE;
+
+	if (fVDump) fclose(fVDump);
+	fVDump=NULL;
+
+	for (i=0;i<VDUMP_SLOTS;i++)
+	{
+		free(vdFrame[i].pVRam);
+		vdFrame[i].pVRam=NULL;
+		free(vdFrame[i].pAudio);
+		vdFrame[i].pAudio=NULL;
+		vdFrame[i].lAudioSize=0;
+	}
+	free(vdRGB);vdRGB=NULL;
+	free(vdYUV);vdYUV=NULL;
+}
+
+////////////////////////////////////////////////////////////////////////
+// vsync: queue the displayed frame, waits only if the writer is
+// VDUMP_SLOTS frames behind. The tag and sound are for avi dumps.
+
+BOOL VDUMP_WriteFrame(unsigned long ulFrame,unsigned long ulCycles,short * pSamples,long lSamples)
+{
+	VDumpFrame_t * f;
+	long y,n,px;
+
+	emuMutexLock(&vdMutex);
+	while (vdCount==VDUMP_SLOTS)
+	{
+		emuMutexUnlock(&vdMutex);
+		emuEventWait(&vdSpaceEvent);
+		emuMutexLock(&vdMutex);
+	}
+	emuMutexUnlock(&vdMutex);
+
+	if (bVDumpError) return FALSE;                        // disk full or such
+
+	f=&vdFrame[vdHead];
+
+	f->x=PSXDisplay.DisplayMode.x;
+	f->y=PSXDisplay.DisplayMode.y;
+	f->RGB24=PSXDisplay.RGB24;
+	f->Disabled=PSXDisplay.Disabled;
+
+	if (f->x>1024) f->x=1024;
+	if (f->y>512)  f->y=512;
+
+	f->ulFrame=ulFrame;
+	f->ulCycles=ulCycles;
+	f->lSamples=0;
+
+	if (pSamples && lSamples>0)
+	{
+		if (lSamples>f->lAudioSize)                         // the slot is ours till queued
+		{
+			short * p=(short *)realloc(f->pAudio,lSamples*4);
+			if (!p) return FALSE;
+			f->pAudio=p;
+			f->lAudioSize=lSamples;
+		}
+		memcpy(f->pAudio,pSamples,lSamples*4);
+		f->lSamples=lSamples;
+	}
+
+	if (!f->Disabled && f->x>0 && f->y>0)
+	{
+		n=f->RGB24?(f->x*3+1)>>1:f->x;                     // shorts per line
+		if (n>1024) n=1024;
+		px=PSXDisplay.DisplayPosition.x&1023;
+
+		for (y=0;y<f->y;y++)
+		{
+			unsigned short * s=psxVuw+(((PSXDisplay.DisplayPosition.y+y)&iGPUHeightMask)<<10);
+			unsigned short * d=f->pVRam+(y<<10);
+
+			if (px+n<=1024) memcpy(d,s+px,n*2);
+			else                                              // wraps at the vram edge
+			{
+				memcpy(d,s+px,(1024-px)*2);
+				memcpy(d+1024-px,s,(n-1024+px)*2);
+			}
+		}
+	}
+
+	emuMutexLock(&vdMutex);
+	vdHead=(vdHead+1)%VDUMP_SLOTS;
+	vdCount++;
+	emuMutexUnlock(&vdMutex);
+	emuEventSet(&vdDataEvent);
+
+	return TRUE;
+}
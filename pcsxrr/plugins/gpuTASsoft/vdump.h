@@ -0,0 +1,39 @@
+/***************************************************************************
+                          vdump.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version. See also the license.txt file for *
+ *   additional informations.                                              *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef _GPU_VDUMP_H_
+#define _GPU_VDUMP_H_
+
+////////////////////////////////////////////////////////////////////////
+// portable video dump: the emu thread just copies the display area
+// into a ring of frames, a writer thread scales/converts and writes them
+
+#define VDUMP_NONE    0                                // not ours (avi on windows)
+#define VDUMP_Y4M     1                                // yuv4mpeg2, 4:4:4
+#define VDUMP_RAW     2                                // raw rgb24 frames, no header
+#define VDUMP_AVI     3                                // raw video + pcm, tagged (GPUstartAvDump)
+
+#define VDUMP_SLOTS   8                                // frames queued before the emu waits
+
+extern BOOL bVDump;
+extern BOOL bVDumpAudio;
+
+int  VDUMP_FileFormat(char * pFile);
+BOOL VDUMP_Start(char * pFile,long lFps);
+void VDUMP_Stop(void);
+BOOL VDUMP_WriteFrame(unsigned long ulFrame,unsigned long ulCycles,short * pSamples,long lSamples);
+
+#endif // _GPU_VDUMP_H_
@@ -73,7 +73,7 @@ void CALLBACK GPUkeypressed(int keycode);
 unsigned long dwGPUVersion=0;
 int           iGPUHeight=512;
 int           iGPUHeightMask=511;
-int           GlobalTextIL=0;
+GPU_TLS int   GlobalTextIL=0;
 int           iTileCheat=0;
 
 // --------------------------------------------------- //
@@ -191,9 +191,7 @@ extern unsigned long LastPlay;
 
 #ifndef _IN_RECORD
 
-#ifdef _WINDOWS
 extern int iDoRecord;
-#endif
 
 #endif
 
@@ -130,7 +130,7 @@ void SPUfreeze_new(EMUFILE* fp)
 	const u32 tag = 0xBEEFFACE;
 	fp->write32le(tag);
 
-	fp->write32le((u32)0); //version
+	fp->write32le((u32)1); //version
 
 	CTASSERT(sizeof(SPU_core->spuMem)==0x80000);
 	fp->fwrite(SPU_core->spuMem,0x80000);
@@ -156,6 +156,7 @@ void SPUfreeze_new(EMUFILE* fp)
 	for(int i=0;i<MAXCHAN;i++) SPU_core->channels[i].save(fp);
 
 	SPU_core->xaqueue.freeze(fp);
+	SPU_core->cddaqueue.freeze(fp); //since version 1
 
 	//a bit weird to do this here, but i wanted to have a more solid XA state saver
 	//and the cdr freeze sucks. I made sure this saves and loads after the cdr state
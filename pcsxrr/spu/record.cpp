@@ -19,6 +19,9 @@
 //*************************************************************************//
 // History of changes:
 //
+// 2026/10/19
+// - wave writing with stdio, recording funcs on all systems
+//
 // 2003/03/01 - Pete
 // - added mono mode
 //
@@ -29,60 +32,64 @@
 
 #include "stdafx.h"
 
-#ifdef _WINDOWS
+#include <stdio.h>
 
-#include <mmsystem.h>
+#ifdef _WINDOWS
 #include "resource.h"
+#endif
 #include "externals.h"
 
 #define _IN_RECORD
 
 #include "record.h"
+#include "../avdump.h"
 
 ////////////////////////////////////////////////////////////////////////
 
 int      iDoRecord=0;
-HMMIO    hWaveFile=NULL;
-MMCKINFO mmckMain;
-MMCKINFO mmckData;
+FILE *   fWaveFile=NULL;
+unsigned long ulWaveBytes=0;                           // size of the data chunk
 char     szRecFileName[MAX_PATH];
 
 ////////////////////////////////////////////////////////////////////////
+// plain stdio wave writer: 44100 hz, 16 bit stereo (same as the mixer),
+// the chunk sizes get patched in on stop
 
-void RecordStart()
+static void RecordWrite32(unsigned long v)
 {
-	WAVEFORMATEX pcmwf;
-
-	// setup header in the same format as our directsound stream
-	memset(&pcmwf,0,sizeof(WAVEFORMATEX));
-	pcmwf.wFormatTag      = WAVE_FORMAT_PCM;
-
-	pcmwf.nChannels       = 2;
-	pcmwf.nBlockAlign     = 4;
-	pcmwf.nSamplesPerSec  = 44100;
-	pcmwf.nAvgBytesPerSec = pcmwf.nSamplesPerSec * pcmwf.nBlockAlign;
-	pcmwf.wBitsPerSample  = 16;
-
-	// create file
-	hWaveFile=mmioOpen(szRecFileName,NULL,MMIO_CREATE|MMIO_WRITE|MMIO_EXCLUSIVE | MMIO_ALLOCBUF);
-	if (!hWaveFile) return;
-
-	// setup WAVE, fmt and data chunks
-	memset(&mmckMain,0,sizeof(MMCKINFO));
-	mmckMain.fccType = mmioFOURCC('W','A','V','E');
-
-	mmioCreateChunk(hWaveFile,&mmckMain,MMIO_CREATERIFF);
-
-	memset(&mmckData,0,sizeof(MMCKINFO));
-	mmckData.ckid    = mmioFOURCC('f','m','t',' ');
-	mmckData.cksize  = sizeof(WAVEFORMATEX);
+	unsigned char b[4];
+	b[0]=(unsigned char)v;b[1]=(unsigned char)(v>>8);
+	b[2]=(unsigned char)(v>>16);b[3]=(unsigned char)(v>>24);
+	fwrite(b,4,1,fWaveFile);
+}
 
-	mmioCreateChunk(hWaveFile,&mmckData,0);
-	mmioWrite(hWaveFile,(char*)&pcmwf,sizeof(WAVEFORMATEX));
-	mmioAscend(hWaveFile,&mmckData,0);
+static void RecordWrite16(unsigned short v)
+{
+	unsigned char b[2];
+	b[0]=(unsigned char)v;b[1]=(unsigned char)(v>>8);
+	fwrite(b,2,1,fWaveFile);
+}
 
-	mmckData.ckid = mmioFOURCC('d','a','t','a');
-	mmioCreateChunk(hWaveFile,&mmckData,0);
+void RecordStart()
+{
+	fWaveFile=fopen(szRecFileName,"wb");
+	if (!fWaveFile) return;
+
+	setvbuf(fWaveFile,NULL,_IOFBF,256*1024);
+	ulWaveBytes=0;
+
+	fwrite("RIFF",4,1,fWaveFile);
+	RecordWrite32(36);                                    // patched on stop
+	fwrite("WAVEfmt ",8,1,fWaveFile);
+	RecordWrite32(16);
+	RecordWrite16(1);                                     // pcm
+	RecordWrite16(2);                                     // channels
+	RecordWrite32(44100);                                 // samples per sec
+	RecordWrite32(44100*4);                               // bytes per sec
+	RecordWrite16(4);                                     // block align
+	RecordWrite16(16);                                    // bits per sample
+	fwrite("data",4,1,fWaveFile);
+	RecordWrite32(0);                                     // patched on stop
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -91,25 +98,47 @@ void RecordStop()
 {
 	// first some check, if recording is running
 	iDoRecord=0;
-	if (!hWaveFile) return;
+	if (!fWaveFile) return;
 
 	// now finish writing & close the wave file
-	mmioAscend(hWaveFile,&mmckData,0);
-	mmioAscend(hWaveFile,&mmckMain,0);
-	mmioClose(hWaveFile,0);
+	fseek(fWaveFile,4,SEEK_SET);
+	RecordWrite32(36+ulWaveBytes);
+	fseek(fWaveFile,40,SEEK_SET);
+	RecordWrite32(ulWaveBytes);
+	fclose(fWaveFile);
 
 	// init var
-	hWaveFile=NULL;
+	fWaveFile=NULL;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+// combined movie dump: the samples go to the avi instead of a wave file
+
+void RecordStartAV()
+{
+	iDoRecord=2;
 }
 
 ////////////////////////////////////////////////////////////////////////
 
 void RecordBuffer(unsigned char* pSound,long lBytes)
 {
+	if (iDoRecord==2)
+	{
+		AVDumpSamples((short *)pSound,lBytes/4);
+		return;
+	}
+
 	// write the samples
-	if (hWaveFile) mmioWrite(hWaveFile,(char*)pSound,lBytes);
+	if (!fWaveFile) return;
+	fwrite(pSound,lBytes,1,fWaveFile);
+	ulWaveBytes+=lBytes;
 }
 
+#ifdef _WINDOWS
+
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
@@ -144,7 +173,7 @@ BOOL CALLBACK RecordDlgProc(HWND hW, UINT uMsg, WPARAM wParam, LPARAM lParam)
 
 				RecordStart();                                // start recording
 
-				if (hWaveFile)                                // start was ok?
+				if (fWaveFile)                                // start was ok?
 				{                                            // -> disable filename edit, change text, raise flag
 					EnableWindow(GetDlgItem(hW,IDC_WAVFILE),FALSE);
 					SetDlgItemText(hW,IDC_RECORD,"Stop recording");
@@ -1,12 +1,18 @@
 #ifndef _RECORD_H_
 #define _RECORD_H_
 
-#ifdef _WINDOWS
+#ifndef MAX_PATH
+#define MAX_PATH 260
+#endif
+
 void RecordStart();
+void RecordStartAV();
 void RecordBuffer(unsigned char* pSound,long lBytes);
 void RecordStop();
-BOOL CALLBACK RecordDlgProc(HWND hW, UINT uMsg, WPARAM wParam, LPARAM lParam);
 extern char szRecFileName[MAX_PATH];
+
+#ifdef _WINDOWS
+BOOL CALLBACK RecordDlgProc(HWND hW, UINT uMsg, WPARAM wParam, LPARAM lParam);
 #endif
 
 #endif
\ No newline at end of file
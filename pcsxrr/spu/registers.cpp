@@ -275,6 +275,7 @@ void SPU_struct::writeRegister(u32 r, u16 val)
 
 	case H_SPUdata:
 		spuMem[spuAddr>>1] = val;
+		invalidateBRR(spuAddr);
 		spuAddr+=2;
 		if (spuAddr>0x7ffff) spuAddr=0;
 		break;
@@ -87,6 +87,7 @@ FORCEINLINE void SPU_struct::s_buffer(int iOff,int iVal)                // set_b
 	if (iVal<-32768L) iVal=-32768L;
 	if (iVal>32767L) iVal=32767L;
 	*(p+iOff)=(short)iVal;
+	invalidateBRR(iOff*2);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -100,6 +101,7 @@ FORCEINLINE void SPU_struct::s_buffer1(int iOff,int iVal)                // set_
 	if (iVal<-32768L) iVal=-32768L;
 	if (iVal>32767L) iVal=32767L;
 	*(p+iOff)=(short)iVal;
+	invalidateBRR(iOff*2);
 }
 
 ////////////////////////////////////////////////////////////////////////
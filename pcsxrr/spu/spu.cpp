@@ -23,6 +23,8 @@
 
 #include <stdio.h>
 #include <queue>
+
+#include "../emusimd.h"
 
 //FILE* wavout = NULL;
 
@@ -280,69 +282,95 @@ enum SPUInterpolationMode
 	SPUInterpolation_Cosine = 4,
 };
 
-//a is the most recent sample, going back to d as the oldest
-s32 _Interpolate(s16 a, s16 b, s16 c, s16 d, double _ratio)
-{
-	SPUInterpolationMode INTERPOLATE_MODE = (SPUInterpolationMode)iUseInterpolation;
-	float ratio = (float)_ratio;
-
-	switch(INTERPOLATE_MODE)
-	{
-	case SPUInterpolation_None:
-		return a;
-	case SPUInterpolation_Cosine:
-		{
-			//why did we change it away from the lookup table? somebody should research that
-			ratio = ratio - (int)ratio;
-			double ratio2 = ((1.0 - cos(ratio * M_PI)) * 0.5);
-			//double ratio2 = (1.0f - cos_lut[((int)(ratio*256.0))&0xFF]) / 2.0f;
-			return (s32)(((1-ratio2)*b) + (ratio2*a));
-		}
-	case SPUInterpolation_Linear:
-		{
-			//linear interpolation
-			ratio = ratio - sputrunc(ratio);
-			s32 temp = s32floor((1-ratio)*b + ratio*a);
-			//printf("%d %d %d %f\n",a,b,temp,_ratio);
-			return temp;
-		} 
-	case SPUInterpolation_Gaussian:
-		{
-			//I'm not sure whether I am doing this right.. 
-			//low frequency things (try low notes on channel 10 of ff7 prelude song credits screen)
-			//pop a little bit
-			//the bit logic is taken from libopenspc
-			ratio = ratio - sputrunc(ratio);
-			ratio *= 256;
-			s32 index = sputrunc(ratio)*4;
-			s32 result = (gauss[index]*d)&~2047;
-			result += (gauss[index+1]*c)&~2047;
-			result += (gauss[index+2]*b)&~2047;
-			result += (gauss[index+3]*a)&~2047;
-			result = (result>>11)&~1;
-			return result;
-		}
-	case SPUInterpolation_Cubic:
-		{
-			float y0 = d, y1 = c, y2 = b, y3 = a;
-			float mu = ratio - (int)ratio;
-			float mu2 = mu*mu;
-			float a0 = y3 - y2 - y0 + y1;
-			float a1 = y0 - y1 - a0;
-			float a2 = y2 - y0;
-			float a3 = y1;
-
-			float result = a0*mu*mu2+a1*mu2+a2*mu+a3;
-			return (s32)result;
-		}
-	default:
-		return 0;
-	}
+//weight tables for cosine and cubic. the gaussian one has 256 phases, these get more
+//since they are smooth enough that the phase steps would be the largest error
+#define INTERP_PHASES 1024
+static s32 cosine[INTERP_PHASES];   //weight of the newer sample, 1.15 fixed point
+static s32 cubic[INTERP_PHASES*4];  //weights of d,c,b,a, 2.14 fixed point
+
+static void StaticInitInterpolate()
+{
+	for(int i=0;i<INTERP_PHASES;i++)
+	{
+		double mu = (double)i/INTERP_PHASES;
+		double mu2 = mu*mu, mu3 = mu2*mu;
+
+		cosine[i] = (s32)floor((1.0 - cos(mu * M_PI)) * 0.5 * 32768 + 0.5);
+
+		cubic[i*4]   = (s32)floor((-mu3 + 2*mu2 - mu) * 16384 + 0.5);
+		cubic[i*4+1] = (s32)floor((mu3 - 2*mu2 + 1) * 16384 + 0.5);
+		cubic[i*4+2] = (s32)floor((-mu3 + mu2 + mu) * 16384 + 0.5);
+		cubic[i*4+3] = (s32)floor((mu3 - mu2) * 16384 + 0.5);
+	}
+}
+
+//the fraction of the sample counter as a table phase 0..phases-1
+static FORCEINLINE u32 InterpolatePhase(double _ratio, int phases)
+{
+	float ratio = (float)_ratio;
+	ratio = ratio - sputrunc(ratio);
+	return sputrunc(ratio*phases);
 }
 
+//a is the most recent sample, going back to d as the oldest.
+//this gets instantiated per mode so the mixer can pick the mode once per block
+template<int MODE>
 static FORCEINLINE s32 Interpolate(s16 a, s16 b, s16 c, s16 d, double _ratio)
 {
-	return _Interpolate(a,b,c,d,_ratio);
+	switch(MODE)
+	{
+	case SPUInterpolation_None:
+		return a;
+	case SPUInterpolation_Cosine:
+		{
+			s32 ratio2 = cosine[InterpolatePhase(_ratio,INTERP_PHASES)];
+			return ((32768-ratio2)*b + ratio2*a)>>15;
+		}
+	case SPUInterpolation_Linear:
+		{
+			//linear interpolation
+			float ratio = (float)_ratio;
+			ratio = ratio - sputrunc(ratio);
+			s32 temp = s32floor((1-ratio)*b + ratio*a);
+			//printf("%d %d %d %f\n",a,b,temp,_ratio);
+			return temp;
+		} 
+	case SPUInterpolation_Gaussian:
+		{
+			//I'm not sure whether I am doing this right.. 
+			//low frequency things (try low notes on channel 10 of ff7 prelude song credits screen)
+			//pop a little bit
+			//the bit logic is taken from libopenspc
+			const int *g = &gauss[InterpolatePhase(_ratio,256)*4];
+			s32 result = (g[0]*d)&~2047;
+			result += (g[1]*c)&~2047;
+			result += (g[2]*b)&~2047;
+			result += (g[3]*a)&~2047;
+			result = (result>>11)&~1;
+			return result;
+		}
+	case SPUInterpolation_Cubic:
+		{
+			const s32 *w = &cubic[InterpolatePhase(_ratio,INTERP_PHASES)*4];
+			return (w[0]*d + w[1]*c + w[2]*b + w[3]*a)>>14;
+		}
+	default:
+		return 0;
+	}
+}
+
+//for callers outside the mixer (xa)
+s32 _Interpolate(s16 a, s16 b, s16 c, s16 d, double _ratio)
+{
+	switch(iUseInterpolation)
+	{
+	case SPUInterpolation_None: return Interpolate<SPUInterpolation_None>(a,b,c,d,_ratio);
+	case SPUInterpolation_Linear: return Interpolate<SPUInterpolation_Linear>(a,b,c,d,_ratio);
+	case SPUInterpolation_Gaussian: return Interpolate<SPUInterpolation_Gaussian>(a,b,c,d,_ratio);
+	case SPUInterpolation_Cubic: return Interpolate<SPUInterpolation_Cubic>(a,b,c,d,_ratio);
+	case SPUInterpolation_Cosine: return Interpolate<SPUInterpolation_Cosine>(a,b,c,d,_ratio);
+	default: return 0;
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -391,12 +419,15 @@ SPU_struct::SPU_struct(bool _isCore)
 	}
 
 	memset(spuMem,0,sizeof(spuMem));
+
+	for(int i=0;i<BRR_CACHE_SIZE;i++)
+		brrCache[i].addr = BRR_CACHE_EMPTY;
 }
 
 SPU_struct::~SPU_struct() {
 }
 
-s32 SPU_chan::decodeBRR(SPU_struct* spu)
+template<int MODE> s32 SPU_chan::decodeBRR(SPU_struct* spu)
 {
 	//find out which block we need and decode a new one if necessary.
 	//it is safe to only check for overflow once since we can only play samples at +2 octaves (4x too fast)
@@ -467,6 +498,26 @@ restart:
 		block[30] = block[26];
 		block[31] = block[27];
 
+		//looped samples pass through the same blocks over and over with the same history,
+		//so take the decoded block from the cache if we can
+		u32 blockStart = blockAddress-2;
+		BRRCacheEntry *cache = NULL;
+		if(!(blockStart&7) && blockStart <= 0x80000-16)
+		{
+			cache = &spu->brrCache[(blockStart>>3)&(BRR_CACHE_SIZE-1)];
+			if(cache->addr == blockStart && cache->s_1 == s_1 && cache->s_2 == s_2)
+			{
+				memcpy(block,cache->samples,sizeof(cache->samples));
+				s_1 = cache->end_1;
+				s_2 = cache->end_2;
+				blockAddress += 14;
+				goto decoded;
+			}
+			cache->addr = blockStart;
+			cache->s_1 = s_1;
+			cache->s_2 = s_2;
+		}
+
 		//decode 
 		for(int i=0,j=0;i<14;i++)
 		{
@@ -490,6 +541,14 @@ restart:
 
 			block[j++] = fa;
 		}
+
+		if(cache)
+		{
+			memcpy(cache->samples,block,sizeof(cache->samples));
+			cache->end_1 = s_1;
+			cache->end_2 = s_2;
+		}
+decoded:;
 	}
 
 	//perform interpolation. hardcoded for now
@@ -500,7 +559,7 @@ restart:
 		s16 b = block[(sampnum-1)&31];
 		s16 c = block[(sampnum-2)&31];
 		s16 d = block[(sampnum-3)&31];
-		return Interpolate(a,b,c,d,smpcnt);
+		return Interpolate<MODE>(a,b,c,d,smpcnt);
 	}
 	else return block[sampnum];
 
@@ -508,88 +567,127 @@ restart:
 }
 
 
-void mixAudio(bool killReverb, SPU_struct* spu, int length)
+//the mixer works voice-major: each voice renders a whole block of samples (decode, interpolate,
+//envelope, volume) into its own buffer and the buffers get summed afterwards.
+//voices are rendered in channel order, so a modulator is always done with the block
+//before the voice it modulates reads it from the fmod buffer.
+#define MIX_BLOCK 256
+
+//dst += src, count values
+static FORCEINLINE void mixAdd(s32* dst, const s32* src, int count)
 {
-	memset(spu->outbuf, 0, length*4*2);
+	int i=0;
+#ifdef ENABLE_SSE2
+	for(;i+8<=count;i+=8)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(dst+i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(dst+i+4));
+		a = _mm_add_epi32(a,_mm_loadu_si128((const __m128i*)(src+i)));
+		b = _mm_add_epi32(b,_mm_loadu_si128((const __m128i*)(src+i+4)));
+		_mm_storeu_si128((__m128i*)(dst+i),a);
+		_mm_storeu_si128((__m128i*)(dst+i+4),b);
+	}
+#endif
+	for(;i<count;i++)
+		dst[i] += src[i];
+}
 
-	//(todo - analyze master volumes etc.)
+//renders one voice into voicebuf (interleaved left/right) and returns how many samples it produced.
+//fmodbuf carries the last modulator output of each sample from the lower voices to the higher ones.
+template<int MODE>
+static int mixVoice(SPU_struct* spu, int i, int length, s32* fmodbuf, s32* voicebuf, bool &silent)
+{
+	SPU_chan *chan = &spu->channels[i];
 
-	bool checklog[24]; for(int i=0;i<24;i++) checklog[i] = false;
+	//don't output this channel; it is used to modulate the next channel
+	silent = (i<23 && spu->channels[i+1].bFMod);
 
-	for(int j=0;j<length;j++)
+	int j;
+	for(j=0;j<length;j++)
 	{
-		s32 left_accum = 0, right_accum = 0;
-		s32 fmod;
+		s32 samp;
+		if(chan->bNoise)
+			samp = iGetNoiseVal(chan);
+		else
+			samp = chan->decodeBRR<MODE>(spu);
 
-		spu->REVERB_initSample();
+		s32 adsrLevel = MixADSR(chan);
+		//printf("[%02d] adsr: %d\n",i,adsrLevel);
 
-		for(int i=0;i<24;i++)
-		{
-			SPU_chan *chan = &spu->channels[i];
+		//channel may have ended at any time
+		if (chan->status == CHANSTATUS_STOPPED) {
+			fmodbuf[j] = 0;
+			break;
+		}
+
+		samp = samp * adsrLevel/1023;
 
-			if (chan->status == CHANSTATUS_STOPPED) continue;
+		//apply the modulation
+		if(chan->bFMod)
+		{
+			//this was a little hard to test. ff7 battle fx were using it, but 
+			//its hard to tell since I dont think our noise is very good. need a better test.
+			chan->smpcnt += chan->smpinc;
+			s32 pitch = chan->rawPitch;
+			pitch = ((32768L+fmodbuf[j])*pitch)/32768L;
+			if (pitch>0x3fff) pitch=0x3fff;
+			if (pitch<0x1)    pitch=0x1;
+			chan->updatePitch((u16)pitch);
+		}
 
-			s32 samp;
-			if(chan->bNoise)
-				samp = iGetNoiseVal(chan);
-			else
-				samp = chan->decodeBRR(spu);
+		if(silent)
+		{
+			//should this be limited? lets check it.
+			if(samp < -32768 || samp > 32767) printf("[%02d]: limiting fmod value of %d !\n",i,samp);
+			fmodbuf[j] = limit(samp);
+			continue;
+		}
 
+		chan->smpcnt += chan->smpinc;
 
-			s32 adsrLevel = MixADSR(chan);
-			//printf("[%02d] adsr: %d\n",i,adsrLevel);
+		voicebuf[j*2] = (samp * chan->iLeftVolume) / 0x4000;
+		voicebuf[j*2+1] = (samp * chan->iRightVolume) / 0x4000;
+	}
 
-			//channel may have ended at any time
-			if (chan->status == CHANSTATUS_STOPPED) {
-				fmod = 0;
-				continue;
-			}
+	return j;
+}
 
-			checklog[i] = true;
+//mixes one block of samples into out
+template<int MODE>
+static void mixBlock(bool killReverb, SPU_struct* spu, s16* out, int length)
+{
+	s32 mixbuf[MIX_BLOCK*2], rvbbuf[MIX_BLOCK*2], voicebuf[MIX_BLOCK*2];
+	s32 fmodbuf[MIX_BLOCK];
 
-			samp = samp * adsrLevel/1023;
+	memset(mixbuf, 0, length*2*sizeof(s32));
+	memset(rvbbuf, 0, length*2*sizeof(s32));
+	memset(fmodbuf, 0, length*sizeof(s32));
 
-			//apply the modulation
-			if(chan->bFMod)
-			{
-				//this was a little hard to test. ff7 battle fx were using it, but 
-				//its hard to tell since I dont think our noise is very good. need a better test.
-				chan->smpcnt += chan->smpinc;
-				s32 pitch = chan->rawPitch;
-				pitch = ((32768L+fmod)*pitch)/32768L;
-				if (pitch>0x3fff) pitch=0x3fff;
-				if (pitch<0x1)    pitch=0x1;
-				chan->updatePitch((u16)pitch);
-			
-				//just some diagnostics
-				//static u16 lastPitch=0xFFFF, lastRawPitch=0xFFFF; if(chan->rawPitch != lastRawPitch || lastPitch != pitch) printf("fmod bending pitch from %04X to %04X\n",lastRawPitch=chan->rawPitch,lastPitch=pitch);
-				//printf("fmod: %d\n",fmod);
-			}
+	for(int i=0;i<24;i++)
+	{
+		SPU_chan *chan = &spu->channels[i];
 
-			//don't output this channel; it is used to modulate the next channel
-			if(i<23 && spu->channels[i+1].bFMod)
-			{
-				//should this be limited? lets check it.
-				if(samp < -32768 || samp > 32767) printf("[%02d]: limiting fmod value of %d !\n",samp);
-				fmod = limit(samp);
-				continue;
-			}
+		if (chan->status == CHANSTATUS_STOPPED) continue;
 
-			chan->smpcnt += chan->smpinc;
+		bool silent;
+		int done = mixVoice<MODE>(spu,i,length,fmodbuf,voicebuf,silent);
+		if(silent || !done) continue;
 
-			s32 left = (samp * chan->iLeftVolume) / 0x4000;
-			s32 right = (samp * chan->iRightVolume) / 0x4000;
+		mixAdd(mixbuf,voicebuf,done*2);
+		if(!killReverb)
+			if (chan->bRVBActive)
+				mixAdd(rvbbuf,voicebuf,done*2);
+	} //channel loop
 
-			left_accum += left;
-			right_accum += right;
+	for(int j=0;j<length;j++)
+	{
+		s32 left_accum = mixbuf[j*2], right_accum = mixbuf[j*2+1];
 
-			if(!killReverb)
-				if (chan->bRVBActive) 
-					spu->StoreREVERB(chan,left,right);
-		} //channel loop
+		spu->REVERB_initSample();
 
 		if(!killReverb)
 		{
+			spu->StoreREVERB(NULL,rvbbuf[j*2],rvbbuf[j*2+1]);
 			left_accum += spu->MixREVERBLeft();
 			right_accum += spu->MixREVERBRight();
 		}
@@ -600,6 +698,11 @@ void mixAudio(bool killReverb, SPU_struct* spu, int length)
 
 			left_accum += left;
 			right_accum += right;
+
+			spu->cddaqueue.fetch(&left,&right);
+
+			left_accum += left;
+			right_accum += right;
 		}
 
 		//handle spu mute
@@ -610,13 +713,11 @@ void mixAudio(bool killReverb, SPU_struct* spu, int length)
 
 		s16 output[] = { limit(left_accum), limit(right_accum) };
 
+		out[j*2] = output[0];
+		out[j*2+1] = output[1];
+
 		if(iSoundMode == SOUND_MODE_SYNCH)
 			synchronizer->enqueue_samples(output,1);
-		else
-		{
-			spu->outbuf[j*2] = output[0];
-			spu->outbuf[j*2+1] = output[1];
-		}
 
 		//fwrite(&left_out,2,1,wavout);
 		//fwrite(&right_out,2,1,wavout);
@@ -650,14 +751,45 @@ void mixAudio(bool killReverb, SPU_struct* spu, int length)
 		}
 
 	} //sample loop
+}
+
+void mixAudio(bool killReverb, SPU_struct* spu, int length)
+{
+	memset(spu->outbuf, 0, length*4*2);
+
+	//(todo - analyze master volumes etc.)
+
+	void (*mixBlockMode)(bool killReverb, SPU_struct* spu, s16* out, int length);
+	switch(iUseInterpolation)
+	{
+	case SPUInterpolation_Linear: mixBlockMode = mixBlock<SPUInterpolation_Linear>; break;
+	case SPUInterpolation_Gaussian: mixBlockMode = mixBlock<SPUInterpolation_Gaussian>; break;
+	case SPUInterpolation_Cubic: mixBlockMode = mixBlock<SPUInterpolation_Cubic>; break;
+	case SPUInterpolation_Cosine: mixBlockMode = mixBlock<SPUInterpolation_Cosine>; break;
+	default: mixBlockMode = mixBlock<SPUInterpolation_None>; break;
+	}
+
+	for(int j=0;j<length;)
+	{
+		int todo = length-j;
+		if(todo > MIX_BLOCK) todo = MIX_BLOCK;
+
+		//noise voices share one generator and take from it in channel order each sample.
+		//with more than one of them running, mix a sample at a time to keep that order
+		int noisy = 0;
+		for(int i=0;i<24;i++)
+			if(spu->channels[i].status != CHANSTATUS_STOPPED && spu->channels[i].bNoise)
+				noisy++;
+		if(noisy > 1) todo = 1;
+
+		mixBlockMode(killReverb,spu,spu->outbuf+j*2,todo);
+		j += todo;
+	}
 
-	//this prints which channels are active
-	//for(int i=0;i<24;i++) {
-	//	if(i==16) printf(" ");
-	//	if(checklog[i]) printf("%1x",i&15);
-	//	else printf(" ");
-	//}
-	//printf("\n");
+	//the core mixes in emulated time (except in asynch mode), so the recorded wav
+	//stays in step with the dumped video frames
+	if(spu->isCore && iDoRecord)
+		RecordBuffer((unsigned char*)spu->outbuf,length*4);
 }
 
 u16 SPU_struct::SPUreadDMA(void)
@@ -696,6 +828,7 @@ void SPU_struct::SPUwriteDMA(u16 val)
 	//printf("SPU single write dma %08X\n",spuAddr);
 
 	spuMem[spuAddr>>1] = val;                             // spu addr got by writeregister
+	invalidateBRR(spuAddr);
 	//triggerIrqRange(spuAddr,2);
 
 	spuAddr+=2;                                           // inc spu addr
@@ -710,6 +843,7 @@ void SPU_struct::SPUwriteDMAMem(u16 * pusPSXMem,int iSize)
 	for (int i=0;i<iSize;i++)
 	{
 		spuMem[spuAddr>>1] = *pusPSXMem++;                  // spu addr got by writeregister
+		invalidateBRR(spuAddr);
 		//triggerIrqRange(spuAddr,2);
 		spuAddr+=2;                                         // inc spu addr
 		if (spuAddr>0x7ffff) spuAddr=0;                     // wrap
@@ -845,6 +979,17 @@ void SPUplayADPCMchannel(xa_decode_t *xap)
 	if(SPU_user) SPU_user->xaqueue.feed(xap);
 }
 
+//same for a sector of cd audio (bytes of 44100hz 16bit stereo).
+//the cd volume registers apply to it as they do to xa
+void SPUplayCDDAchannel(short *pcm, int bytes)
+{
+	if (!pcm) return;
+
+	Lock lock;
+	SPU_core->cddaqueue.feed(pcm,bytes/4);
+	if(SPU_user) SPU_user->cddaqueue.feed(pcm,bytes/4);
+}
+
 //this func will be called first by the main emu
 long SPUinit(void)
 {
@@ -852,6 +997,7 @@ long SPUinit(void)
 	SPU_core = new SPU_struct(true);
 	SPU_user = new SPU_struct(false);
 	StaticInitADSR();
+	StaticInitInterpolate();
 	SPUReset();
 	return 0;
 }
@@ -918,6 +1064,7 @@ bool SPUunfreeze_new(EMUFILE* fp)
 	for(int i=0;i<MAXCHAN;i++) SPU_core->channels[i].load(fp);
 
 	SPU_core->xaqueue.unfreeze(fp);
+	if(version>=1) SPU_core->cddaqueue.unfreeze(fp);
 
 	//a bit weird to do this here, but i wanted to have a more solid XA state saver
 	//and the cdr freeze sucks. I made sure this saves and loads after the cdr state
@@ -198,10 +198,22 @@ public:
 	s16 block[32];
 	s32 s_1,s_2;
 	u8 flags;
-	s32 decodeBRR(SPU_struct* spu);
+	template<int MODE> s32 decodeBRR(SPU_struct* spu);
 
 };
 
+//a decoded BRR block, keyed by its spu ram address and the predictor history it was decoded with
+#define BRR_CACHE_SIZE 2048
+#define BRR_CACHE_EMPTY 0xFFFFFFFF
+
+struct BRRCacheEntry
+{
+	u32 addr;
+	s32 s_1,s_2;   //history before the block
+	s32 end_1,end_2; //and after it
+	s16 samples[28];
+};
+
 class SPU_struct
 {
 public:
@@ -228,7 +240,21 @@ public:
 	u16 spuMem[256*1024];
 	inline u8 readSpuMem(u32 addr) { return ((u8*)spuMem)[addr]; }
 
+	//--brr cache--
+	BRRCacheEntry brrCache[BRR_CACHE_SIZE];
+	//drops the cached blocks holding the spu ram byte at addr (they start 8 byte aligned and are 16 long)
+	inline void invalidateBRR(u32 addr) {
+		u32 a = addr&~7;
+		BRRCacheEntry &e0 = brrCache[(a>>3)&(BRR_CACHE_SIZE-1)];
+		if(e0.addr == a) e0.addr = BRR_CACHE_EMPTY;
+		a -= 8;
+		BRRCacheEntry &e1 = brrCache[(a>>3)&(BRR_CACHE_SIZE-1)];
+		if(e1.addr == a) e1.addr = BRR_CACHE_EMPTY;
+	}
+	//
+
 	xa_queue xaqueue;
+	xa_queue cddaqueue;
 
 	//---reverb--
 	s32 sRVBBuf[2];
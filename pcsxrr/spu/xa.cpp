@@ -157,6 +157,19 @@ void xa_queue::feed(xa_decode_t *xap)
 	enqueue(xap);
 }
 
+//cd audio: always 44100hz stereo
+void xa_queue::feed(const s16 *pcm, int nsamples)
+{
+	for(int i=0;i<nsamples;i++)
+	{
+		xa_sample temp;
+		temp.freq = 44100;
+		temp.left = pcm[i*2];
+		temp.right = pcm[i*2+1];
+		push_back(temp);
+	}
+}
+
 void xa_queue::fetch(s32* left, s32* right)
 {
 	s16 samples[8];
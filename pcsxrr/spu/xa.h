@@ -64,6 +64,7 @@ public:
 	void freeze(EMUFILE* fp);
 	bool unfreeze(EMUFILE* fp);
 	void feed(xa_decode_t *xap);
+	void feed(const s16 *pcm, int nsamples);
 	void fetch(s16* fourStereoSamples);
 	void fetch(s32* left, s32* right);
 